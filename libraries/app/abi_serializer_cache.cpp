@@ -0,0 +1,101 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/abi_serializer_cache.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+const uint32_t abi_serializer_cache::default_capacity;
+
+abi_serializer_cache::abi_serializer_cache( database& db, uint32_t capacity )
+:_db(db),_capacity(std::max<uint32_t>( capacity, 1 ))
+{
+   _change_connection = _db.changed_objects.connect( [this]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+                           on_accounts_changed( ids );
+                        } );
+}
+
+abi_serializer_cache::~abi_serializer_cache() {}
+
+std::shared_ptr<abi_serializer_cache> abi_serializer_cache::get( database& db )
+{
+   static std::mutex registry_mutex;
+   static std::map< database*, std::weak_ptr<abi_serializer_cache> > registry;
+
+   std::lock_guard<std::mutex> lock( registry_mutex );
+   auto& entry = registry[&db];
+   auto result = entry.lock();
+   if( !result )
+   {
+      result = std::make_shared<abi_serializer_cache>( db );
+      entry = result;
+   }
+   return result;
+}
+
+std::shared_ptr<const abi_serializer> abi_serializer_cache::get_serializer( const account_object& contract )
+{
+   {
+      std::lock_guard<std::mutex> lock( _mutex );
+      auto itr = _entries.find( contract.id );
+      if( itr != _entries.end() && itr->second.code_version == contract.code_version )
+      {
+         itr->second.last_used = ++_use_counter;
+         return itr->second.serializer;
+      }
+   }
+
+   // built outside of the lock, two readers missing the same contract at once both build it
+   auto serializer = std::make_shared<const abi_serializer>( contract.abi, fc::milliseconds(10000) );
+
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _entries.size() >= _capacity && _entries.find( contract.id ) == _entries.end() )
+   {
+      auto oldest = std::min_element( _entries.begin(), _entries.end(),
+                                      []( const std::pair<const account_id_type, entry>& a,
+                                          const std::pair<const account_id_type, entry>& b ) {
+                                         return a.second.last_used < b.second.last_used;
+                                      } );
+      _entries.erase( oldest );
+   }
+   auto& e = _entries[contract.id];
+   e.code_version = contract.code_version;
+   e.serializer = serializer;
+   e.last_used = ++_use_counter;
+   return serializer;
+}
+
+uint32_t abi_serializer_cache::size()const
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   return _entries.size();
+}
+
+void abi_serializer_cache::on_accounts_changed( const vector<object_id_type>& ids )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _entries.empty() )
+      return;
+   for( const auto& id : ids )
+      if( id.is<account_id_type>() )
+         _entries.erase( account_id_type( id ) );
+}
+
+} } // graphene::app
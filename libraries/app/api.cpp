@@ -213,37 +213,42 @@ namespace graphene { namespace app {
        return *_debug_api;
     }
 
+    history_api::history_api( application& app )
+    :_app(app), _readers(api_reader_pool::get(*app.chain_database())) {}
+
     vector<operation_history_object> history_api::get_account_history( account_id_type account, 
                                                                        operation_history_id_type stop, 
                                                                        unsigned limit, 
                                                                        operation_history_id_type start ) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();       
-       FC_ASSERT( limit <= 100 );
-       vector<operation_history_object> result;
-       const auto& stats = account(db).statistics(db);
-       if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-       const account_transaction_history_object* node = &stats.most_recent_op(db);
-       if( start == operation_history_id_type() )
-          start = node->operation_id;
+       return _readers->run( "get_account_history", [&]() {
+          FC_ASSERT( _app.chain_database() );
+          const auto& db = *_app.chain_database();       
+          FC_ASSERT( limit <= 100 );
+          vector<operation_history_object> result;
+          const auto& stats = account(db).statistics(db);
+          if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
+          const account_transaction_history_object* node = &stats.most_recent_op(db);
+          if( start == operation_history_id_type() )
+             start = node->operation_id;
           
-       while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if( node->operation_id.instance.value <= start.instance.value )
-             result.push_back( node->operation_id(db) );
-          if( node->next == account_transaction_history_id_type() )
-             node = nullptr;
-          else node = &node->next(db);
-       }
+          while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
+          {
+             if( node->operation_id.instance.value <= start.instance.value )
+                result.push_back( node->operation_id(db) );
+             if( node->next == account_transaction_history_id_type() )
+                node = nullptr;
+             else node = &node->next(db);
+          }
        
-       if( stop.instance.value == 0 && result.size() < limit )
-       {
-          node = db.find(account_transaction_history_id_type());
-          if( node && node->account == account)
-             result.push_back( node->operation_id(db) );
-       }
-       return result;
+          if( stop.instance.value == 0 && result.size() < limit )
+          {
+             node = db.find(account_transaction_history_id_type());
+             if( node && node->account == account)
+                result.push_back( node->operation_id(db) );
+          }
+          return result;
+       } );
     }
 
     history_operation_detail history_api::get_account_history_by_operations( account_id_type account,
@@ -275,33 +280,35 @@ namespace graphene { namespace app {
                                                                                   operation_history_id_type stop,
                                                                                   unsigned limit) const
     {
-       FC_ASSERT( _app.chain_database() );
-       const auto& db = *_app.chain_database();
-       FC_ASSERT( limit <= 100 );
-       vector<operation_history_object> result;
-       const auto& stats = account(db).statistics(db);
-       if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
-       const account_transaction_history_object* node = &stats.most_recent_op(db);
-       if( start == operation_history_id_type() )
-          start = node->operation_id;
-
-       while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
-       {
-          if( node->operation_id.instance.value <= start.instance.value ) {
-
-             if(node->operation_id(db).op.which() == operation_id)
-               result.push_back( node->operation_id(db) );
-             }
-          if( node->next == account_transaction_history_id_type() )
-             node = nullptr;
-          else node = &node->next(db);
-       }
-       if( stop.instance.value == 0 && result.size() < limit ) {
-          const account_transaction_history_object head = account_transaction_history_id_type()(db);
-          if( head.account == account && head.operation_id(db).op.which() == operation_id )
-             result.push_back(head.operation_id(db));
-       }
-       return result;
+       return _readers->run( "get_account_history_operations", [&]() {
+          FC_ASSERT( _app.chain_database() );
+          const auto& db = *_app.chain_database();
+          FC_ASSERT( limit <= 100 );
+          vector<operation_history_object> result;
+          const auto& stats = account(db).statistics(db);
+          if( stats.most_recent_op == account_transaction_history_id_type() ) return result;
+          const account_transaction_history_object* node = &stats.most_recent_op(db);
+          if( start == operation_history_id_type() )
+             start = node->operation_id;
+
+          while(node && node->operation_id.instance.value > stop.instance.value && result.size() < limit)
+          {
+             if( node->operation_id.instance.value <= start.instance.value ) {
+
+                if(node->operation_id(db).op.which() == operation_id)
+                  result.push_back( node->operation_id(db) );
+                }
+             if( node->next == account_transaction_history_id_type() )
+                node = nullptr;
+             else node = &node->next(db);
+          }
+          if( stop.instance.value == 0 && result.size() < limit ) {
+             const account_transaction_history_object head = account_transaction_history_id_type()(db);
+             if( head.account == account && head.operation_id(db).op.which() == operation_id )
+                result.push_back(head.operation_id(db));
+          }
+          return result;
+       } );
     }
 
 
@@ -310,32 +317,34 @@ namespace graphene { namespace app {
                                                                                 unsigned limit, 
                                                                                 uint32_t start) const
     {
-        FC_ASSERT( _app.chain_database() );
-        const auto& db = *_app.chain_database();
-        FC_ASSERT(limit <= 100);
-        vector<operation_history_object> result;
-        const auto& stats = account(db).statistics(db);
-        if( start == 0 )
-            start = stats.total_ops;
-        else
-            start = min( stats.total_ops, start );
-
-        if (start >= stop && start > stats.removed_ops && limit > 0)
-        {
-            const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
-            const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
-
-            auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
-            auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
-            FC_ASSERT(itr != itr_stop,"can't find history");
-            do
-            {
-                --itr;
-                result.push_back( itr->operation_id(db) );
-            }
-            while ( itr != itr_stop && result.size() < limit );
-        }
-        return result;
+       return _readers->run( "get_relative_account_history", [&]() {
+           FC_ASSERT( _app.chain_database() );
+           const auto& db = *_app.chain_database();
+           FC_ASSERT(limit <= 100);
+           vector<operation_history_object> result;
+           const auto& stats = account(db).statistics(db);
+           if( start == 0 )
+               start = stats.total_ops;
+           else
+               start = min( stats.total_ops, start );
+
+           if (start >= stop && start > stats.removed_ops && limit > 0)
+           {
+               const auto& hist_idx = db.get_index_type<account_transaction_history_index>();
+               const auto& by_seq_idx = hist_idx.indices().get<by_seq>();
+
+               auto itr = by_seq_idx.upper_bound( boost::make_tuple( account, start ) );
+               auto itr_stop = by_seq_idx.lower_bound( boost::make_tuple( account, stop ) );
+               FC_ASSERT(itr != itr_stop,"can't find history");
+               do
+               {
+                   --itr;
+                   result.push_back( itr->operation_id(db) );
+               }
+               while ( itr != itr_stop && result.size() < limit );
+           }
+           return result;
+       } );
     }
 
     crypto_api::crypto_api(){};
@@ -395,68 +404,65 @@ namespace graphene { namespace app {
     }
 
     // asset_api
-    asset_api::asset_api(graphene::chain::database& db) : _db(db) { }
+    asset_api::asset_api(graphene::chain::database& db) : _db(db), _readers(api_reader_pool::get(db)) { }
     asset_api::~asset_api() { }
 
-    vector<account_asset_balance> asset_api::get_asset_holders( asset_id_type asset_id ) const {
+    vector<account_asset_balance> asset_api::get_asset_holders( asset_id_type asset_id, uint32_t start, uint32_t limit ) const {
+      return _readers->run( "get_asset_holders", [&]() {
+         FC_ASSERT(limit <= 100);
 
-      const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-      auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
+         const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
+         auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
 
-      vector<account_asset_balance> result;
+         vector<account_asset_balance> result;
 
-      for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
-      {
-        if( bal.balance.value == 0 ) continue;
+         // ordered by descending balance, so the holders end at the first zero balance
+         uint32_t index = 0;
+         for( const account_balance_object& bal : boost::make_iterator_range( range.first, range.second ) )
+         {
+           if( result.size() >= limit || bal.balance.value == 0 ) break;
+           if( index++ < start ) continue;
 
-        auto account = _db.find(bal.owner);
+           const auto& account = bal.owner(_db);
 
-        account_asset_balance aab;
-        aab.name       = account->name;
-        aab.account_id = account->id;
-        aab.amount     = bal.balance.value;
+           account_asset_balance aab;
+           aab.name       = account.name;
+           aab.account_id = account.id;
+           aab.amount     = bal.balance.value;
 
-        result.push_back(aab);
-      }
+           result.push_back(aab);
+         }
 
-      return result;
+         return result;
+      } );
     }
     // get number of asset holders.
     int asset_api::get_asset_holders_count( asset_id_type asset_id ) const {
 
-      const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-      auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-            
-      int count = boost::distance(range) - 1;
+      const auto& bal_idx = dynamic_cast<const primary_index<account_balance_index>&>( _db.get_index_type< account_balance_index >() );
+      const auto& holders = bal_idx.get_secondary_index<asset_holder_count_index>();
 
-      return count;
+      return holders.get_holder_count( asset_id );
     }
     // function to get vector of system assets with holders count.
     vector<asset_holders> asset_api::get_all_asset_holders() const {
-            
-      vector<asset_holders> result;
-            
-      vector<asset_id_type> total_assets;
-      for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
-      {
-        const auto& dasset_obj = asset_obj.dynamic_asset_data_id(_db);
-
-        asset_id_type asset_id;
-        asset_id = dasset_obj.id;
-
-        const auto& bal_idx = _db.get_index_type< account_balance_index >().indices().get< by_asset_balance >();
-        auto range = bal_idx.equal_range( boost::make_tuple( asset_id ) );
-
-        int count = boost::distance(range) - 1;
-                
-        asset_holders ah;
-        ah.asset_id       = asset_id;
-        ah.count     = count;
-
-        result.push_back(ah);
-      }
-
-      return result;
+      return _readers->run( "get_all_asset_holders", [&]() {
+         vector<asset_holders> result;
+
+         const auto& bal_idx = dynamic_cast<const primary_index<account_balance_index>&>( _db.get_index_type< account_balance_index >() );
+         const auto& holders = bal_idx.get_secondary_index<asset_holder_count_index>();
+
+         for( const asset_object& asset_obj : _db.get_index_type<asset_index>().indices() )
+         {
+           asset_holders ah;
+           ah.asset_id  = asset_obj.id;
+           ah.count     = holders.get_holder_count( asset_obj.id );
+
+           result.push_back(ah);
+         }
+
+         return result;
+      } );
     }
 
 } } // graphene::app
@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/api_reader_pool.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+api_reader_pool::~api_reader_pool()
+{
+   for( auto& thread : _threads )
+      thread->quit();
+}
+
+std::shared_ptr<api_reader_pool> api_reader_pool::get( database& db )
+{
+   static std::mutex registry_mutex;
+   static std::map< database*, std::weak_ptr<api_reader_pool> > registry;
+
+   std::lock_guard<std::mutex> lock( registry_mutex );
+   auto& entry = registry[&db];
+   auto result = entry.lock();
+   if( !result )
+   {
+      result = std::make_shared<api_reader_pool>( db );
+      entry = result;
+   }
+   return result;
+}
+
+void api_reader_pool::set_thread_count( uint32_t count )
+{
+   for( auto& thread : _threads )
+      thread->quit();
+   _threads.clear();
+
+   for( uint32_t i = 0; i < count; ++i )
+      _threads.emplace_back( new fc::thread( "api_reader_" + std::to_string( i ) ) );
+}
+
+bool api_reader_pool::on_reader_thread()const
+{
+   const fc::thread* current = &fc::thread::current();
+   for( const auto& thread : _threads )
+      if( thread.get() == current )
+         return true;
+   return false;
+}
+
+void api_reader_pool::record_latency( const char* method, uint64_t us )
+{
+   std::lock_guard<std::mutex> lock( _latency_mutex );
+   _latencies[method].record( us );
+}
+
+api_latency_metrics api_reader_pool::get_latency_metrics()const
+{
+   api_latency_metrics result;
+   result.reader_threads = _threads.size();
+
+   std::lock_guard<std::mutex> lock( _latency_mutex );
+   result.methods.reserve( _latencies.size() );
+   for( const auto& entry : _latencies )
+   {
+      const auto& stats = entry.second;
+      api_latency_histogram histogram;
+      histogram.method   = entry.first;
+      histogram.count    = stats.count;
+      histogram.total_us = stats.total_us;
+      histogram.max_us   = stats.max_us;
+      histogram.p50_us   = stats.percentile( 0.5 );
+      histogram.p99_us   = stats.percentile( 0.99 );
+      auto last = std::find_if( stats.buckets.rbegin(), stats.buckets.rend(), []( uint64_t n ) { return n != 0; } );
+      histogram.buckets.assign( stats.buckets.begin(), last.base() );
+      result.methods.emplace_back( std::move(histogram) );
+   }
+   return result;
+}
+
+void api_reader_pool::clear_latency_metrics()
+{
+   std::lock_guard<std::mutex> lock( _latency_mutex );
+   _latencies.clear();
+}
+
+} } // graphene::app
@@ -25,6 +25,9 @@
 #include <graphene/app/api_access.hpp>
 #include <graphene/app/application.hpp>
 #include <graphene/app/plugin.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+#include <graphene/app/api_reader_pool.hpp>
+#include <graphene/app/irreversible_block_stream.hpp>
 
 #include <graphene/chain/protocol/fee_schedule.hpp>
 #include <graphene/chain/protocol/types.hpp>
@@ -378,6 +381,22 @@ namespace detail {
              _chain_db->set_max_trx_cpu_time(_options->at("max-transaction-time").as<int32_t>());
          }
 
+         if (_options->count("transaction-verify-threads")) {
+             _chain_db->set_transaction_verify_threads(_options->at("transaction-verify-threads").as<uint32_t>());
+         }
+
+         if (_options->count("block-log-prune-window")) {
+             _chain_db->set_block_log_prune_window(_options->at("block-log-prune-window").as<uint32_t>());
+         }
+
+         if (_options->count("execution-profile-log-interval")) {
+             const uint32_t interval = _options->at("execution-profile-log-interval").as<uint32_t>();
+             if (interval > 0) {
+                 _chain_db->get_execution_profiler().set_log_interval(fc::seconds(interval));
+                 _chain_db->get_execution_profiler().set_enabled(true);
+             }
+         }
+
          if( _options->count("replay-blockchain") )
             _chain_db->wipe( _data_dir / "blockchain", false );
 
@@ -392,6 +411,26 @@ namespace detail {
              throw;
          }
 
+         _subscription_dispatcher = subscription_dispatcher::get(*_chain_db);
+         if (_options->count("api-subscription-queue-depth")) {
+             _subscription_dispatcher->set_max_queue_depth(_options->at("api-subscription-queue-depth").as<uint32_t>());
+         }
+         if (_options->count("api-subscription-overflow")) {
+             const auto& overflow = _options->at("api-subscription-overflow").as<string>();
+             FC_ASSERT(overflow == "coalesce" || overflow == "drop",
+                       "api-subscription-overflow must be either coalesce or drop, got ${o}", ("o", overflow));
+             _subscription_dispatcher->set_object_overflow_policy(overflow == "coalesce" ? subscription_overflow_coalesce
+                                                                                         : subscription_overflow_drop_oldest);
+         }
+
+         _irreversible_block_stream = irreversible_block_stream::get(*_chain_db);
+         _irreversible_block_stream->set_cursor_directory(_data_dir / "irreversible_cursors");
+
+         _api_reader_pool = api_reader_pool::get(*_chain_db);
+         if (_options->count("api-reader-threads")) {
+             _api_reader_pool->set_thread_count(_options->at("api-reader-threads").as<uint32_t>());
+         }
+
          if (_options->count("force-validate")) {
              ilog("All transaction signatures will be validated");
              _force_validate = true;
@@ -609,6 +648,10 @@ namespace detail {
            if (!found_a_block_in_synopsis)
              FC_THROW_EXCEPTION(graphene::net::peer_is_on_an_unreachable_fork, "Unable to provide a list of blocks starting at any of the blocks in peer's synopsis");
          }
+         // with a pruned block database, answer as if we had no blocks so the peer syncs from others
+         if( block_header::num_from_id(last_known_block_id) + 1 < _chain_db->get_first_stored_block_num() )
+           FC_THROW_EXCEPTION(graphene::net::peer_is_on_an_unreachable_fork, "The blocks after ${num} were pruned",
+                              ("num", block_header::num_from_id(last_known_block_id)));
          for( uint32_t num = block_header::num_from_id(last_known_block_id);
               num <= _chain_db->head_block_num() && result.size() < limit;
               ++num )
@@ -630,6 +673,8 @@ namespace detail {
          if( id.item_type == graphene::net::block_message_type )
          {
             auto opt_block = _chain_db->fetch_block_by_id(id.item_hash);
+            FC_ASSERT( opt_block.valid() || block_header::num_from_id(id.item_hash) >= _chain_db->get_first_stored_block_num(),
+                       "Block ${id} was pruned", ("id", id.item_hash) );
             if( !opt_block )
                elog("Couldn't find block ${id} -- corresponding ID in our chain is ${id2}",
                     ("id", id.item_hash)("id2", _chain_db->get_block_id_for_num(block_header::num_from_id(id.item_hash))));
@@ -887,6 +932,9 @@ namespace detail {
       std::shared_ptr<graphene::chain::database>            _chain_db;
       std::shared_ptr<graphene::net::node>                  _p2p_network;
       std::shared_ptr<fc::http::websocket_server>      _websocket_server;
+      std::shared_ptr<subscription_dispatcher>         _subscription_dispatcher;
+      std::shared_ptr<api_reader_pool>                 _api_reader_pool;
+      std::shared_ptr<irreversible_block_stream>       _irreversible_block_stream;
       std::shared_ptr<fc::http::websocket_tls_server>  _websocket_tls_server;
 
       std::map<string, std::shared_ptr<abstract_plugin>> _active_plugins;
@@ -908,6 +956,8 @@ application::~application()
       my->_p2p_network->close();
       my->_p2p_network.reset();
    }
+   // stops the consumers before the blocks they read go away
+   my->_irreversible_block_stream.reset();
    if( my->_chain_db )
    {
       my->_chain_db->close();
@@ -930,6 +980,18 @@ void application::set_program_options(boost::program_options::options_descriptio
          ("dbg-init-key", bpo::value<string>(), "Block signing key to use for init witnesses, overrides genesis file")
          ("api-access", bpo::value<boost::filesystem::path>(), "JSON file specifying API permissions")
          ("plugins", bpo::value<string>(), "Space-separated list of plugins to activate")
+         ("api-subscription-queue-depth", bpo::value<uint32_t>()->default_value(64),
+          "Maximum number of undelivered updates queued for each API subscription")
+         ("api-subscription-overflow", bpo::value<string>()->default_value("coalesce"),
+          "What a full object subscription queue does with new updates: coalesce (merge into the newest queued update) or drop (discard the oldest)")
+         ("api-reader-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads running read-only API calls in parallel with block processing, 0 runs them on the main thread")
+         ("transaction-verify-threads", bpo::value<uint32_t>()->default_value(0),
+          "Number of threads verifying the transaction signatures of a validated block in parallel, 0 verifies them while applying")
+         ("block-log-prune-window", bpo::value<uint32_t>()->default_value(0),
+          "Number of recent blocks to keep on disk, at least 10000, 0 keeps all blocks.  A pruned node can't replay or serve older blocks to peers")
+         ("execution-profile-log-interval", bpo::value<uint32_t>()->default_value(0),
+          "Collect latency histograms of operations, contract actions and block and transaction phases and log them every this many seconds, 0 disables the profiler")
          ;
    command_line_options.add(configuration_file_options);
    command_line_options.add_options()
@@ -1068,6 +1130,7 @@ void application::shutdown()
 {
    if( my->_p2p_network )
       my->_p2p_network->close();
+   my->_irreversible_block_stream.reset();
    if( my->_chain_db )
    {
       my->_chain_db->close();
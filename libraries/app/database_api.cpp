@@ -26,7 +26,6 @@
 #include <graphene/app/database_api_impl.hpp>
 #include <graphene/chain/get_config.hpp>
 
-#include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 #include <fc/crypto/hex.hpp>
@@ -62,12 +61,21 @@ database_api::~database_api() {}
 
 fc::variants database_api::get_objects(const vector<object_id_type>& ids)const
 {
-   return my->get_objects( ids );
+   return my->_readers->run( "get_objects", [&]() { return my->get_objects( ids ); } );
 }
 
 fc::variants database_api::get_table_objects(uint64_t code, uint64_t scope, uint64_t table) const
 {
-    return my->get_table_objects(code, scope, table);
+    return my->_readers->run( "get_table_objects", [&]() { return my->get_table_objects(code, scope, table); } );
+}
+
+table_rows database_api::get_table_rows(string contract, string table, uint64_t scope, uint64_t lower_bound, uint64_t upper_bound,
+                                        uint32_t limit, uint8_t index_position, bool raw, uint64_t lower_primary_key) const
+{
+    return my->_readers->run( "get_table_rows", [&]() {
+        return my->get_table_rows(contract, table, scope, lower_bound, upper_bound, limit, index_position, raw,
+                                  lower_primary_key);
+    } );
 }
 
 bytes database_api::serialize_contract_call_args(string contract, string method, string json_args) const 
@@ -116,6 +124,21 @@ void database_api::unsubscribe_data_transaction_callback()
    my->unsubscribe_data_transaction_callback();
 }
 
+subscription_queue_metrics database_api::get_subscription_metrics()const
+{
+   return my->get_subscription_metrics();
+}
+
+api_latency_metrics database_api::get_api_latency_metrics()const
+{
+   return my->get_api_latency_metrics();
+}
+
+vector<irreversible_consumer_metrics> database_api::get_irreversible_consumer_metrics()const
+{
+   return my->get_irreversible_consumer_metrics();
+}
+
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Blocks and transactions                                          //
@@ -222,12 +245,12 @@ bool database_api::is_account_registered(string name) const
 
 vector<optional<account_object>> database_api::get_accounts(const vector<account_id_type>& account_ids)const
 {
-   return my->get_accounts( account_ids );
+   return my->_readers->run( "get_accounts", [&]() { return my->get_accounts( account_ids ); } );
 }
 
 std::map<string,full_account> database_api::get_full_accounts( const vector<string>& names_or_ids, bool subscribe )
 {
-   return my->get_full_accounts( names_or_ids, subscribe );
+   return my->_readers->run( "get_full_accounts", [&]() { return my->get_full_accounts( names_or_ids, subscribe ); } );
 }
 
 optional<account_object> database_api::get_account_by_name( string name )const
@@ -242,12 +265,12 @@ vector<account_id_type> database_api::get_account_references( account_id_type ac
 
 vector<optional<account_object>> database_api::lookup_account_names(const vector<string>& account_names)const
 {
-   return my->lookup_account_names( account_names );
+   return my->_readers->run( "lookup_account_names", [&]() { return my->lookup_account_names( account_names ); } );
 }
 
 map<string,account_id_type> database_api::lookup_accounts(const string& lower_bound_name, uint32_t limit)const
 {
-   return my->lookup_accounts( lower_bound_name, limit );
+   return my->_readers->run( "lookup_accounts", [&]() { return my->lookup_accounts( lower_bound_name, limit ); } );
 }
 
 uint64_t database_api::get_transaction_count() const
@@ -334,7 +357,7 @@ uint64_t database_api::get_data_transaction_total_count_by_product_id(string pro
 
 vector<asset> database_api::get_account_balances(account_id_type id, const flat_set<asset_id_type>& assets)const
 {
-   return my->get_account_balances( id, assets );
+   return my->_readers->run( "get_account_balances", [&]() { return my->get_account_balances( id, assets ); } );
 }
 
 vector<asset> database_api::get_account_lock_balances(account_id_type id, const flat_set<asset_id_type>& assets)const
@@ -344,7 +367,7 @@ vector<asset> database_api::get_account_lock_balances(account_id_type id, const
 
 vector<asset> database_api::get_named_account_balances(const std::string& name, const flat_set<asset_id_type>& assets)const
 {
-   return my->get_named_account_balances( name, assets );
+   return my->_readers->run( "get_named_account_balances", [&]() { return my->get_named_account_balances( name, assets ); } );
 }
 
 vector<balance_object> database_api::get_balance_objects( const vector<address>& addrs )const
@@ -360,7 +383,7 @@ vector<asset> database_api::get_vested_balances( const vector<balance_id_type>&
 
 vector<vesting_balance_object> database_api::get_vesting_balances( account_id_type account_id )const
 {
-   return my->get_vesting_balances( account_id );
+   return my->_readers->run( "get_vesting_balances", [&]() { return my->get_vesting_balances( account_id ); } );
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -371,19 +394,19 @@ vector<vesting_balance_object> database_api::get_vesting_balances( account_id_ty
 
 vector<optional<asset_object>> database_api::get_assets(const vector<asset_id_type>& asset_ids)const
 {
-   return my->get_assets( asset_ids );
+   return my->_readers->run( "get_assets", [&]() { return my->get_assets( asset_ids ); } );
 }
 
 
 vector<asset_object> database_api::list_assets(const string& lower_bound_symbol, uint32_t limit)const
 {
-   return my->list_assets( lower_bound_symbol, limit );
+   return my->_readers->run( "list_assets", [&]() { return my->list_assets( lower_bound_symbol, limit ); } );
 }
 
 
 vector<optional<asset_object>> database_api::lookup_asset_symbols(const vector<string>& symbols_or_ids)const
 {
-   return my->lookup_asset_symbols( symbols_or_ids );
+   return my->_readers->run( "lookup_asset_symbols", [&]() { return my->lookup_asset_symbols( symbols_or_ids ); } );
 }
 
 optional<pocs_object> database_api::get_pocs_object(league_id_type league_id, account_id_type account_id, object_id_type product_id)const
@@ -588,7 +611,7 @@ vector<data_market_category_object> database_api::list_data_market_categories(ui
  * @return
  */
 free_data_product_search_results_object   database_api::list_free_data_products(string data_market_category_id,uint32_t offset,uint32_t limit,string order_by,string keyword,bool show_all) const{
-    return my->list_free_data_products(data_market_category_id, offset, limit,order_by,keyword,show_all);
+    return my->_readers->run( "list_free_data_products", [&]() { return my->list_free_data_products(data_market_category_id, offset, limit,order_by,keyword,show_all); } );
 }
 
 /**
@@ -601,7 +624,7 @@ free_data_product_search_results_object   database_api::list_free_data_products(
  * @return
  */
 league_data_product_search_results_object   database_api::list_league_data_products(string data_market_category_id,uint32_t offset,uint32_t limit,string order_by,string keyword,bool show_all) const{
-    return my->list_league_data_products(data_market_category_id, offset, limit,order_by,keyword,show_all);
+    return my->_readers->run( "list_league_data_products", [&]() { return my->list_league_data_products(data_market_category_id, offset, limit,order_by,keyword,show_all); } );
 }
 
 /**
@@ -614,7 +637,7 @@ league_data_product_search_results_object   database_api::list_league_data_produ
  * @return
  */
 league_search_results_object database_api::list_leagues(string data_market_category_id,uint32_t offset,uint32_t limit,string order_by,string keyword,bool show_all) const {
-    return my->list_leagues(data_market_category_id, offset, limit,order_by,keyword,show_all);
+    return my->_readers->run( "list_leagues", [&]() { return my->list_leagues(data_market_category_id, offset, limit,order_by,keyword,show_all); } );
 }
 
 /**
@@ -622,7 +645,7 @@ league_search_results_object database_api::list_leagues(string data_market_categ
  * @param request_id
  * @return
  */
-optional<data_transaction_object> database_api::get_data_transaction_by_request_id(string request_id) const {
+optional<data_transaction_api_object> database_api::get_data_transaction_by_request_id(string request_id) const {
     return my->get_data_transaction_by_request_id(request_id);
 }
 
@@ -632,7 +655,7 @@ optional<data_transaction_object> database_api::get_data_transaction_by_request_
 * @return
 */
 data_transaction_search_results_object database_api::list_data_transactions_by_requester(string requester, uint32_t limit) const {
-    return my->list_data_transactions_by_requester(requester, limit);
+    return my->_readers->run( "list_data_transactions_by_requester", [&]() { return my->list_data_transactions_by_requester(requester, limit); } );
 }
 
 map<account_id_type, uint64_t> database_api::list_second_hand_datasources(time_point_sec start_date_time, time_point_sec end_date_time, uint32_t limit) const {
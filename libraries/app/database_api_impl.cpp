@@ -25,8 +25,8 @@
 #include <graphene/app/database_api_impl.hpp>
 #include <graphene/chain/get_config.hpp>
 #include <graphene/chain/contract_table_objects.hpp>
+#include <graphene/chain/account_rank_index.hpp>
 
-#include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 #include <fc/crypto/hex.hpp>
@@ -46,6 +46,7 @@
 
 #include <cfenv>
 #include <iostream>
+#include <queue>
 
 
 #define GET_REQUIRED_FEES_MAX_RECURSION 4
@@ -68,12 +69,101 @@ optional<T> maybe_id( const string& name_or_id )
    }
    return optional<T>();
 }
+
+/**
+ *  Splits [start, end] into the whole buckets [first_bucket, last_bucket) answered by an account_bucket_counter
+ *  and the partial head and tail ranges that have to be scanned in the by_create_date_time index.
+ *  @return false if the range does not cover any whole bucket
+ */
+static bool whole_buckets_in_range( time_point_sec start, time_point_sec end, uint32_t& first_bucket, uint32_t& last_bucket )
+{
+   first_bucket = account_bucket_counter::bucket_of( start );
+   if( account_bucket_counter::bucket_start( first_bucket ) < start ) ++first_bucket;
+   last_bucket = uint32_t( ( uint64_t( end.sec_since_epoch() ) + 1 ) / account_bucket_counter::bucket_seconds );
+   return first_bucket < last_bucket;
+}
+
+/** Calls visit on every object in the ranges of [start, end] not covered by whole buckets */
+template<typename TimeIndex, typename Visitor>
+static void visit_partial_buckets( const TimeIndex& idx, time_point_sec start, time_point_sec end, Visitor visit )
+{
+   uint32_t first_bucket, last_bucket;
+   if( !whole_buckets_in_range( start, end, first_bucket, last_bucket ) )
+   {
+      for( const auto& obj : boost::make_iterator_range( idx.lower_bound( start ), idx.upper_bound( end ) ) )
+         visit( obj );
+      return;
+   }
+
+   for( const auto& obj : boost::make_iterator_range( idx.lower_bound( start ),
+                                                     idx.lower_bound( account_bucket_counter::bucket_start( first_bucket ) ) ) )
+      visit( obj );
+   for( const auto& obj : boost::make_iterator_range( idx.lower_bound( account_bucket_counter::bucket_start( last_bucket ) ),
+                                                     idx.upper_bound( end ) ) )
+      visit( obj );
+}
+
+/** Adds the per account counters of objects created in [start, end] to totals */
+template<typename TimeIndex, typename AccountOf>
+static void count_accounts_in_range( const TimeIndex& idx, const account_bucket_counter& counter,
+                                     time_point_sec start, time_point_sec end, AccountOf account_of,
+                                     map<account_id_type, uint64_t>& totals )
+{
+   if( end < start ) return;
+
+   uint32_t first_bucket, last_bucket;
+   if( whole_buckets_in_range( start, end, first_bucket, last_bucket ) )
+      counter.accumulate( first_bucket, last_bucket, totals );
+   visit_partial_buckets( idx, start, end, [&]( const typename TimeIndex::value_type& obj ) {
+      ++totals[account_of( obj )];
+   });
+}
+
+/** @return the number of objects created in [start, end] that account_of maps to account */
+template<typename TimeIndex, typename AccountOf>
+static uint64_t count_account_in_range( const TimeIndex& idx, const account_bucket_counter& counter,
+                                        time_point_sec start, time_point_sec end, AccountOf account_of,
+                                        account_id_type account )
+{
+   if( end < start ) return 0;
+
+   uint64_t result = 0;
+   uint32_t first_bucket, last_bucket;
+   if( whole_buckets_in_range( start, end, first_bucket, last_bucket ) )
+      result = counter.count( first_bucket, last_bucket, account );
+   visit_partial_buckets( idx, start, end, [&]( const typename TimeIndex::value_type& obj ) {
+      if( account_of( obj ) == account ) ++result;
+   });
+   return result;
+}
+
+/** @return the limit accounts with the highest counters, selected with a bounded min-heap */
+static map<account_id_type, uint64_t> top_accounts( const map<account_id_type, uint64_t>& totals, uint32_t limit )
+{
+   std::priority_queue<PAIR, vector<PAIR>, cmp_pair_by_value> heap;
+   for( const auto& item : totals )
+   {
+      if( heap.size() < limit )
+         heap.push( item );
+      else if( limit > 0 && item.second > heap.top().second )
+      {
+         heap.pop();
+         heap.push( item );
+      }
+   }
+
+   map<account_id_type, uint64_t> results;
+   for( ; !heap.empty(); heap.pop() )
+      results.insert( heap.top() );
+   return results;
+}
 //////////////////////////////////////////////////////////////////////
 //                                                                  //
 // Constructors                                                     //
 //                                                                  //
 //////////////////////////////////////////////////////////////////////
-database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
+database_api_impl::database_api_impl( graphene::chain::database& db )
+:_dispatcher(subscription_dispatcher::get(db)),_readers(api_reader_pool::get(db)),_abi_cache(abi_serializer_cache::get(db)),_db(db)
 {
    _new_connection = _db.new_objects.connect([this](const vector<object_id_type>& ids, const flat_set<account_id_type>& impacted_accounts) {
                                 on_objects_new(ids, impacted_accounts);
@@ -98,6 +188,7 @@ database_api_impl::database_api_impl( graphene::chain::database& db ):_db(db)
 
 database_api_impl::~database_api_impl()
 {
+   cancel_all_subscriptions();
 }
 
 fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)const
@@ -125,20 +216,15 @@ fc::variants database_api_impl::get_objects(const vector<object_id_type>& ids)co
    return result;
 }
 
-static void copy_inline_row(const key_value_object& obj, vector<char>& data) {
-   data.resize( obj.value.size() );
-   memcpy( data.data(), obj.value.data(), obj.value.size() );
-}
-
 fc::variants database_api_impl::get_table_objects(uint64_t code, uint64_t scope, uint64_t table) const
 { try {
     fc::variants result;
 
-    const auto &account_obj = get_account_by_contract_code(code);
-    if(!account_obj.valid())
+    const account_object* account_obj = _db.find(account_id_type(code & GRAPHENE_DB_MAX_INSTANCE_ID));
+    if(account_obj == nullptr)
         return result;
 
-    abi_serializer abis(account_obj->abi, fc::milliseconds(10000));
+    auto abis = _abi_cache->get_serializer(*account_obj);
 
     const auto &table_idx = _db.get_index_type<table_id_multi_index>().indices().get<by_code_scope_table>();
     auto existing_tid = table_idx.find(boost::make_tuple(code & GRAPHENE_DB_MAX_INSTANCE_ID, name(scope & GRAPHENE_DB_MAX_INSTANCE_ID), name(table)));
@@ -149,13 +235,12 @@ fc::variants database_api_impl::get_table_objects(uint64_t code, uint64_t scope,
         auto lower = kv_idx.lower_bound(boost::make_tuple(existing_tid->id));
         auto upper = kv_idx.lower_bound(boost::make_tuple(next_tid));
 
+        // large tables are cut off here, get_table_rows pages through them
         auto end = fc::time_point::now() + fc::microseconds(1000 * 10);
-        vector<char> data;
         name tname(table);
         for(auto it = lower; it != upper; ++it) {
             if(fc::time_point::now() > end) break;
-            copy_inline_row(*it, data);
-            result.emplace_back(abis.binary_to_variant(tname.to_string(), data, fc::microseconds(1000 * 10)));
+            result.emplace_back(abis->binary_to_variant(tname.to_string(), it->value, fc::microseconds(1000 * 10)));
         }
     }
     return result;
@@ -163,47 +248,120 @@ fc::variants database_api_impl::get_table_objects(uint64_t code, uint64_t scope,
     FC_CAPTURE_AND_RETHROW((code)(scope)(table))
 }
 
+table_rows database_api_impl::get_table_rows(string contract, string table, uint64_t scope, uint64_t lower_bound, uint64_t upper_bound,
+                                             uint32_t limit, uint8_t index_position, bool raw,
+                                             uint64_t lower_primary_key) const
+{ try {
+    FC_ASSERT(limit <= 1000, "limit must not exceed 1000");
+    // contracts encode the number of a secondary index in the low 4 bits of its table name
+    FC_ASSERT(index_position <= 16, "a table has at most 16 secondary indices");
+
+    table_rows result;
+
+    const auto &accounts_by_name = _db.get_index_type<account_index>().indices().get<by_name>();
+    auto contract_itr = accounts_by_name.find(contract);
+    FC_ASSERT(contract_itr != accounts_by_name.end(), "Unknown contract ${contract}", ("contract", contract));
+    const uint64_t code = contract_itr->id.instance();
+    const name tname(table);
+
+    std::shared_ptr<const abi_serializer> abis;
+    type_name row_type;
+    if (!raw) {
+        abis = _abi_cache->get_serializer(*contract_itr);
+        row_type = abis->get_table_type(tname);
+        if (row_type.empty())
+            row_type = tname.to_string();
+    }
+
+    const auto &table_idx = _db.get_index_type<table_id_multi_index>().indices().get<by_code_scope_table>();
+    auto primary_table = table_idx.find(boost::make_tuple(code, name(scope), tname));
+    if (primary_table == table_idx.end() || lower_bound > upper_bound)
+        return result;
+
+    const auto &kv_idx = _db.get_index_type<key_value_index>().indices().get<by_scope_primary>();
+    auto add_row = [&](const key_value_object &row) {
+        if (raw)
+            result.rows.emplace_back(row.value);
+        else
+            result.rows.emplace_back(abis->binary_to_variant(row_type, row.value, fc::milliseconds(10000)));
+    };
+
+    if (index_position == 0) {
+        auto itr = kv_idx.lower_bound(boost::make_tuple(primary_table->id, lower_bound));
+        auto end = kv_idx.upper_bound(boost::make_tuple(primary_table->id, upper_bound));
+        for (; itr != end && result.rows.size() < limit; ++itr)
+            add_row(*itr);
+        if (itr != end) {
+            result.more = true;
+            result.next_key = itr->primary_key;
+        }
+        return result;
+    }
+
+    const name index_table((tname.value & 0xFFFFFFFFFFFFFFF0ULL) | uint64_t(index_position - 1));
+    auto secondary_table = table_idx.find(boost::make_tuple(code, name(scope), index_table));
+    if (secondary_table == table_idx.end())
+        return result;
+
+    const auto &idx64 = _db.get_index_type<index64_index>().indices().get<by_secondary>();
+    auto itr = idx64.lower_bound(boost::make_tuple(secondary_table->id, lower_bound, lower_primary_key));
+    auto end = idx64.upper_bound(boost::make_tuple(secondary_table->id, upper_bound));
+    for (; itr != end && result.rows.size() < limit; ++itr) {
+        auto row = kv_idx.find(boost::make_tuple(primary_table->id, itr->primary_key));
+        if (row != kv_idx.end())
+            add_row(*row);
+    }
+    if (itr != end) {
+        result.more = true;
+        result.next_key = itr->secondary_key;
+        result.next_primary_key = itr->primary_key;
+    }
+    return result;
+    }
+    FC_CAPTURE_AND_RETHROW((contract)(table)(scope)(lower_bound)(upper_bound)(limit)(index_position)(raw)(lower_primary_key))
+}
+
 bytes database_api_impl::serialize_contract_call_args(string contract, string method, string json_args) const
 {
-    auto contract_obj = get_account_by_name(contract);
-    if(!contract_obj) {
+    const auto &accounts_by_name = _db.get_index_type<account_index>().indices().get<by_name>();
+    auto contract_itr = accounts_by_name.find(contract);
+    if(contract_itr == accounts_by_name.end()) {
         return bytes();
     }
 
     fc::variant action_args_var = fc::json::from_string(json_args);
 
-    abi_serializer abis(contract_obj->abi, fc::milliseconds(10000));
-    auto action_type = abis.get_action_type(method);
+    auto abis = _abi_cache->get_serializer(*contract_itr);
+    auto action_type = abis->get_action_type(method);
     GRAPHENE_ASSERT(!action_type.empty(), action_validate_exception, "Unknown action ${action} in contract ${contract}", ("action", method)("contract", contract));
-    bytes bin_data = abis.variant_to_binary(action_type, action_args_var, fc::milliseconds(10000));
+    bytes bin_data = abis->variant_to_binary(action_type, action_args_var, fc::milliseconds(10000));
     return bin_data;
 }
 
 void database_api_impl::set_subscribe_callback( std::function<void(const variant&)> cb, bool notify_remove_create )
 {
    //edump((clear_filter));
+   // read-only calls of this connection that are running on reader threads use the subscription
+   state_lock::write_guard write_lock( _db.get_state_lock() );
    _subscribe_callback = cb;
    _notify_remove_create = notify_remove_create;
+   reset_subscriber( _subscribe_queue, cb, _dispatcher->get_object_overflow_policy() );
+   std::lock_guard<std::mutex> lock( _subscribed_accounts_mutex );
    _subscribed_accounts.clear();
-
-   static fc::bloom_parameters param;
-   param.projected_element_count    = 10000;
-   param.false_positive_probability = 1.0/100;
-   param.maximum_size = 1024*8*8*2;
-   param.compute_optimal_parameters();
-   _subscribe_filter = fc::bloom_filter(param);
 }
 
 void database_api_impl::set_data_transaction_subscribe_callback( std::function<void(const variant&)> cb, bool notify_remove_create )
 {
    //edump((clear_filter));
    _data_transaction_subscribe_callback = cb;
+   reset_subscriber( _data_transaction_queue, cb, subscription_overflow_drop_oldest );
 }
 
 void database_api_impl::set_data_transaction_products_subscribe_callback(std::function<void(const variant&)> cb, vector<object_id_type> ids)
 {
     _data_transaction_subscribe_products = ids;
     _data_transaction_products_subscribe_callback = cb;
+    reset_subscriber( _data_transaction_products_queue, cb, subscription_overflow_drop_oldest );
 }
 
 void database_api_impl::set_pending_transaction_callback( std::function<void(const variant&)> cb )
@@ -214,19 +372,47 @@ void database_api_impl::set_pending_transaction_callback( std::function<void(con
 void database_api_impl::set_block_applied_callback( std::function<void(const variant& block_id)> cb )
 {
    _block_applied_callback = cb;
+   reset_subscriber( _block_applied_queue, cb, subscription_overflow_coalesce );
 }
 
 void database_api_impl::cancel_all_subscriptions()
 {
    set_subscribe_callback( std::function<void(const fc::variant&)>(), true);
-   _data_transaction_subscribe_callback =  std::function<void(const fc::variant&)>();
-   _data_transaction_products_subscribe_callback =  std::function<void(const fc::variant&)>();
+   set_data_transaction_subscribe_callback( std::function<void(const fc::variant&)>(), true );
+   set_data_transaction_products_subscribe_callback( std::function<void(const fc::variant&)>(), vector<object_id_type>() );
 }
 
 void database_api_impl::unsubscribe_data_transaction_callback()
 {
     dlog("unsubscribe_data_transaction_callback");
-    _data_transaction_subscribe_callback =  std::function<void(const fc::variant&)>();
+    set_data_transaction_subscribe_callback( std::function<void(const fc::variant&)>(), true );
+}
+
+subscription_queue_metrics database_api_impl::get_subscription_metrics()const
+{
+   return _dispatcher->get_metrics();
+}
+
+api_latency_metrics database_api_impl::get_api_latency_metrics()const
+{
+   return _readers->get_latency_metrics();
+}
+
+vector<irreversible_consumer_metrics> database_api_impl::get_irreversible_consumer_metrics()const
+{
+   // not kept by the connection, the stream ends with the application
+   return irreversible_block_stream::get( _db )->get_metrics();
+}
+
+void database_api_impl::reset_subscriber( std::shared_ptr<subscription_dispatcher::subscriber>& queue,
+                                          const std::function<void(const fc::variant&)>& cb,
+                                          subscription_overflow_policy policy )
+{
+   if( queue )
+      _dispatcher->remove_subscriber( queue );
+   queue.reset();
+   if( cb )
+      queue = _dispatcher->create_subscriber( cb, policy );
 }
 
 optional<block_header> database_api_impl::get_block_header(uint32_t block_num) const
@@ -320,13 +506,6 @@ vector<vector<account_id_type>> database_api_impl::get_key_references( vector<pu
       address a4( pts_address(key, true, 0)  );
       address a5( key );
 
-      subscribe_to_item( key );
-      subscribe_to_item( a1 );
-      subscribe_to_item( a2 );
-      subscribe_to_item( a3 );
-      subscribe_to_item( a4 );
-      subscribe_to_item( a5 );
-
       const auto& idx = _db.get_index_type<account_index>();
       const auto& aidx = dynamic_cast<const primary_index<account_index>&>(idx);
       const auto& refs = aidx.get_secondary_index<graphene::chain::account_member_index>();
@@ -354,8 +533,9 @@ vector<vector<account_id_type>> database_api_impl::get_key_references( vector<pu
       final_result.emplace_back( std::move(result) );
    }
 
-   for( auto i : final_result )
-      subscribe_to_item(i);
+   for( const auto& accounts : final_result )
+      for( const auto& account : accounts )
+         subscribe_to_item( account );
 
    return final_result;
 }
@@ -437,8 +617,11 @@ std::map<std::string, full_account> database_api_impl::get_full_accounts( const
 
       if( subscribe )
       {
-         FC_ASSERT(_subscribed_accounts.size() <= 100);
-         _subscribed_accounts.insert( account->get_id() );
+         {
+            std::lock_guard<std::mutex> lock( _subscribed_accounts_mutex );
+            FC_ASSERT(_subscribed_accounts.size() <= 100);
+            _subscribed_accounts.insert( account->get_id() );
+         }
          subscribe_to_item( account->id );
       }
 
@@ -679,10 +862,10 @@ vector<balance_object> database_api_impl::get_balance_objects( const vector<addr
 
       for( const auto& owner : addrs )
       {
-         subscribe_to_item( owner );
          auto itr = by_owner_idx.lower_bound( boost::make_tuple( owner, asset_id_type(0) ) );
          while( itr != by_owner_idx.end() && itr->owner == owner )
          {
+            subscribe_to_item( itr->id );
             result.push_back( *itr );
             ++itr;
          }
@@ -830,54 +1013,24 @@ uint64_t database_api_impl::get_data_transaction_total_count_by_product_id(strin
 
 map<account_id_type, uint64_t> database_api_impl::list_data_transaction_complain_requesters(fc::time_point_sec start_date_time, fc::time_point_sec end_date_time, uint8_t limit) const
 {
-    const auto& idx = _db.get_index_type<data_transaction_complain_index>().indices().get<by_create_date_time>();
-    auto itr_start = idx.lower_bound(start_date_time);
-    auto itr_end = idx.upper_bound(end_date_time);
+    const auto& complain_idx = _db.get_index_type<data_transaction_complain_index>();
+    const auto& ranks = complain_idx.get_secondary_index<data_transaction_complain_rank_index>();
 
     map<account_id_type, uint64_t> accounts;
-    for(const auto& obj : boost::make_iterator_range(itr_start, itr_end)){
-        accounts[obj.requester] = 0;
-    }
-    for(const auto& obj : boost::make_iterator_range(itr_start, itr_end)){
-        ++accounts[obj.requester];
-    }
-
-    //sort
-    vector<PAIR> requesters(accounts.begin(), accounts.end());
-    sort(requesters.begin(), requesters.end(), cmp_pair_by_value());
-
-    std::map<account_id_type, uint64_t> results;
-    for(uint64_t i = 0; i < limit && i < requesters.size(); ++i){
-        results.insert(requesters.at(i));
-    }
-
-    return results;
+    count_accounts_in_range(complain_idx.indices().get<by_create_date_time>(), ranks.requesters, start_date_time, end_date_time,
+                            [](const data_transaction_complain_object& obj) { return obj.requester; }, accounts);
+    return top_accounts(accounts, limit);
 }
 
 map<account_id_type, uint64_t> database_api_impl::list_data_transaction_complain_datasources(fc::time_point_sec start_date_time, fc::time_point_sec end_date_time, uint8_t limit) const
 {
-    const auto& idx = _db.get_index_type<data_transaction_complain_index>().indices().get<by_create_date_time>();
-    auto itr_start = idx.lower_bound(start_date_time);
-    auto itr_end = idx.upper_bound(end_date_time);
+    const auto& complain_idx = _db.get_index_type<data_transaction_complain_index>();
+    const auto& ranks = complain_idx.get_secondary_index<data_transaction_complain_rank_index>();
 
     map<account_id_type, uint64_t> accounts;
-    for (const auto& obj : boost::make_iterator_range(itr_start, itr_end)) {
-        accounts[obj.datasource] = 0;
-    }
-    for (const auto& obj : boost::make_iterator_range(itr_start, itr_end)) {
-        ++accounts[obj.datasource];
-    }
-
-    // sort
-    vector<PAIR> datasources(accounts.begin(), accounts.end());
-    sort(datasources.begin(), datasources.end(), cmp_pair_by_value());
-
-    std::map<account_id_type, uint64_t> results;
-    for (uint8_t i = 0; i < limit && i < datasources.size(); ++i) {
-        results.insert(datasources.at(i));
-    }
-
-    return results;
+    count_accounts_in_range(complain_idx.indices().get<by_create_date_time>(), ranks.datasources, start_date_time, end_date_time,
+                            [](const data_transaction_complain_object& obj) { return obj.datasource; }, accounts);
+    return top_accounts(accounts, limit);
 }
 
 optional<pocs_object> database_api_impl::get_pocs_object(league_id_type league_id, account_id_type account_id, object_id_type product_id    )const
@@ -1262,6 +1415,7 @@ vector< fc::variant > database_api_impl::get_required_fees( const vector<operati
    {
        if (op.which() == operation::tag<contract_call_operation>::value) {
 
+           state_lock::write_guard write_lock( _db.get_state_lock() );
            auto tmp_session = _db._undo_db.start_undo_session();
            contract_call_operation &opr = op.get<contract_call_operation>();
            transaction_context trx_context(_db, opr.fee_payer().instance, fc::microseconds(_db.get_cpu_limit().trx_cpu_limit));
@@ -1339,32 +1493,17 @@ vector<blinded_balance_object> database_api_impl::get_blinded_balances( const fl
 
 void database_api_impl::broadcast_data_transaction_updates(const fc::variant& update)
 {
-   if (_data_transaction_subscribe_callback) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this,update](){
-          if(capture_this->_data_transaction_subscribe_callback)
-            capture_this->_data_transaction_subscribe_callback(update);
-      });
-   }
+   if (_data_transaction_queue)
+      _dispatcher->push(_data_transaction_queue, update);
 
-   if (_data_transaction_products_subscribe_callback) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this,update](){
-          if(capture_this->_data_transaction_products_subscribe_callback)
-            capture_this->_data_transaction_products_subscribe_callback(update);
-      });
-   }
+   if (_data_transaction_products_queue)
+      _dispatcher->push(_data_transaction_products_queue, update);
 }
 
 void database_api_impl::broadcast_updates( const vector<variant>& updates )
 {
-   if( updates.size() && _subscribe_callback ) {
-      auto capture_this = shared_from_this();
-      fc::async([capture_this,updates](){
-          if(capture_this->_subscribe_callback)
-            capture_this->_subscribe_callback( fc::variant(updates) );
-      });
-   }
+   if( updates.size() && _subscribe_queue )
+      _dispatcher->push( _subscribe_queue, fc::variant(updates) );
 }
 
 void database_api_impl::on_objects_removed( const vector<object_id_type>& ids, const vector<const object*>& objs, const flat_set<account_id_type>& impacted_accounts)
@@ -1450,7 +1589,7 @@ void database_api_impl::on_data_transaction_objects_changed(const string& reques
     if (_data_transaction_subscribe_callback) {
         auto obj = get_data_transaction_by_request_id(request_id);
         if (obj.valid()) {
-            broadcast_data_transaction_updates(obj->to_variant());
+            broadcast_data_transaction_updates(fc::variant(*obj, GRAPHENE_MAX_NESTED_OBJECTS));
         } else {
             dlog("get no data_transaction_object, request_id ${r}", ("r", request_id));
         }
@@ -1463,7 +1602,7 @@ void database_api_impl::on_data_transaction_objects_changed(const string& reques
             auto& products = _data_transaction_subscribe_products;
             auto iter = std::find(products.begin(), products.end(), obj->product_id);
             if (iter != products.end()) {
-                broadcast_data_transaction_updates(obj->to_variant());
+                broadcast_data_transaction_updates(fc::variant(*obj, GRAPHENE_MAX_NESTED_OBJECTS));
             } else {
                 dlog("product_id ${p} not subscribed", ("p", obj->product_id));
             }
@@ -1479,24 +1618,28 @@ void database_api_impl::handle_object_changed(bool force_notify, bool full_objec
    if( _subscribe_callback )
    {
       vector<variant> updates;
-
-      for(auto id : ids)
-      {
-         if( force_notify || is_subscribed_to_item(id) || is_impacted_account(impacted_accounts) )
+      auto add_update = [&]( object_id_type id ) {
+         if( full_object )
          {
-            if( full_object )
+            auto obj = find_object(id);
+            if( obj )
             {
-               auto obj = find_object(id);
-               if( obj )
-               {
-                  updates.emplace_back( obj->to_variant() );
-               }
-            }
-            else
-            {
-               updates.emplace_back( fc::variant( id, 1 ) );
+               updates.emplace_back( _dispatcher->object_variant( *obj ) );
             }
          }
+         else
+         {
+            updates.emplace_back( fc::variant( id, 1 ) );
+         }
+      };
+
+      // the dispatcher has already matched ids against the subscriptions of all connections
+      if( force_notify || is_impacted_account(impacted_accounts) )
+         std::for_each( ids.begin(), ids.end(), add_update );
+      else
+      {
+         const auto& matched = _dispatcher->matched_items( _subscribe_queue );
+         std::for_each( matched.begin(), matched.end(), add_update );
       }
 
       broadcast_updates(updates);
@@ -1509,14 +1652,8 @@ void database_api_impl::handle_object_changed(bool force_notify, bool full_objec
  */
 void database_api_impl::on_applied_block()
 {
-   if (_block_applied_callback)
-   {
-      auto capture_this = shared_from_this();
-      block_id_type block_id = _db.head_block_id();
-      fc::async([this,capture_this,block_id](){
-         _block_applied_callback(fc::variant(block_id, 1));
-      });
-   }
+   if (_block_applied_queue)
+      _dispatcher->push(_block_applied_queue, fc::variant(_db.head_block_id(), 1));
 
 }
 
@@ -1695,46 +1832,31 @@ data_transaction_search_results_object database_api_impl::list_data_transactions
 }
 
 map<account_id_type, uint64_t> database_api_impl::list_second_hand_datasources(time_point_sec start_date_time, time_point_sec end_date_time, uint32_t limit) const {
-    const auto& idx = _db.get_index_type<second_hand_data_index>().indices().get<by_create_date_time>();
-    auto range = idx.equal_range(boost::make_tuple(start_date_time, end_date_time));
+    const auto& second_hand_idx = _db.get_index_type<second_hand_data_index>();
+    const auto& ranks = second_hand_idx.get_secondary_index<second_hand_data_rank_index>();
 
-    std::map<account_id_type, uint64_t> datasource_accounts;
-    for (const second_hand_data_object& obj : boost::make_iterator_range(range.first, range.second)) {
-        datasource_accounts[obj.second_hand_datasource_id] = 0;
-    }
-    for (const second_hand_data_object& obj : boost::make_iterator_range(range.first, range.second)) {
-        ++datasource_accounts[obj.second_hand_datasource_id];
-    }
-
-    // sort
-    vector<PAIR> datasource_vec(datasource_accounts.begin(), datasource_accounts.end());
-    sort(datasource_vec.begin(), datasource_vec.end(), cmp_pair_by_value());
-
-    std::map<account_id_type, uint64_t> results;
-    for (int i = 0; i < limit && i < datasource_vec.size(); ++i) {
-        results.insert(datasource_vec.at(i));
-    }
-
-    return results;
+    map<account_id_type, uint64_t> datasource_accounts;
+    count_accounts_in_range(second_hand_idx.indices().get<by_create_date_time>(), ranks.datasources, start_date_time, end_date_time,
+                            [](const second_hand_data_object& obj) { return obj.second_hand_datasource_id; }, datasource_accounts);
+    return top_accounts(datasource_accounts, limit);
 }
 
 uint32_t database_api_impl::list_total_second_hand_transaction_counts_by_datasource(fc::time_point_sec start_date_time, fc::time_point_sec end_date_time, account_id_type datasource_account) const {
-    return _db.get_index_type<second_hand_data_index>().indices().size();
- }
+    const auto& second_hand_idx = _db.get_index_type<second_hand_data_index>();
+    const auto& ranks = second_hand_idx.get_secondary_index<second_hand_data_rank_index>();
 
-optional<data_transaction_object> database_api_impl::get_data_transaction_by_request_id(string request_id) const {
-    vector<data_transaction_object> result;
+    return count_account_in_range(second_hand_idx.indices().get<by_create_date_time>(), ranks.datasources, start_date_time, end_date_time,
+                                  [](const second_hand_data_object& obj) { return obj.second_hand_datasource_id; }, datasource_account);
+}
 
-    const auto& dt_idx = _db.get_index_type<data_transaction_index>();
-    auto range = dt_idx.indices().get<by_request_id>().equal_range(request_id);
-    for (const auto& obj : boost::make_iterator_range(range.first, range.second)) {
-        result.push_back(obj);
+optional<data_transaction_api_object> database_api_impl::get_data_transaction_by_request_id(string request_id) const {
+    const auto& dt_idx = _db.get_index_type<data_transaction_index>().indices().get<by_request_id>();
+    auto itr = dt_idx.find(request_id);
+    if (itr == dt_idx.end()) {
+        return {};
     }
 
-    if (!result.empty()) {
-        return result.back();
-    }
-    return {};
+    return data_transaction_api_object(*itr, _db);
 }
 
 league_search_results_object database_api_impl::list_leagues(string data_market_category_id,uint32_t offset,uint32_t limit,string order_by,string keyword,bool show_all) const {
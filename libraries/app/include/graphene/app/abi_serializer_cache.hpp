@@ -0,0 +1,75 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/abi_serializer.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+/**
+ *  @brief Keeps the abi_serializer of recently used contracts of one database
+ *
+ *  A serializer is built once per contract and code_version and shared by all API connections.  The entry of a
+ *  contract is dropped whenever its account object changes, so that an ABI updated together with unchanged code
+ *  is picked up as well.
+ */
+class abi_serializer_cache
+{
+   public:
+      static const uint32_t default_capacity = 256;
+
+      explicit abi_serializer_cache( database& db, uint32_t capacity = default_capacity );
+      ~abi_serializer_cache();
+
+      /** @return the cache shared by all API connections of db, created on first use */
+      static std::shared_ptr<abi_serializer_cache> get( database& db );
+
+      /** @return the serializer of the ABI of contract, built if it is not cached */
+      std::shared_ptr<const abi_serializer> get_serializer( const account_object& contract );
+
+      uint32_t size()const;
+
+   private:
+      struct entry
+      {
+         string                                code_version;
+         std::shared_ptr<const abi_serializer> serializer;
+         uint64_t                              last_used = 0;
+      };
+
+      void on_accounts_changed( const vector<object_id_type>& ids );
+
+      database&                              _db;
+      const uint32_t                         _capacity;
+      boost::signals2::scoped_connection     _change_connection;
+
+      mutable std::mutex                     _mutex;
+      std::map< account_id_type, entry >     _entries;
+      uint64_t                               _use_counter = 0;
+};
+
+} } // graphene::app
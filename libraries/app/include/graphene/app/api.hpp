@@ -95,7 +95,7 @@ namespace graphene { namespace app {
    class history_api
    {
       public:
-         history_api(application& app):_app(app){}
+         history_api(application& app);
 
          /**
           * @brief Get operations relevant to the specificed account
@@ -156,6 +156,7 @@ namespace graphene { namespace app {
                                                                         uint32_t start = 0) const;
       private:
            application& _app;
+           std::shared_ptr<api_reader_pool> _readers;
    };
 
    /**
@@ -259,12 +260,21 @@ namespace graphene { namespace app {
          asset_api(graphene::chain::database& db);
          ~asset_api();
 
-         vector<account_asset_balance> get_asset_holders( asset_id_type asset_id )const;
+         /**
+          * @brief Get the accounts holding an asset, ordered by balance from largest to smallest
+          * @param asset_id the asset to look up
+          * @param start the number of holders to skip
+          * @param limit the maximum number of holders to return, at most 100
+          */
+         vector<account_asset_balance> get_asset_holders( asset_id_type asset_id, uint32_t start, uint32_t limit )const;
+         /** @return the number of accounts with a non-zero balance of asset_id */
          int get_asset_holders_count( asset_id_type asset_id )const;
+         /** @return the number of accounts with a non-zero balance of each asset */
          vector<asset_holders> get_all_asset_holders() const;
 
       private:
          graphene::chain::database& _db;
+         std::shared_ptr<api_reader_pool> _readers;
    };
 
    /**
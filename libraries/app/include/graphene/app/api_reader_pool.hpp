@@ -0,0 +1,124 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/execution_profiler.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+/** latencies of one API method, buckets as in latency_histogram */
+struct api_latency_histogram
+{
+   string           method;
+   uint64_t         count    = 0;
+   uint64_t         total_us = 0;
+   uint64_t         max_us   = 0;
+   /** upper bounds of the buckets holding the median and the 99th percentile */
+   uint64_t         p50_us   = 0;
+   uint64_t         p99_us   = 0;
+   /** latency_histogram::buckets without the trailing empty buckets */
+   vector<uint64_t> buckets;
+};
+
+struct api_latency_metrics
+{
+   /** 0 when read-only calls run on the thread that applies blocks */
+   uint32_t                      reader_threads = 0;
+   vector<api_latency_histogram> methods;
+};
+
+/**
+ *  @brief Runs the read-only API calls of all connections of one database
+ *
+ *  With reader threads configured, a read-only call is executed on one of them while holding the state lock
+ *  shared, so that it sees the state between two writes (a pushed block or transaction) and several calls run
+ *  in parallel.  Block application takes the lock exclusively and waits only for the calls already running.
+ *  Without reader threads, calls run on the calling thread as before.
+ *
+ *  The latency of every call is recorded per method in either mode.
+ */
+class api_reader_pool
+{
+   public:
+      explicit api_reader_pool( database& db ):_db(db){}
+      ~api_reader_pool();
+
+      /** @return the pool shared by all API connections of db, created on first use */
+      static std::shared_ptr<api_reader_pool> get( database& db );
+
+      /** starts count reader threads, must be called before any API connection exists */
+      void     set_thread_count( uint32_t count );
+      uint32_t get_thread_count()const { return _threads.size(); }
+
+      /** @return the result of f, which must not modify the database */
+      template<typename Func>
+      auto run( const char* method, Func&& f ) -> decltype( f() )
+      {
+         latency_timer timer( *this, method );
+         // reads issued while applying a block, e.g. from a signal handler, cannot wait for the write to end,
+         // and nested calls already hold the lock shared
+         if( _threads.empty() || _db.get_state_lock().owns_write_lock() || on_reader_thread() )
+            return f();
+         fc::thread& reader = *_threads[ _next_thread++ % _threads.size() ];
+         return reader.async( [this,&f]() {
+            state_lock::read_guard lock( _db.get_state_lock() );
+            return f();
+         }, method ).wait();
+      }
+
+      void record_latency( const char* method, uint64_t us );
+      api_latency_metrics get_latency_metrics()const;
+      void clear_latency_metrics();
+
+   private:
+      bool on_reader_thread()const;
+
+      struct latency_timer
+      {
+         latency_timer( api_reader_pool& p, const char* m ):pool(p),method(m),start(fc::time_point::now()){}
+         ~latency_timer() { pool.record_latency( method, ( fc::time_point::now() - start ).count() ); }
+
+         api_reader_pool& pool;
+         const char*      method;
+         fc::time_point   start;
+      };
+
+      database&                                  _db;
+      vector< std::unique_ptr<fc::thread> >      _threads;
+      std::atomic<uint32_t>                      _next_thread{0};
+
+      mutable std::mutex                         _latency_mutex;
+      std::map< std::string, latency_histogram > _latencies;
+};
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::api_latency_histogram, (method)(count)(total_us)(max_us)(p50_us)(p99_us)(buckets) )
+FC_REFLECT( graphene::app::api_latency_metrics, (reader_threads)(methods) )
@@ -40,6 +40,9 @@
 #include <graphene/chain/data_market_object.hpp>
 #include <graphene/chain/data_transaction_object.hpp>
 #include <graphene/app/database_api_common.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+#include <graphene/app/api_reader_pool.hpp>
+#include <graphene/app/irreversible_block_stream.hpp>
 #include <graphene/chain/pocs_object.hpp>
 
 #include <fc/api.hpp>
@@ -86,6 +89,26 @@ class database_api
        */
       fc::variants get_objects(const vector<object_id_type>& ids)const;
       fc::variants get_table_objects(uint64_t code, uint64_t scope, uint64_t table) const;
+
+      /**
+       * @brief Get one page of the rows of a contract table
+       * @param contract name of the contract
+       * @param table name of the table in the contract ABI
+       * @param scope scope of the table
+       * @param lower_bound lowest key to return
+       * @param upper_bound highest key to return
+       * @param limit maximum number of rows to return, at most 1000
+       * @param index_position 0 to page by primary key, n to page by the key of the n-th idx64 secondary index
+       * @param raw return the packed rows as hex instead of decoding them with the contract ABI
+       * @param lower_primary_key with a secondary index, skips the rows whose key is lower_bound and whose primary key
+       *        is lower than this
+       * @return the rows with lower_bound <= key <= upper_bound in key order, and whether more rows follow
+       *
+       * When more is set, next_key and next_primary_key are the lower_bound and lower_primary_key of the next page.
+       * Secondary keys need not be unique, the primary key tells where a page ended among rows with the same key.
+       */
+      table_rows get_table_rows(string contract, string table, uint64_t scope, uint64_t lower_bound, uint64_t upper_bound,
+                                uint32_t limit, uint8_t index_position, bool raw, uint64_t lower_primary_key = 0) const;
       bytes serialize_contract_call_args(string contract, string method, string json_args) const;
 
       ///////////////////
@@ -104,6 +127,21 @@ class database_api
        */
       void cancel_all_subscriptions();
       void unsubscribe_data_transaction_callback();
+      /**
+       * @brief Get the state of the subscription queues shared by all API connections
+       * @return number of subscribers, queued updates and how many updates were delivered, failed, coalesced or dropped
+       */
+      subscription_queue_metrics get_subscription_metrics()const;
+      /**
+       * @brief Get the latency histograms of the API methods that may run on reader threads
+       * @return the number of reader threads and, per method, the call count and latencies in microseconds
+       */
+      api_latency_metrics get_api_latency_metrics()const;
+      /**
+       * @brief Get the progress of the plugins consuming irreversible blocks on their own threads
+       * @return per consumer its cursor, lag behind the last irreversible block and throughput
+       */
+      vector<irreversible_consumer_metrics> get_irreversible_consumer_metrics()const;
 
       /////////////////////////////
       // Blocks and transactions //
@@ -715,7 +753,7 @@ class database_api
     vector<optional<league_object>> get_leagues(const vector<league_id_type>& league_ids) const;
 
 
-    optional<data_transaction_object> get_data_transaction_by_request_id(string request_id) const;
+    optional<data_transaction_api_object> get_data_transaction_by_request_id(string request_id) const;
     data_transaction_search_results_object list_data_transactions_by_requester(string requester, uint32_t limit) const;
 
 
@@ -739,6 +777,7 @@ FC_API(graphene::app::database_api,
    // Objects
    (get_objects)
    (get_table_objects)
+   (get_table_rows)
    (serialize_contract_call_args)
    (serialize_transaction)
    // Subscriptions
@@ -749,6 +788,9 @@ FC_API(graphene::app::database_api,
    (set_block_applied_callback)
    (cancel_all_subscriptions)
    (unsubscribe_data_transaction_callback)
+   (get_subscription_metrics)
+   (get_api_latency_metrics)
+   (get_irreversible_consumer_metrics)
 
    // Blocks and transactions
    (get_block_header)
@@ -24,6 +24,9 @@
 #pragma once
 
 #include <fc/api.hpp>
+#include <fc/variant.hpp>
+
+#include <vector>
 
 namespace graphene { namespace app {
 
@@ -34,7 +37,21 @@ struct order
    double                     base;
 };
 
+/** one page of contract table rows */
+struct table_rows
+{
+   /** decoded rows, or the packed row bytes as hex in raw mode */
+   std::vector<fc::variant>   rows;
+   /** true when rows within the bounds were left out because of the limit */
+   bool                       more = false;
+   /** key of the first row left out, the lower bound of the next page */
+   uint64_t                   next_key = 0;
+   /** with a secondary index, primary key of the first row left out, the lower_primary_key of the next page */
+   uint64_t                   next_primary_key = 0;
+};
+
 }} //
 
 FC_REFLECT( graphene::app::order, (price)(quote)(base) );
+FC_REFLECT( graphene::app::table_rows, (rows)(more)(next_key)(next_primary_key) );
 
@@ -41,12 +41,15 @@
 #include <graphene/chain/data_transaction_object.hpp>
 #include <graphene/chain/second_hand_data_object.hpp>
 #include <graphene/app/database_api_common.hpp>
+#include <graphene/app/subscription_dispatcher.hpp>
+#include <graphene/app/api_reader_pool.hpp>
+#include <graphene/app/abi_serializer_cache.hpp>
+#include <graphene/app/irreversible_block_stream.hpp>
 #include <graphene/chain/pocs_object.hpp>
 
 #include <fc/api.hpp>
 #include <fc/optional.hpp>
 #include <fc/variant_object.hpp>
-#include <fc/bloom_filter.hpp>
 #include <fc/smart_ref_impl.hpp>
 
 #include <boost/container/flat_set.hpp>
@@ -54,6 +57,7 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace graphene { namespace app {
@@ -80,6 +84,8 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       // Objects
       fc::variants get_objects(const vector<object_id_type>& ids)const;
       fc::variants get_table_objects(uint64_t code, uint64_t scope, uint64_t table) const;
+      table_rows get_table_rows(string contract, string table, uint64_t scope, uint64_t lower_bound, uint64_t upper_bound,
+                                uint32_t limit, uint8_t index_position, bool raw, uint64_t lower_primary_key) const;
       bytes serialize_contract_call_args(string contract, string method, string json_args) const;
 
       // Subscriptions
@@ -90,6 +96,9 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void set_block_applied_callback( std::function<void(const variant& block_id)> cb );
       void cancel_all_subscriptions();
       void unsubscribe_data_transaction_callback();
+      subscription_queue_metrics get_subscription_metrics()const;
+      api_latency_metrics get_api_latency_metrics()const;
+      vector<irreversible_consumer_metrics> get_irreversible_consumer_metrics()const;
 
       // Blocks and transactions
       optional<block_header> get_block_header(uint32_t block_num)const;
@@ -230,7 +239,7 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
      */
     league_search_results_object  list_leagues(string data_market_category_id,uint32_t offset,uint32_t limit,string order_by,string keyword,bool show_all = false) const;
 
-    optional<data_transaction_object> get_data_transaction_by_request_id(string request_id) const;
+    optional<data_transaction_api_object> get_data_transaction_by_request_id(string request_id) const;
     data_transaction_search_results_object list_data_transactions_by_requester(string requester, uint32_t limit) const;
 
     map<account_id_type, uint64_t> list_second_hand_datasources(time_point_sec start_date_time, time_point_sec end_date_time, uint32_t limit) const;
@@ -253,30 +262,25 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
     uint32_t get_witness_participation_rate() const;
 
    //private:
-      template<typename T>
-      void subscribe_to_item( const T& i )const
+      void subscribe_to_item( object_id_type id )const
       {
-         auto vec = fc::raw::pack(i);
-         if( !_subscribe_callback )
+         if( !_subscribe_queue )
             return;
 
-         if( !is_subscribed_to_item(i) )
-         {
-            _subscribe_filter.insert( vec.data(), vec.size() );//(vecconst char*)&i, sizeof(i) );
-         }
+         _dispatcher->subscribe_to_item( _subscribe_queue, id );
       }
 
-      template<typename T>
-      bool is_subscribed_to_item( const T& i )const
+      bool is_subscribed_to_item( object_id_type id )const
       {
-         if( !_subscribe_callback )
+         if( !_subscribe_queue )
             return false;
 
-         return _subscribe_filter.contains( i );
+         return _dispatcher->is_subscribed_to_item( _subscribe_queue, id );
       }
 
       bool is_impacted_account( const flat_set<account_id_type>& accounts)
       {
+         std::lock_guard<std::mutex> lock( _subscribed_accounts_mutex );
          if( !_subscribed_accounts.size() || !accounts.size() )
             return false;
 
@@ -297,9 +301,15 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       void broadcast_data_transaction_updates(const fc::variant& update);
       void on_data_transaction_objects_changed(const string& request_id);
 
+      /** cancels the queue of a replaced callback and creates a new one when cb is set */
+      void reset_subscriber( std::shared_ptr<subscription_dispatcher::subscriber>& queue,
+                             const std::function<void(const fc::variant&)>& cb,
+                             subscription_overflow_policy policy );
+
       bool _notify_remove_create = false;
-      mutable fc::bloom_filter _subscribe_filter;
       std::set<account_id_type> _subscribed_accounts;
+      // get_full_accounts calls of one connection may run on several reader threads
+      std::mutex                _subscribed_accounts_mutex;
 
       // for data transaction subscribe
       std::function<void(const fc::variant&)> _data_transaction_subscribe_callback;
@@ -311,6 +321,19 @@ class database_api_impl : public std::enable_shared_from_this<database_api_impl>
       std::function<void(const fc::variant&)> _pending_trx_callback;
       std::function<void(const fc::variant&)> _block_applied_callback;
 
+      // subscription callbacks are invoked through these queues on the dispatcher thread
+      std::shared_ptr<subscription_dispatcher>              _dispatcher;
+      std::shared_ptr<subscription_dispatcher::subscriber>  _subscribe_queue;
+      std::shared_ptr<subscription_dispatcher::subscriber>  _block_applied_queue;
+      std::shared_ptr<subscription_dispatcher::subscriber>  _data_transaction_queue;
+      std::shared_ptr<subscription_dispatcher::subscriber>  _data_transaction_products_queue;
+
+      // runs the read-only calls, on the reader threads when they are enabled
+      std::shared_ptr<api_reader_pool>                      _readers;
+
+      // ABIs of the contracts whose tables and calls are serialized, shared by all connections
+      std::shared_ptr<abi_serializer_cache>                 _abi_cache;
+
       boost::signals2::scoped_connection                                                                                           _new_connection;
       boost::signals2::scoped_connection                                                                                           _change_connection;
       boost::signals2::scoped_connection                                                                                           _removed_connection;
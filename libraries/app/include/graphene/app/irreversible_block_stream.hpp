@@ -0,0 +1,114 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/thread/thread.hpp>
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+/** progress of one consumer of the irreversible block stream */
+struct irreversible_consumer_metrics
+{
+   string   name;
+   /** last block handed to the consumer and handled without error */
+   uint32_t cursor             = 0;
+   uint32_t last_irreversible  = 0;
+   /** irreversible blocks the consumer has not handled yet */
+   uint32_t lag                = 0;
+   uint64_t blocks_handled     = 0;
+   uint64_t handler_us         = 0;
+   /** blocks handled per second of handler time */
+   uint64_t blocks_per_second  = 0;
+   /** set when the handler threw or the next block was pruned, the consumer resumes from its cursor after a restart */
+   bool     failed             = false;
+   string   last_error;
+};
+
+/**
+ *  @brief Streams irreversible blocks of one database to consumers running on their own threads
+ *
+ *  Plugins that keep their own storage do not need to run inside block application.  A consumer subscribes with a
+ *  handler that is called on a worker thread of its own with every irreversible block, in order and with the
+ *  operation results of its transactions.  The chain thread only reads the blocks from the block database and
+ *  hands them over in batches, a consumer that falls behind catches up at its own pace.
+ *
+ *  The number of the last block a consumer handled is kept in a cursor file, so that it continues after a restart
+ *  with the next block.  A consumer whose next block was pruned from the block database fails instead of waiting
+ *  for it.  Consumers must be subscribed and unsubscribed on the thread that applies blocks.
+ */
+class irreversible_block_stream : public std::enable_shared_from_this<irreversible_block_stream>
+{
+   public:
+      typedef std::function<void(const signed_block&)> handler_type;
+
+      /** blocks fetched for a consumer at once, and at most twice as many are queued on its thread */
+      static const uint32_t default_batch_size = 100;
+
+      explicit irreversible_block_stream( database& db );
+      ~irreversible_block_stream();
+
+      /** @return the stream of db, created on first use */
+      static std::shared_ptr<irreversible_block_stream> get( database& db );
+
+      /** cursor files of consumers subscribed afterwards are kept in dir, without it cursors are not saved */
+      void set_cursor_directory( const fc::path& dir );
+
+      /**
+       *  Starts handing irreversible blocks to handler, beginning after the block recorded in the cursor file of
+       *  name, or after start_block when there is none.
+       */
+      void subscribe( const string& name, handler_type handler, uint32_t start_block = 0,
+                      uint32_t batch_size = default_batch_size );
+      /** stops the consumer after the block it is handling, its cursor is kept */
+      void unsubscribe( const string& name );
+
+      vector<irreversible_consumer_metrics> get_metrics()const;
+
+   private:
+      struct consumer;
+
+      void on_applied_block();
+      void refill( consumer& c );
+
+      database&                                        _db;
+      /** the thread consumers were subscribed on, which applies blocks */
+      fc::thread*                                      _chain_thread = nullptr;
+      boost::signals2::scoped_connection               _applied_block_connection;
+      fc::path                                         _cursor_directory;
+      std::atomic<uint32_t>                            _last_irreversible{0};
+      std::map< string, std::shared_ptr<consumer> >    _consumers;
+      mutable std::mutex                               _consumers_mutex;
+};
+
+} } // graphene::app
+
+FC_REFLECT( graphene::app::irreversible_consumer_metrics,
+            (name)(cursor)(last_irreversible)(lag)(blocks_handled)(handler_us)(blocks_per_second)(failed)(last_error) )
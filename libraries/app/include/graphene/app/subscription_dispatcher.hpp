@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/thread.hpp>
+#include <fc/variant.hpp>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace graphene { namespace app {
+
+using namespace graphene::chain;
+
+/** what a subscriber queue does with a new update once it holds max_queue_depth updates */
+enum subscription_overflow_policy
+{
+   /** merge the update into the newest queued one: arrays are concatenated, other values replace it */
+   subscription_overflow_coalesce,
+   /** discard the oldest queued update */
+   subscription_overflow_drop_oldest
+};
+
+struct subscription_queue_metrics
+{
+   uint32_t subscribers     = 0;
+   uint32_t max_queue_depth = 0;
+   /** updates waiting in all queues */
+   uint64_t queued          = 0;
+   /** depth of the fullest queue */
+   uint32_t deepest_queue   = 0;
+   uint64_t delivered       = 0;
+   /** updates whose callback threw */
+   uint64_t failed          = 0;
+   uint64_t coalesced       = 0;
+   uint64_t dropped         = 0;
+};
+
+/**
+ *  @brief Delivers subscription updates of all API connections of one database
+ *
+ *  Subscription callbacks are invoked from a dedicated thread, each subscriber through its own bounded queue, so
+ *  a slow websocket client neither delays block application nor buffers without bound.  Objects changed by a
+ *  notification are converted to variants once and the result is shared by every connection subscribed to them.
+ *
+ *  The dispatcher also keeps the exact set of objects each subscriber looked at, together with a reverse index from
+ *  object id to subscribers, and matches every object notification against it once for all connections.  Removed
+ *  objects stay subscribed until the subscriber goes away, an undo or a fork switch may bring them back.
+ */
+class subscription_dispatcher : public std::enable_shared_from_this<subscription_dispatcher>
+{
+   public:
+      /** a bounded update queue feeding one subscription callback */
+      class subscriber
+      {
+         public:
+            subscriber( std::function<void(const fc::variant&)> cb, subscription_overflow_policy policy )
+            :_callback( std::move(cb) ),_policy( policy ) {}
+
+            /** discards queued updates and stops further deliveries */
+            void cancel();
+
+         private:
+            friend class subscription_dispatcher;
+
+            std::function<void(const fc::variant&)> _callback;
+            subscription_overflow_policy            _policy;
+
+            std::mutex                              _mutex;
+            std::deque<fc::variant>                 _queue;
+            bool                                    _draining = false;
+            bool                                    _cancelled = false;
+            uint64_t                                _delivered = 0;
+            uint64_t                                _failed = 0;
+            uint64_t                                _coalesced = 0;
+            uint64_t                                _dropped = 0;
+
+            /** guarded by subscription_dispatcher::_items_mutex */
+            std::unordered_set<object_id_type>      _items;
+      };
+
+      explicit subscription_dispatcher( database& db );
+      ~subscription_dispatcher();
+
+      /** @return the dispatcher shared by all API connections of db, created on first use */
+      static std::shared_ptr<subscription_dispatcher> get( database& db );
+
+      void     set_max_queue_depth( uint32_t depth ) { _max_queue_depth = depth > 0 ? depth : 1; }
+      uint32_t get_max_queue_depth()const { return _max_queue_depth; }
+      void     set_object_overflow_policy( subscription_overflow_policy policy ) { _object_overflow_policy = policy; }
+      subscription_overflow_policy get_object_overflow_policy()const { return _object_overflow_policy; }
+
+      std::shared_ptr<subscriber> create_subscriber( std::function<void(const fc::variant&)> cb,
+                                                     subscription_overflow_policy policy );
+
+      /** cancels sub and forgets the objects it is subscribed to */
+      void remove_subscriber( const std::shared_ptr<subscriber>& sub );
+
+      /** @return true if id was not subscribed by sub before */
+      bool subscribe_to_item( const std::shared_ptr<subscriber>& sub, object_id_type id );
+      bool is_subscribed_to_item( const std::shared_ptr<subscriber>& sub, object_id_type id )const;
+
+      /**
+       *  @return the ids of the current object notification that sub is subscribed to, in notification order.
+       *  Must be called from the thread that applies blocks.
+       */
+      const vector<object_id_type>& matched_items( const std::shared_ptr<subscriber>& sub )const;
+
+      /** queues update for sub and schedules its delivery on the dispatcher thread */
+      void push( const std::shared_ptr<subscriber>& sub, fc::variant update );
+
+      /**
+       *  @return obj converted to a variant, computed at most once per object change notification and shared
+       *  by all connections.  Must be called from the thread that applies blocks.
+       */
+      const fc::variant& object_variant( const object& obj );
+
+      subscription_queue_metrics get_metrics()const;
+
+   private:
+      void drain( const std::shared_ptr<subscriber>& sub );
+      /** resets the per-notification state and matches ids against the subscriptions */
+      void on_objects_notified( const vector<object_id_type>& ids );
+
+      database&                                           _db;
+      fc::thread                                          _thread;
+      uint32_t                                            _max_queue_depth = 64;
+      subscription_overflow_policy                        _object_overflow_policy = subscription_overflow_coalesce;
+
+      std::unordered_map<object_id_type, fc::variant>     _variant_cache;
+
+      mutable std::mutex                                  _items_mutex;
+      std::unordered_map< object_id_type, flat_set<subscriber*> >      _item_subscribers;
+      std::unordered_map< const subscriber*, vector<object_id_type> > _matched_items;
+
+      mutable std::mutex                                  _subscribers_mutex;
+      std::vector< std::weak_ptr<subscriber> >            _subscribers;
+
+      boost::signals2::scoped_connection                  _new_connection;
+      boost::signals2::scoped_connection                  _change_connection;
+      boost::signals2::scoped_connection                  _removed_connection;
+};
+
+} } // graphene::app
+
+FC_REFLECT_ENUM( graphene::app::subscription_overflow_policy,
+                 (subscription_overflow_coalesce)
+                 (subscription_overflow_drop_oldest) )
+
+FC_REFLECT( graphene::app::subscription_queue_metrics,
+            (subscribers)(max_queue_depth)(queued)(deepest_queue)(delivered)(failed)(coalesced)(dropped) )
@@ -0,0 +1,305 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/irreversible_block_stream.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace app {
+
+const uint32_t irreversible_block_stream::default_batch_size;
+
+struct irreversible_block_stream::consumer
+{
+   ~consumer()
+   {
+      stopped = true;
+      // waits for the batch being handled, the batches queued after it find stopped set
+      thread->quit();
+   }
+
+   void handle( const vector<signed_block>& blocks, const std::weak_ptr<irreversible_block_stream>& stream,
+                fc::thread& chain_thread );
+   void save_cursor()const;
+   void set_error( const string& error );
+
+   string                        name;
+   handler_type                  handler;
+   fc::path                      cursor_file;
+   uint32_t                      batch_size = default_batch_size;
+   std::unique_ptr<fc::thread>   thread;
+   std::weak_ptr<consumer>       self;
+
+   /** last block queued for the handler, only used on the chain thread */
+   uint32_t                      fetched = 0;
+   std::atomic<uint32_t>         queued{0};
+   std::atomic<uint32_t>         cursor{0};
+   std::atomic<bool>             stopped{false};
+   std::atomic<bool>             failed{false};
+   std::atomic<uint64_t>         handled{0};
+   std::atomic<uint64_t>         handler_us{0};
+
+   mutable std::mutex            error_mutex;
+   string                        last_error;
+};
+
+void irreversible_block_stream::consumer::handle( const vector<signed_block>& blocks,
+                                                  const std::weak_ptr<irreversible_block_stream>& stream,
+                                                  fc::thread& chain_thread )
+{
+   for( const auto& block : blocks )
+   {
+      if( stopped || failed )
+         return;
+      fc::time_point start = fc::time_point::now();
+      try
+      {
+         handler( block );
+      }
+      catch( const fc::exception& e )
+      {
+         elog( "irreversible block consumer ${n} failed at block ${b}: ${e}",
+               ("n", name)("b", block.block_num())("e", e.to_detail_string()) );
+         set_error( e.to_string() );
+      }
+      catch( const std::exception& e )
+      {
+         elog( "irreversible block consumer ${n} failed at block ${b}: ${e}", ("n", name)("b", block.block_num())("e", e.what()) );
+         set_error( e.what() );
+      }
+      if( failed )
+         break;
+      handler_us += ( fc::time_point::now() - start ).count();
+      ++handled;
+      cursor = block.block_num();
+   }
+   save_cursor();
+   queued -= blocks.size();
+
+   if( failed || stopped )
+      return;
+   std::weak_ptr<consumer> self = this->self;
+   chain_thread.async( [stream,self]() {
+      auto s = stream.lock();
+      auto c = self.lock();
+      if( s && c )
+         s->refill( *c );
+   }, "irreversible_block_stream::refill" );
+}
+
+void irreversible_block_stream::consumer::save_cursor()const
+{
+   if( cursor_file == fc::path() )
+      return;
+   try
+   {
+      // replaced at once so that a crash leaves either the old or the new cursor
+      const fc::path tmp( cursor_file.generic_string() + ".tmp" );
+      fc::json::save_to_file( uint32_t( cursor ), tmp );
+      fc::rename( tmp, cursor_file );
+   }
+   catch( const fc::exception& e )
+   {
+      wlog( "failed to save the cursor of irreversible block consumer ${n}: ${e}", ("n", name)("e", e.to_detail_string()) );
+   }
+}
+
+void irreversible_block_stream::consumer::set_error( const string& error )
+{
+   std::lock_guard<std::mutex> lock( error_mutex );
+   last_error = error;
+   failed = true;
+}
+
+irreversible_block_stream::irreversible_block_stream( database& db )
+:_db(db)
+{
+   _applied_block_connection = _db.applied_block.connect( [this]( const signed_block& ) { on_applied_block(); } );
+}
+
+irreversible_block_stream::~irreversible_block_stream()
+{
+   std::map< string, std::shared_ptr<consumer> > consumers;
+   {
+      std::lock_guard<std::mutex> lock( _consumers_mutex );
+      consumers.swap( _consumers );
+   }
+   consumers.clear();
+}
+
+std::shared_ptr<irreversible_block_stream> irreversible_block_stream::get( database& db )
+{
+   static std::mutex registry_mutex;
+   static std::map< database*, std::weak_ptr<irreversible_block_stream> > registry;
+
+   std::lock_guard<std::mutex> lock( registry_mutex );
+   auto& entry = registry[&db];
+   auto result = entry.lock();
+   if( !result )
+   {
+      result = std::make_shared<irreversible_block_stream>( db );
+      entry = result;
+   }
+   return result;
+}
+
+void irreversible_block_stream::set_cursor_directory( const fc::path& dir )
+{
+   if( !fc::exists( dir ) )
+      fc::create_directories( dir );
+   _cursor_directory = dir;
+}
+
+void irreversible_block_stream::subscribe( const string& name, handler_type handler, uint32_t start_block,
+                                           uint32_t batch_size )
+{ try {
+   FC_ASSERT( handler, "A consumer needs a handler" );
+   FC_ASSERT( batch_size > 0 );
+
+   auto c = std::make_shared<consumer>();
+   c->name = name;
+   c->handler = std::move( handler );
+   c->batch_size = batch_size;
+   uint32_t start = start_block;
+   if( _cursor_directory != fc::path() )
+   {
+      c->cursor_file = _cursor_directory / ( name + ".cursor" );
+      if( fc::exists( c->cursor_file ) )
+         start = fc::json::from_file( c->cursor_file ).as<uint32_t>( 1 );
+   }
+   _chain_thread = &fc::thread::current();
+   c->fetched = start;
+   c->cursor = start;
+   c->thread.reset( new fc::thread( "irreversible_" + name ) );
+   c->self = c;
+
+   {
+      std::lock_guard<std::mutex> lock( _consumers_mutex );
+      FC_ASSERT( _consumers.find( name ) == _consumers.end(), "Consumer ${n} is already subscribed", ("n", name) );
+      _consumers[name] = c;
+   }
+   _last_irreversible = _db.get_dynamic_global_properties().last_irreversible_block_num;
+   ilog( "irreversible block consumer ${n} starts after block ${b}", ("n", name)("b", start) );
+   refill( *c );
+} FC_CAPTURE_AND_RETHROW( (name)(start_block)(batch_size) ) }
+
+void irreversible_block_stream::unsubscribe( const string& name )
+{
+   std::shared_ptr<consumer> c;
+   {
+      std::lock_guard<std::mutex> lock( _consumers_mutex );
+      auto itr = _consumers.find( name );
+      if( itr == _consumers.end() )
+         return;
+      c = itr->second;
+      _consumers.erase( itr );
+   }
+   // the destructor of the last reference waits for the batch being handled
+}
+
+void irreversible_block_stream::on_applied_block()
+{
+   _last_irreversible = _db.get_dynamic_global_properties().last_irreversible_block_num;
+   vector< std::shared_ptr<consumer> > consumers;
+   {
+      std::lock_guard<std::mutex> lock( _consumers_mutex );
+      if( _consumers.empty() )
+         return;
+      consumers.reserve( _consumers.size() );
+      for( const auto& entry : _consumers )
+         consumers.push_back( entry.second );
+   }
+   for( const auto& c : consumers )
+      refill( *c );
+}
+
+void irreversible_block_stream::refill( consumer& c )
+{
+   if( c.stopped || c.failed )
+      return;
+   // blocks older than the block database keeps never come back, waiting for them would stall the consumer
+   const uint32_t first_stored = _db.get_first_stored_block_num();
+   if( c.fetched + 1 < first_stored )
+   {
+      elog( "irreversible block consumer ${n} needs block ${b}, but the block database was pruned up to block ${f}",
+            ("n", c.name)("b", c.fetched + 1)("f", first_stored) );
+      c.set_error( "block " + fc::to_string( uint64_t( c.fetched + 1 ) ) + " was pruned from the block database, "
+                   "the consumer has to be rebuilt from block " + fc::to_string( uint64_t( first_stored ) ) );
+      return;
+   }
+   const uint32_t last_irreversible = _last_irreversible;
+   std::weak_ptr<irreversible_block_stream> self = shared_from_this();
+   while( c.queued < 2 * c.batch_size && c.fetched < last_irreversible )
+   {
+      const uint32_t last = std::min( last_irreversible, c.fetched + c.batch_size );
+      vector<signed_block> blocks;
+      blocks.reserve( last - c.fetched );
+      for( uint32_t num = c.fetched + 1; num <= last; ++num )
+      {
+         auto block = _db.fetch_block_by_number( num );
+         if( !block.valid() )
+         {
+            wlog( "irreversible block ${b} is missing from the block database", ("b", num) );
+            break;
+         }
+         blocks.emplace_back( std::move( *block ) );
+      }
+      if( blocks.empty() )
+         return;
+
+      c.fetched += blocks.size();
+      c.queued += blocks.size();
+      // the consumer outlives the tasks on its thread, see ~consumer
+      consumer* target = &c;
+      fc::thread* chain_thread = _chain_thread;
+      c.thread->async( [target,blocks,self,chain_thread]() {
+         target->handle( blocks, self, *chain_thread );
+      }, "irreversible_block_stream::handle" );
+   }
+}
+
+vector<irreversible_consumer_metrics> irreversible_block_stream::get_metrics()const
+{
+   const uint32_t last_irreversible = _last_irreversible;
+   vector<irreversible_consumer_metrics> result;
+   std::lock_guard<std::mutex> lock( _consumers_mutex );
+   result.reserve( _consumers.size() );
+   for( const auto& entry : _consumers )
+   {
+      const consumer& c = *entry.second;
+      irreversible_consumer_metrics m;
+      m.name              = c.name;
+      m.cursor            = c.cursor;
+      m.last_irreversible = last_irreversible;
+      m.lag               = last_irreversible > m.cursor ? last_irreversible - m.cursor : 0;
+      m.blocks_handled    = c.handled;
+      m.handler_us        = c.handler_us;
+      m.blocks_per_second = m.blocks_handled * 1000000 / std::max<uint64_t>( m.handler_us, 1 );
+      m.failed            = c.failed;
+      {
+         std::lock_guard<std::mutex> error_lock( c.error_mutex );
+         m.last_error = c.last_error;
+      }
+      result.push_back( std::move( m ) );
+   }
+   return result;
+}
+
+} } // graphene::app
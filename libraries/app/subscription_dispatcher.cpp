@@ -0,0 +1,261 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/subscription_dispatcher.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace graphene { namespace app {
+
+void subscription_dispatcher::subscriber::cancel()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _cancelled = true;
+   _queue.clear();
+}
+
+subscription_dispatcher::subscription_dispatcher( database& db )
+:_db(db),_thread("subscription_dispatcher")
+{
+   // connected at the front so that the notification is matched before any API connection handles it
+   _new_connection = _db.new_objects.connect( [this]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+                        on_objects_notified( ids );
+                     }, boost::signals2::at_front );
+   _change_connection = _db.changed_objects.connect( [this]( const vector<object_id_type>& ids, const flat_set<account_id_type>& ) {
+                        on_objects_notified( ids );
+                     }, boost::signals2::at_front );
+   _removed_connection = _db.removed_objects.connect( [this]( const vector<object_id_type>& ids, const vector<const object*>&,
+                                                              const flat_set<account_id_type>& ) {
+                        on_objects_notified( ids );
+                     }, boost::signals2::at_front );
+}
+
+subscription_dispatcher::~subscription_dispatcher()
+{
+   _thread.quit();
+}
+
+std::shared_ptr<subscription_dispatcher> subscription_dispatcher::get( database& db )
+{
+   static std::mutex registry_mutex;
+   static std::map< database*, std::weak_ptr<subscription_dispatcher> > registry;
+
+   std::lock_guard<std::mutex> lock( registry_mutex );
+   auto& entry = registry[&db];
+   auto result = entry.lock();
+   if( !result )
+   {
+      result = std::make_shared<subscription_dispatcher>( db );
+      entry = result;
+   }
+   return result;
+}
+
+std::shared_ptr<subscription_dispatcher::subscriber> subscription_dispatcher::create_subscriber(
+      std::function<void(const fc::variant&)> cb, subscription_overflow_policy policy )
+{
+   auto result = std::make_shared<subscriber>( std::move(cb), policy );
+
+   std::lock_guard<std::mutex> lock( _subscribers_mutex );
+   _subscribers.erase( std::remove_if( _subscribers.begin(), _subscribers.end(),
+                                       []( const std::weak_ptr<subscriber>& s ) { return s.expired(); } ),
+                       _subscribers.end() );
+   _subscribers.emplace_back( result );
+   return result;
+}
+
+void subscription_dispatcher::remove_subscriber( const std::shared_ptr<subscriber>& sub )
+{
+   sub->cancel();
+
+   std::lock_guard<std::mutex> lock( _items_mutex );
+   for( const auto& id : sub->_items )
+   {
+      auto itr = _item_subscribers.find( id );
+      if( itr == _item_subscribers.end() )
+         continue;
+      itr->second.erase( sub.get() );
+      if( itr->second.empty() )
+         _item_subscribers.erase( itr );
+   }
+   sub->_items.clear();
+   _matched_items.erase( sub.get() );
+}
+
+bool subscription_dispatcher::subscribe_to_item( const std::shared_ptr<subscriber>& sub, object_id_type id )
+{
+   std::lock_guard<std::mutex> lock( _items_mutex );
+   if( !sub->_items.insert( id ).second )
+      return false;
+   _item_subscribers[id].insert( sub.get() );
+   return true;
+}
+
+bool subscription_dispatcher::is_subscribed_to_item( const std::shared_ptr<subscriber>& sub, object_id_type id )const
+{
+   std::lock_guard<std::mutex> lock( _items_mutex );
+   return sub->_items.find( id ) != sub->_items.end();
+}
+
+const vector<object_id_type>& subscription_dispatcher::matched_items( const std::shared_ptr<subscriber>& sub )const
+{
+   static const vector<object_id_type> empty;
+   std::lock_guard<std::mutex> lock( _items_mutex );
+   auto itr = _matched_items.find( sub.get() );
+   return itr == _matched_items.end() ? empty : itr->second;
+}
+
+void subscription_dispatcher::on_objects_notified( const vector<object_id_type>& ids )
+{
+   _variant_cache.clear();
+
+   std::lock_guard<std::mutex> lock( _items_mutex );
+   _matched_items.clear();
+
+   for( const auto& id : ids )
+   {
+      auto itr = _item_subscribers.find( id );
+      if( itr == _item_subscribers.end() )
+         continue;
+      for( const auto* sub : itr->second )
+         _matched_items[sub].push_back( id );
+   }
+}
+
+void subscription_dispatcher::push( const std::shared_ptr<subscriber>& sub, fc::variant update )
+{
+   bool schedule = false;
+   {
+      std::lock_guard<std::mutex> lock( sub->_mutex );
+      if( sub->_cancelled )
+         return;
+
+      if( sub->_queue.size() < _max_queue_depth )
+         sub->_queue.emplace_back( std::move(update) );
+      else if( sub->_policy == subscription_overflow_coalesce )
+      {
+         auto& newest = sub->_queue.back();
+         if( newest.is_array() && update.is_array() )
+         {
+            auto& merged = newest.get_array();
+            const auto& added = update.get_array();
+            merged.insert( merged.end(), added.begin(), added.end() );
+         }
+         else
+            newest = std::move(update);
+         ++sub->_coalesced;
+      }
+      else
+      {
+         sub->_queue.pop_front();
+         sub->_queue.emplace_back( std::move(update) );
+         ++sub->_dropped;
+      }
+
+      if( !sub->_draining )
+      {
+         sub->_draining = true;
+         schedule = true;
+      }
+   }
+
+   if( schedule )
+   {
+      std::weak_ptr<subscription_dispatcher> weak_self = shared_from_this();
+      _thread.async( [weak_self,sub]() {
+         if( auto self = weak_self.lock() )
+            self->drain( sub );
+      }, "subscription_dispatcher::drain" );
+   }
+}
+
+void subscription_dispatcher::drain( const std::shared_ptr<subscriber>& sub )
+{
+   while( true )
+   {
+      fc::variant update;
+      {
+         std::lock_guard<std::mutex> lock( sub->_mutex );
+         if( sub->_cancelled || sub->_queue.empty() )
+         {
+            sub->_draining = false;
+            return;
+         }
+         update = std::move( sub->_queue.front() );
+         sub->_queue.pop_front();
+      }
+
+      bool delivered = false;
+      try
+      {
+         sub->_callback( update );
+         delivered = true;
+      }
+      catch( const fc::exception& e )
+      {
+         wlog( "Subscription callback failed: ${e}", ("e", e.to_detail_string()) );
+      }
+      catch( ... )
+      {
+         wlog( "Subscription callback failed with an unknown exception" );
+      }
+
+      std::lock_guard<std::mutex> lock( sub->_mutex );
+      if( delivered )
+         ++sub->_delivered;
+      else
+         ++sub->_failed;
+   }
+}
+
+const fc::variant& subscription_dispatcher::object_variant( const object& obj )
+{
+   auto itr = _variant_cache.find( obj.id );
+   if( itr == _variant_cache.end() )
+      itr = _variant_cache.emplace( obj.id, obj.to_variant() ).first;
+   return itr->second;
+}
+
+subscription_queue_metrics subscription_dispatcher::get_metrics()const
+{
+   subscription_queue_metrics result;
+   result.max_queue_depth = _max_queue_depth;
+
+   std::lock_guard<std::mutex> lock( _subscribers_mutex );
+   for( const auto& weak_sub : _subscribers )
+   {
+      auto sub = weak_sub.lock();
+      if( !sub )
+         continue;
+
+      std::lock_guard<std::mutex> sub_lock( sub->_mutex );
+      if( sub->_cancelled )
+         continue;
+      ++result.subscribers;
+      result.queued += sub->_queue.size();
+      result.deepest_queue = std::max<uint32_t>( result.deepest_queue, sub->_queue.size() );
+      result.delivered += sub->_delivered;
+      result.failed += sub->_failed;
+      result.coalesced += sub->_coalesced;
+      result.dropped += sub->_dropped;
+   }
+   return result;
+}
+
+} } // graphene::app
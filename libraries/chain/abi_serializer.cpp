@@ -1,4 +1,5 @@
 #include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
 #include <fc/io/raw.hpp>
 #include <fc/io/varint.hpp>
 #include <fc/uint128.hpp>
@@ -15,6 +16,7 @@ namespace chain
 {
 
 const size_t abi_serializer::max_recursion_depth;
+const uint32_t abi_serializer::no_plan;
 
 using boost::algorithm::ends_with;
 using std::string;
@@ -105,6 +107,7 @@ void abi_serializer::set_abi(const abi_def &abi, const fc::microseconds &max_ser
     actions.clear();
     tables.clear();
     error_messages.clear();
+    clear_type_plans();
 
     for (const auto &st : abi.structs)
         structs[st.name] = st;
@@ -135,6 +138,68 @@ void abi_serializer::set_abi(const abi_def &abi, const fc::microseconds &max_ser
     FC_ASSERT(error_messages.size() == abi.error_messages.size());
 
     validate(deadline, max_serialization_time);
+    compile_type_plans();
+}
+
+void abi_serializer::clear_type_plans()
+{
+    plans.clear();
+    plan_index.clear();
+}
+
+void abi_serializer::compile_type_plans()
+{
+    clear_type_plans();
+    for (const auto &t : typedefs)
+        compile_type_plan(t.first);
+    for (const auto &s : structs)
+        compile_type_plan(s.first);
+    for (const auto &a : actions)
+        compile_type_plan(a.second);
+    for (const auto &t : tables)
+        compile_type_plan(t.second);
+}
+
+uint32_t abi_serializer::compile_type_plan(const type_name &type)
+{
+    auto itr = plan_index.find(type);
+    if (itr != plan_index.end())
+        return itr->second;
+
+    // registered before the parts are compiled, so that a struct may refer to itself
+    const uint32_t index = plans.size();
+    plan_index[type] = index;
+    plans.emplace_back();
+
+    type_plan plan;
+    plan.name = type;
+    plan.resolved = resolve_type(type);
+    auto ftype = fundamental_type(plan.resolved);
+    auto btype = built_in_types.find(ftype);
+    if (btype != built_in_types.end()) {
+        plan.kind = type_plan::builtin_kind;
+        plan.codec = btype->second;
+        plan.codec_array = is_array(plan.resolved);
+        plan.codec_optional = is_optional(plan.resolved);
+    } else if (is_array(plan.resolved)) {
+        plan.kind = type_plan::array_kind;
+        plan.element = compile_type_plan(ftype);
+    } else if (is_optional(plan.resolved)) {
+        plan.kind = type_plan::optional_kind;
+        plan.element = compile_type_plan(ftype);
+    } else {
+        auto st = structs.find(resolve_type(plan.resolved));
+        if (st != structs.end()) {
+            plan.kind = type_plan::struct_kind;
+            if (st->second.base != type_name())
+                plan.base = compile_type_plan(resolve_type(st->second.base));
+            plan.fields.reserve(st->second.fields.size());
+            for (const auto &field : st->second.fields)
+                plan.fields.emplace_back(field.name, compile_type_plan(field.type));
+        }
+    }
+    plans[index] = std::move(plan);
+    return index;
 }
 
 bool abi_serializer::is_builtin_type(const type_name &type) const
@@ -297,6 +362,10 @@ void abi_serializer::_binary_to_variant(const type_name &type, fc::datastream<co
 fc::variant abi_serializer::_binary_to_variant(const type_name &type, fc::datastream<const char *> &stream,
                                                size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
 {
+    auto plan = plan_index.find(type);
+    if (plan != plan_index.end())
+        return _binary_to_variant(plans[plan->second], stream, recursion_depth, deadline, max_serialization_time);
+
     FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
     FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
 
@@ -332,6 +401,58 @@ fc::variant abi_serializer::_binary_to_variant(const type_name &type, fc::datast
     return fc::variant(std::move(mvo), GRAPHENE_MAX_NESTED_OBJECTS);
 }
 
+fc::variant abi_serializer::_binary_to_variant(const type_plan &plan, fc::datastream<const char *> &stream,
+                                               size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
+{
+    FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
+
+    switch (plan.kind) {
+    case type_plan::builtin_kind:
+        return plan.codec.first(stream, plan.codec_array, plan.codec_optional);
+    case type_plan::array_kind: {
+        fc::unsigned_int size;
+        fc::raw::unpack(stream, size);
+        vector<fc::variant> vars;
+        vars.reserve(std::min<uint32_t>(size.value, 1024));
+        const type_plan &element = plans[plan.element];
+        for (decltype(size.value) i = 0; i < size; ++i) {
+            FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
+            auto v = _binary_to_variant(element, stream, recursion_depth, deadline, max_serialization_time);
+            FC_ASSERT(!v.is_null(), "Invalid packed array");
+            vars.emplace_back(std::move(v));
+        }
+        return fc::variant(std::move(vars), GRAPHENE_MAX_NESTED_OBJECTS);
+    }
+    case type_plan::optional_kind: {
+        char flag;
+        fc::raw::unpack(stream, flag);
+        return flag ? _binary_to_variant(plans[plan.element], stream, recursion_depth, deadline, max_serialization_time) : fc::variant();
+    }
+    case type_plan::struct_kind: {
+        fc::mutable_variant_object mvo;
+        _binary_to_variant(plan, stream, mvo, recursion_depth, deadline, max_serialization_time);
+        FC_ASSERT(mvo.size() > 0, "Unable to unpack stream ${type}", ("type", plan.name));
+        return fc::variant(std::move(mvo), GRAPHENE_MAX_NESTED_OBJECTS);
+    }
+    default:
+        get_struct(plan.resolved);
+        FC_THROW("Unknown type ${type}", ("type", plan.name));
+    }
+}
+
+void abi_serializer::_binary_to_variant(const type_plan &plan, fc::datastream<const char *> &stream,
+                                        fc::mutable_variant_object &obj, size_t recursion_depth,
+                                        const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
+{
+    FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
+    FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
+
+    if (plan.base != no_plan)
+        _binary_to_variant(plans[plan.base], stream, obj, recursion_depth, deadline, max_serialization_time);
+    for (const auto &field : plan.fields)
+        obj(field.first, _binary_to_variant(plans[field.second], stream, recursion_depth, deadline, max_serialization_time));
+}
+
 fc::variant abi_serializer::_binary_to_variant(const type_name &type, const bytes &binary,
                                                size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
 {
@@ -344,6 +465,12 @@ fc::variant abi_serializer::_binary_to_variant(const type_name &type, const byte
 void abi_serializer::_variant_to_binary(const type_name &type, const fc::variant &var, fc::datastream<char *> &ds,
                                         size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
 {
+    auto plan = plan_index.find(type);
+    if (plan != plan_index.end()) {
+        _variant_to_binary(plans[plan->second], var, ds, recursion_depth, deadline, max_serialization_time);
+        return;
+    }
+
     try {
         FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
         FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
@@ -395,13 +522,68 @@ void abi_serializer::_variant_to_binary(const type_name &type, const fc::variant
     FC_CAPTURE_AND_RETHROW((type)(var))
 }
 
+void abi_serializer::_variant_to_binary(const type_plan &plan, const fc::variant &var, fc::datastream<char *> &ds,
+                                        size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
+{
+    const type_name &type = plan.name;
+    try {
+        FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
+
+        switch (plan.kind) {
+        case type_plan::builtin_kind:
+            plan.codec.second(var, ds, plan.codec_array, plan.codec_optional);
+            break;
+        case type_plan::array_kind: {
+            const auto &vars = var.get_array();
+            fc::raw::pack(ds, (fc::unsigned_int) vars.size());
+            const type_plan &element = plans[plan.element];
+            for (const auto &v : vars) {
+                FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
+                _variant_to_binary(element, v, ds, recursion_depth, deadline, max_serialization_time);
+            }
+            break;
+        }
+        case type_plan::struct_kind:
+            FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
+            if (var.is_object()) {
+                const auto &vo = var.get_object();
+                if (plan.base != no_plan)
+                    _variant_to_binary(plans[plan.base], var, ds, recursion_depth, deadline, max_serialization_time);
+                for (const auto &field : plan.fields) {
+                    auto itr = vo.find(field.first);
+                    if (itr != vo.end()) {
+                        _variant_to_binary(plans[field.second], itr->value(), ds, recursion_depth, deadline, max_serialization_time);
+                    } else {
+                        _variant_to_binary(plans[field.second], fc::variant(), ds, recursion_depth, deadline, max_serialization_time);
+                        FC_THROW("Missing '${f}' in variant object", ("f", field.first));
+                    }
+                }
+            } else if (var.is_array()) {
+                const auto &va = var.get_array();
+                FC_ASSERT(plan.base == no_plan, "support for base class as array not yet implemented");
+                if (va.size() > 0) {
+                    for (uint32_t i = 0; i < plan.fields.size(); ++i)
+                        _variant_to_binary(plans[plan.fields[i].second], va.size() > i ? va[i] : fc::variant(), ds,
+                                           recursion_depth, deadline, max_serialization_time);
+                }
+            }
+            break;
+        default:
+            // optional structs are not packed, like an unknown struct
+            get_struct(plan.resolved);
+            FC_THROW("Unknown type ${type}", ("type", plan.name));
+        }
+    }
+    FC_CAPTURE_AND_RETHROW((type)(var))
+}
+
 bytes abi_serializer::_variant_to_binary(const type_name &type, const fc::variant &var,
                                          size_t recursion_depth, const fc::time_point &deadline, const fc::microseconds &max_serialization_time) const
 {
     try {
         FC_ASSERT(++recursion_depth < max_recursion_depth, "recursive definition, max_recursion_depth ${r} ", ("r", max_recursion_depth));
         FC_ASSERT(fc::time_point::now() < deadline, "serialization time limit ${t}us exceeded", ("t", max_serialization_time));
-        if (!_is_type(type, recursion_depth, deadline, max_serialization_time)) {
+        if (plan_index.find(type) == plan_index.end() && !_is_type(type, recursion_depth, deadline, max_serialization_time)) {
             return var.as<bytes>(20);
         }
 
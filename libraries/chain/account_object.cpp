@@ -261,6 +261,58 @@ void account_member_index::object_modified(const object& after)
 
 }
 
+void asset_holder_count_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.balance != 0 )
+      add_holder( b.asset_type );
+}
+
+void asset_holder_count_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const account_balance_object*>(&obj) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(obj);
+   if( b.balance != 0 )
+      remove_holder( b.asset_type );
+}
+
+void asset_holder_count_index::about_to_modify( const object& before )
+{
+   assert( dynamic_cast<const account_balance_object*>(&before) ); // for debug only
+   before_holding = static_cast<const account_balance_object&>(before).balance != 0;
+}
+
+void asset_holder_count_index::object_modified( const object& after )
+{
+   assert( dynamic_cast<const account_balance_object*>(&after) ); // for debug only
+   const account_balance_object& b = static_cast<const account_balance_object&>(after);
+   bool after_holding = b.balance != 0;
+   if( after_holding && !before_holding )
+      add_holder( b.asset_type );
+   else if( !after_holding && before_holding )
+      remove_holder( b.asset_type );
+}
+
+uint64_t asset_holder_count_index::get_holder_count( asset_id_type asset_id )const
+{
+   auto itr = holder_counts.find( asset_id );
+   return itr == holder_counts.end() ? 0 : itr->second;
+}
+
+void asset_holder_count_index::add_holder( asset_id_type asset_id )
+{
+   ++holder_counts[asset_id];
+}
+
+void asset_holder_count_index::remove_holder( asset_id_type asset_id )
+{
+   auto itr = holder_counts.find( asset_id );
+   if( itr == holder_counts.end() ) return;
+   if( --itr->second == 0 )
+      holder_counts.erase( itr );
+}
+
 void account_referrer_index::object_inserted( const object& obj )
 {
 }
@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <graphene/chain/account_rank_index.hpp>
+
+namespace graphene { namespace chain {
+
+void account_bucket_counter::increment( time_point_sec t, account_id_type account )
+{
+   ++_buckets[bucket_of(t)][account];
+}
+
+void account_bucket_counter::decrement( time_point_sec t, account_id_type account )
+{
+   auto bucket_itr = _buckets.find( bucket_of(t) );
+   if( bucket_itr == _buckets.end() ) return;
+
+   auto& counters = bucket_itr->second;
+   auto itr = counters.find( account );
+   if( itr == counters.end() ) return;
+
+   if( --itr->second == 0 )
+   {
+      counters.erase( itr );
+      if( counters.empty() )
+         _buckets.erase( bucket_itr );
+   }
+}
+
+void account_bucket_counter::accumulate( uint32_t first_bucket, uint32_t last_bucket, map<account_id_type, uint64_t>& totals )const
+{
+   auto itr = _buckets.lower_bound( first_bucket );
+   auto end = _buckets.lower_bound( last_bucket );
+   for( ; itr != end; ++itr )
+      for( const auto& item : itr->second )
+         totals[item.first] += item.second;
+}
+
+uint64_t account_bucket_counter::count( uint32_t first_bucket, uint32_t last_bucket, account_id_type account )const
+{
+   uint64_t result = 0;
+   auto itr = _buckets.lower_bound( first_bucket );
+   auto end = _buckets.lower_bound( last_bucket );
+   for( ; itr != end; ++itr )
+   {
+      auto counter = itr->second.find( account );
+      if( counter != itr->second.end() )
+         result += counter->second;
+   }
+   return result;
+}
+
+void data_transaction_complain_rank_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const data_transaction_complain_object*>(&obj) ); // for debug only
+   const data_transaction_complain_object& c = static_cast<const data_transaction_complain_object&>(obj);
+   requesters.increment( c.create_date_time, c.requester );
+   datasources.increment( c.create_date_time, c.datasource );
+}
+
+void data_transaction_complain_rank_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const data_transaction_complain_object*>(&obj) ); // for debug only
+   const data_transaction_complain_object& c = static_cast<const data_transaction_complain_object&>(obj);
+   requesters.decrement( c.create_date_time, c.requester );
+   datasources.decrement( c.create_date_time, c.datasource );
+}
+
+void second_hand_data_rank_index::object_inserted( const object& obj )
+{
+   assert( dynamic_cast<const second_hand_data_object*>(&obj) ); // for debug only
+   const second_hand_data_object& s = static_cast<const second_hand_data_object&>(obj);
+   datasources.increment( s.create_date_time, s.second_hand_datasource_id );
+}
+
+void second_hand_data_rank_index::object_removed( const object& obj )
+{
+   assert( dynamic_cast<const second_hand_data_object*>(&obj) ); // for debug only
+   const second_hand_data_object& s = static_cast<const second_hand_data_object&>(obj);
+   datasources.decrement( s.create_date_time, s.second_hand_datasource_id );
+}
+
+} } // graphene::chain
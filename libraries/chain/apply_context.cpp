@@ -43,8 +43,10 @@ void apply_context::exec_one()
                + prefix + "CONSOLE OUTPUT END =====================" );
    }
    reset_console();
-   auto end = fc::time_point::now();
-   dlog("elapsed ${n}", ("n", end - start));
+   auto& profiler = _db->get_execution_profiler();
+   if( profiler.enabled() )
+      profiler.record_contract( account_id_type( receiver & GRAPHENE_DB_MAX_INSTANCE_ID ), std::string( act.method_name ),
+                                fc::time_point::now() - start );
 }
 
 void apply_context::exec()
@@ -26,6 +26,8 @@
 #include <fc/io/raw.hpp>
 #include <fc/smart_ref_impl.hpp>
 
+#include <algorithm>
+
 namespace graphene { namespace chain {
 
 struct index_entry
@@ -39,9 +41,40 @@ FC_REFLECT( graphene::chain::index_entry, (block_pos)(block_size)(block_id) );
 
 namespace graphene { namespace chain {
 
+namespace {
+
+/** the files replaced together by block_database::rewrite_files */
+const char* const rewritten_files[] = { "blocks", "index", "index_base" };
+
+/**
+ *  A rewrite writes the new files next to the old ones and then creates the rewrite_committed marker.  Once the
+ *  marker exists the new files replace the old ones, also when a crash interrupted the renames, otherwise the new
+ *  files are incomplete and dropped.
+ */
+void finish_rewrite( const fc::path& dbdir )
+{
+   const bool committed = fc::exists( dbdir / "rewrite_committed" );
+   for( const char* name : rewritten_files )
+   {
+      const fc::path tmp = dbdir / ( string( name ) + ".tmp" );
+      if( !fc::exists( tmp ) )
+         continue;
+      if( committed )
+         fc::rename( tmp, dbdir / name );
+      else
+         fc::remove( tmp );
+   }
+   if( committed )
+      fc::remove( dbdir / "rewrite_committed" );
+}
+
+}
+
 void block_database::open( const fc::path& dbdir )
 { try {
    fc::create_directories(dbdir);
+   _dbdir = dbdir;
+   finish_rewrite( dbdir );
    _block_num_to_pos.exceptions(std::ios_base::failbit | std::ios_base::badbit);
    _blocks.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
@@ -56,8 +89,30 @@ void block_database::open( const fc::path& dbdir )
      _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
      _blocks.open( (dbdir/"blocks").generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
    }
+   _index_base = 0;
+   if( fc::exists( dbdir / "index_base" ) )
+   {
+      std::ifstream in( (dbdir / "index_base").generic_string().c_str(), std::ios::in | std::ios::binary );
+      in.read( (char*)&_index_base, sizeof(_index_base) );
+   }
+   if( fc::exists( dbdir / "chunk_header" ) )
+      _archive.open( dbdir );
 } FC_CAPTURE_AND_RETHROW( (dbdir) ) }
 
+uint32_t block_database::first_block_num()const
+{
+   if( !_archive.empty() )
+      return _archive.first_block_num();
+   return std::max<uint32_t>( _index_base, 1 );
+}
+
+int64_t block_database::index_pos( uint32_t block_num )const
+{
+   if( block_num < _index_base )
+      return -1;
+   return sizeof(index_entry) * int64_t(block_num - _index_base);
+}
+
 bool block_database::is_open()const
 {
   return _blocks.is_open();
@@ -67,12 +122,15 @@ void block_database::close()
 {
   _blocks.close();
   _block_num_to_pos.close();
+  _archive.close();
 }
 
 void block_database::flush()
 {
   _blocks.flush();
   _block_num_to_pos.flush();
+  if( _archive.is_open() )
+     _archive.flush();
 }
 
 void block_database::store( const block_id_type& _id, const signed_block& b )
@@ -83,7 +141,9 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
       id = b.id();
       elog( "id argument of block_database::store() was not initialized for block ${id}", ("id", id) );
    }
-   _block_num_to_pos.seekp( sizeof( index_entry ) * int64_t(block_header::num_from_id(id)) );
+   const uint32_t block_num = block_header::num_from_id(id);
+   FC_ASSERT( index_pos( block_num ) >= 0, "Block ${id} is older than the blocks kept in the block database", ("id", id) );
+   _block_num_to_pos.seekp( index_pos( block_num ) );
    index_entry e;
    _blocks.seekp( 0, _blocks.end );
    // dlog("store block, num: ${num}, block:  ${b}", ("num", num)("b", b));
@@ -94,14 +154,18 @@ void block_database::store( const block_id_type& _id, const signed_block& b )
    _blocks.write( vec.data(), vec.size() );
    // dlog("store index: ${e}", ("e", e));
    _block_num_to_pos.write( (char*)&e, sizeof(e) );
+
+   // roll to new files once twice the window is stored, so the copy is amortized over the window
+   if( _prune_window > 0 && _archive.empty() && block_num >= _index_base + 2 * uint64_t(_prune_window) )
+      rewrite_files( block_num - _prune_window + 1 );
 }
 
 void block_database::remove( const block_id_type& id )
 { try {
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
+   int64_t index_pos = this->index_pos( block_header::num_from_id(id) );
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if ( index_pos < 0 || _block_num_to_pos.tellg() <= index_pos )
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block ${id} not contained in block database", ("id", id));
 
    _block_num_to_pos.seekg( index_pos );
@@ -110,7 +174,7 @@ void block_database::remove( const block_id_type& id )
    if( e.block_id == id )
    {
       e.block_size = 0;
-      _block_num_to_pos.seekp( sizeof(e) * int64_t(block_header::num_from_id(id)) );
+      _block_num_to_pos.seekp( index_pos );
       _block_num_to_pos.write( (char*)&e, sizeof(e) );
    }
 } FC_CAPTURE_AND_RETHROW( (id) ) }
@@ -121,28 +185,39 @@ bool block_database::contains( const block_id_type& id )const
       return false;
 
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
+   int64_t index_pos = this->index_pos( block_header::num_from_id(id) );
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
-      return false;
+   if ( index_pos < 0 || _block_num_to_pos.tellg() < int64_t(index_pos + sizeof(e)) )
+      return _archive.contains( id );
    _block_num_to_pos.seekg( index_pos );
    _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
-   return e.block_id == id && e.block_size > 0;
+   return ( e.block_id == id && e.block_size > 0 ) || _archive.contains( id );
 }
 
 block_id_type block_database::fetch_block_id( uint32_t block_num )const
 {
    assert( block_num != 0 );
    index_entry e;
-   int64_t index_pos = sizeof(e) * int64_t(block_num);
+   int64_t index_pos = this->index_pos( block_num );
    _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-   if ( _block_num_to_pos.tellg() <= index_pos )
+   if ( index_pos < 0 || _block_num_to_pos.tellg() <= index_pos )
+   {
+      optional<block_id_type> archived_id = _archive.fetch_block_id( block_num );
+      if( archived_id.valid() )
+         return *archived_id;
       FC_THROW_EXCEPTION(fc::key_not_found_exception, "Block number ${block_num} not contained in block database", ("block_num", block_num));
+   }
 
    _block_num_to_pos.seekg( index_pos );
    _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
+   if( e.block_id == block_id_type() )
+   {
+      optional<block_id_type> archived_id = _archive.fetch_block_id( block_num );
+      if( archived_id.valid() )
+         return *archived_id;
+   }
    FC_ASSERT( e.block_id != block_id_type(), "Empty block_id in block_database (maybe corrupt on disk?)" );
    return e.block_id;
 }
@@ -152,15 +227,15 @@ optional<signed_block> block_database::fetch_optional( const block_id_type& id )
    try
    {
       index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_header::num_from_id(id));
+      int64_t index_pos = this->index_pos( block_header::num_from_id(id) );
       _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
+      if ( index_pos < 0 || _block_num_to_pos.tellg() <= index_pos )
+         return _archive.fetch_optional( id );
 
       _block_num_to_pos.seekg( index_pos );
       _block_num_to_pos.read( (char*)&e, sizeof(e) );
 
-      if( e.block_id != id ) return optional<signed_block>();
+      if( e.block_id != id ) return _archive.fetch_optional( id );
 
       vector<char> data( e.block_size );
       _blocks.seekg( e.block_pos );
@@ -184,13 +259,15 @@ optional<signed_block> block_database::fetch_by_number( uint32_t block_num )cons
    try
    {
       index_entry e;
-      int64_t index_pos = sizeof(e) * int64_t(block_num);
+      int64_t index_pos = this->index_pos( block_num );
       _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
-      if ( _block_num_to_pos.tellg() <= index_pos )
-         return {};
+      if ( index_pos < 0 || _block_num_to_pos.tellg() <= index_pos )
+         return _archive.fetch_by_number( block_num );
 
       _block_num_to_pos.seekg( index_pos, _block_num_to_pos.beg );
       _block_num_to_pos.read( (char*)&e, sizeof(e) );
+      if( e.block_size == 0 && _archive.contains_block_num( block_num ) )
+         return _archive.fetch_by_number( block_num );
 
       vector<char> data( e.block_size );
       _blocks.seekg( e.block_pos );
@@ -274,6 +351,7 @@ optional<signed_block> block_database::last()const
 {
    optional<index_entry> entry = last_index_entry();
    if( entry.valid() ) return fetch_by_number( block_header::num_from_id(entry->block_id) );
+   if( !_archive.empty() ) return _archive.fetch_by_number( _archive.last_block_num() );
    return optional<signed_block>();
 }
 
@@ -281,7 +359,112 @@ optional<block_id_type> block_database::last_id()const
 {
    optional<index_entry> entry = last_index_entry();
    if( entry.valid() ) return entry->block_id;
+   if( !_archive.empty() ) return _archive.fetch_block_id( _archive.last_block_num() );
    return optional<block_id_type>();
 }
 
+uint32_t block_database::archive_blocks( uint32_t last_block_num, uint32_t blocks_per_chunk )
+{ try {
+   FC_ASSERT( is_open() );
+   flush();
+   if( !_archive.is_open() )
+      _archive.open( _dbdir );
+
+   // archiving rebases the index after the archived blocks, only blocks missing from both were pruned
+   FC_ASSERT( _index_base <= ( _archive.empty() ? 1 : _archive.last_block_num() + 1 ),
+              "The blocks before ${n} were pruned from the block database", ("n", _index_base) );
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   const uint32_t index_end = _index_base + _block_num_to_pos.tellg() / int64_t(sizeof(index_entry));
+   last_block_num = std::min( last_block_num, index_end ? index_end - 1 : 0 );
+
+   if( _archive.first_block_num() == 0 )
+   {
+      if( last_block_num < blocks_per_chunk )
+         return 0;
+      // the dictionary is built from blocks spread over the range, the latest ones matter most
+      const uint32_t sample_count = 256;
+      vector<signed_block> samples;
+      for( uint32_t i = 0; i < sample_count; ++i )
+      {
+         optional<signed_block> block = fetch_by_number( 1 + uint64_t(last_block_num - 1) * i / sample_count );
+         if( block.valid() )
+            samples.push_back( std::move( *block ) );
+      }
+      _archive.create( 1, blocks_per_chunk, samples );
+   }
+
+   const uint32_t archived_before = _archive.last_block_num();
+   vector<signed_block> chunk;
+   while( _archive.last_block_num() + _archive.blocks_per_chunk() <= last_block_num )
+   {
+      chunk.clear();
+      for( uint32_t block_num = _archive.last_block_num() + 1; chunk.size() < _archive.blocks_per_chunk(); ++block_num )
+      {
+         optional<signed_block> block = fetch_by_number( block_num );
+         FC_ASSERT( block.valid(), "Block ${block_num} is missing from the block database", ("block_num", block_num) );
+         chunk.push_back( std::move( *block ) );
+      }
+      _archive.append_chunk( chunk );
+   }
+   if( _archive.last_block_num() == archived_before )
+      return _archive.last_block_num();
+
+   rewrite_files( _archive.last_block_num() + 1 );
+
+   ilog( "Archived blocks ${from} to ${to} in the compressed block log",
+         ("from", archived_before + 1)("to", _archive.last_block_num()) );
+   return _archive.last_block_num();
+} FC_CAPTURE_AND_RETHROW( (last_block_num)(blocks_per_chunk) ) }
+
+void block_database::rewrite_files( uint32_t first_block_num )
+{ try {
+   flush();
+   _block_num_to_pos.seekg( 0, _block_num_to_pos.end );
+   const uint32_t index_end = _index_base + _block_num_to_pos.tellg() / int64_t(sizeof(index_entry));
+
+   // copy the blocks from first_block_num on into new files, the new index starts at first_block_num
+   const fc::path blocks_filename = _dbdir / "blocks";
+   {
+      std::ofstream new_blocks( (_dbdir / "blocks.tmp").generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      std::ofstream new_index( (_dbdir / "index.tmp").generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      new_blocks.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+      new_index.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+      vector<char> data;
+      for( uint32_t block_num = std::max( first_block_num, _index_base ); block_num < index_end; ++block_num )
+      {
+         index_entry e;
+         _block_num_to_pos.seekg( index_pos( block_num ) );
+         _block_num_to_pos.read( (char*)&e, sizeof(e) );
+         if( e.block_id == block_id_type() )
+            continue;
+         data.resize( e.block_size );
+         if( e.block_size )
+         {
+            _blocks.seekg( e.block_pos );
+            _blocks.read( data.data(), e.block_size );
+         }
+         e.block_pos = new_blocks.tellp();
+         new_blocks.write( data.data(), data.size() );
+         new_index.seekp( sizeof(e) * int64_t(block_num - first_block_num) );
+         new_index.write( (char*)&e, sizeof(e) );
+      }
+      std::ofstream new_index_base( (_dbdir / "index_base.tmp").generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      new_index_base.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+      new_index_base.write( (const char*)&first_block_num, sizeof(first_block_num) );
+   }
+   // the files must not be replaced one by one, an index with the old base would point at the wrong entries
+   {
+      std::ofstream marker( (_dbdir / "rewrite_committed").generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      FC_ASSERT( marker.good(), "Unable to commit the rewrite of the block database" );
+   }
+   _blocks.close();
+   _block_num_to_pos.close();
+   finish_rewrite( _dbdir );
+   _index_base = first_block_num;
+   _block_num_to_pos.open( _index_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+   _blocks.open( blocks_filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+
+   ilog( "Rewrote the block database starting at block ${first}", ("first", first_block_num) );
+} FC_CAPTURE_AND_RETHROW( (first_block_num) ) }
+
 } }
@@ -0,0 +1,332 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/compressed_block_log.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+
+#include <fc/io/raw.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+struct compressed_block_log_header
+{
+   uint32_t     version = 1;
+   uint32_t     first_block_num = 0;
+   uint32_t     blocks_per_chunk = 0;
+   vector<char> dictionary;
+};
+
+void open_or_create( std::fstream& file, const fc::path& filename )
+{
+   file.exceptions( std::ios_base::failbit | std::ios_base::badbit );
+   if( fc::exists( filename ) )
+      file.open( filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out );
+   else
+      file.open( filename.generic_string().c_str(), std::fstream::binary | std::fstream::in | std::fstream::out | std::fstream::trunc );
+}
+
+vector<char> deflate_chunk( const vector<char>& data, const vector<char>& dictionary )
+{
+   z_stream stream = z_stream();
+   FC_ASSERT( deflateInit( &stream, Z_BEST_COMPRESSION ) == Z_OK, "unable to initialize zlib" );
+   vector<char> result( deflateBound( &stream, data.size() ) );
+   if( !dictionary.empty() && deflateSetDictionary( &stream, (const Bytef*)dictionary.data(), dictionary.size() ) != Z_OK )
+   {
+      deflateEnd( &stream );
+      FC_THROW( "unable to set the block chunk dictionary" );
+   }
+   stream.next_in = (Bytef*)data.data();
+   stream.avail_in = data.size();
+   stream.next_out = (Bytef*)result.data();
+   stream.avail_out = result.size();
+   int status = deflate( &stream, Z_FINISH );
+   result.resize( stream.total_out );
+   deflateEnd( &stream );
+   FC_ASSERT( status == Z_STREAM_END, "unable to compress block chunk" );
+   return result;
+}
+
+void inflate_chunk( const vector<char>& compressed, const vector<char>& dictionary, vector<char>& result )
+{
+   z_stream stream = z_stream();
+   FC_ASSERT( inflateInit( &stream ) == Z_OK, "unable to initialize zlib" );
+   stream.next_in = (Bytef*)compressed.data();
+   stream.avail_in = compressed.size();
+   stream.next_out = (Bytef*)result.data();
+   stream.avail_out = result.size();
+   int status = inflate( &stream, Z_FINISH );
+   if( status == Z_NEED_DICT )
+   {
+      // Z_DATA_ERROR when the chunk was compressed with another dictionary than the one in chunk_header
+      status = inflateSetDictionary( &stream, (const Bytef*)dictionary.data(), dictionary.size() );
+      if( status == Z_OK )
+         status = inflate( &stream, Z_FINISH );
+   }
+   const uint64_t decoded_size = stream.total_out;
+   inflateEnd( &stream );
+   FC_ASSERT( status == Z_STREAM_END && decoded_size == result.size(), "corrupt block chunk", ("status", status) );
+}
+
+} // anonymous namespace
+
+} } // graphene::chain
+
+FC_REFLECT( graphene::chain::compressed_block_log_header, (version)(first_block_num)(blocks_per_chunk)(dictionary) )
+
+namespace graphene { namespace chain {
+
+const uint32_t compressed_block_log::default_blocks_per_chunk;
+const uint32_t compressed_block_log::default_cache_size;
+const uint32_t compressed_block_log::max_dictionary_size;
+
+void compressed_block_log::open( const fc::path& dbdir, uint32_t cache_size )
+{ try {
+   fc::create_directories( dbdir );
+   _dbdir = dbdir;
+   _cache_size = std::max<uint32_t>( cache_size, 1 );
+   _first_block_num = 0;
+   _dictionary.clear();
+   _chunk_index.clear();
+
+   if( fc::exists( dbdir / "chunk_header" ) )
+   {
+      std::ifstream in( (dbdir / "chunk_header").generic_string().c_str(), std::ios::in | std::ios::binary );
+      vector<char> packed( (std::istreambuf_iterator<char>( in )), std::istreambuf_iterator<char>() );
+      const auto header = fc::raw::unpack<compressed_block_log_header>( packed );
+      FC_ASSERT( header.version == 1 && header.blocks_per_chunk > 0, "unsupported block chunk header" );
+      _first_block_num = header.first_block_num;
+      _blocks_per_chunk = header.blocks_per_chunk;
+      _dictionary = header.dictionary;
+   }
+
+   open_or_create( _chunks, dbdir / "chunks" );
+   open_or_create( _block_ids, dbdir / "block_ids" );
+   open_or_create( _chunk_index_file, dbdir / "chunk_index" );
+
+   _chunks.seekg( 0, _chunks.end );
+   const uint64_t chunks_size = _chunks.tellg();
+   _block_ids.seekg( 0, _block_ids.end );
+   const uint64_t block_ids_size = _block_ids.tellg();
+   _chunk_index_file.seekg( 0, _chunk_index_file.end );
+   const uint64_t index_size = _chunk_index_file.tellg();
+
+   // the index entry is written last, so a chunk without one was never completely appended
+   _chunk_index.resize( _first_block_num ? index_size / sizeof(chunk_index_entry) : 0 );
+   if( !_chunk_index.empty() )
+   {
+      _chunk_index_file.seekg( 0 );
+      _chunk_index_file.read( (char*)_chunk_index.data(), _chunk_index.size() * sizeof(chunk_index_entry) );
+   }
+   while( !_chunk_index.empty() &&
+          ( _chunk_index.back().chunk_pos + _chunk_index.back().chunk_size > chunks_size ||
+            uint64_t(_chunk_index.size()) * _blocks_per_chunk * sizeof(block_id_type) > block_ids_size ) )
+      _chunk_index.pop_back();
+} FC_CAPTURE_AND_RETHROW( (dbdir) ) }
+
+void compressed_block_log::flush()
+{
+   _chunks.flush();
+   _block_ids.flush();
+   _chunk_index_file.flush();
+}
+
+void compressed_block_log::close()
+{
+   _chunks.close();
+   _block_ids.close();
+   _chunk_index_file.close();
+   _cache.clear();
+   _cached_chunks.clear();
+}
+
+void compressed_block_log::create( uint32_t first_block_num, uint32_t blocks_per_chunk, const vector<signed_block>& samples )
+{ try {
+   FC_ASSERT( is_open() && empty(), "blocks were already written to the compressed block log" );
+   FC_ASSERT( first_block_num > 0 && blocks_per_chunk > 0 );
+
+   // zlib finds matches in the last 32k of the dictionary, with the most useful strings at its end
+   vector<char> dictionary;
+   for( const auto& block : samples )
+   {
+      const auto packed = fc::raw::pack( block );
+      dictionary.insert( dictionary.end(), packed.begin(), packed.end() );
+   }
+   if( dictionary.size() > max_dictionary_size )
+      dictionary.erase( dictionary.begin(), dictionary.end() - max_dictionary_size );
+
+   compressed_block_log_header header;
+   header.first_block_num = first_block_num;
+   header.blocks_per_chunk = blocks_per_chunk;
+   header.dictionary = dictionary;
+   const auto packed_header = fc::raw::pack( header );
+   const fc::path tmp = _dbdir / "chunk_header.tmp";
+   {
+      std::ofstream out( tmp.generic_string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+      out.write( packed_header.data(), packed_header.size() );
+   }
+   fc::rename( tmp, _dbdir / "chunk_header" );
+
+   _first_block_num = first_block_num;
+   _blocks_per_chunk = blocks_per_chunk;
+   _dictionary = std::move( dictionary );
+} FC_CAPTURE_AND_RETHROW( (first_block_num)(blocks_per_chunk) ) }
+
+void compressed_block_log::append_chunk( const vector<signed_block>& blocks )
+{ try {
+   FC_ASSERT( _first_block_num > 0, "the compressed block log was not created" );
+   FC_ASSERT( blocks.size() == _blocks_per_chunk, "a chunk holds ${n} blocks", ("n", _blocks_per_chunk) );
+
+   vector<char> data;
+   vector<block_id_type> ids;
+   ids.reserve( blocks.size() );
+   for( uint32_t i = 0; i < blocks.size(); ++i )
+   {
+      FC_ASSERT( blocks[i].block_num() == last_block_num() + 1 + i, "blocks must be appended in order",
+                 ("expected", last_block_num() + 1 + i)("block_num", blocks[i].block_num()) );
+      const auto packed = fc::raw::pack( blocks[i] );
+      const uint32_t size = packed.size();
+      data.insert( data.end(), (const char*)&size, (const char*)&size + sizeof(size) );
+      data.insert( data.end(), packed.begin(), packed.end() );
+      ids.push_back( blocks[i].id() );
+   }
+   const auto compressed = deflate_chunk( data, _dictionary );
+
+   chunk_index_entry e;
+   if( !_chunk_index.empty() )
+      e.chunk_pos = _chunk_index.back().chunk_pos + _chunk_index.back().chunk_size;
+   e.chunk_size = compressed.size();
+   e.decoded_size = data.size();
+
+   _chunks.seekp( e.chunk_pos );
+   _chunks.write( compressed.data(), compressed.size() );
+   _block_ids.seekp( uint64_t(_chunk_index.size()) * _blocks_per_chunk * sizeof(block_id_type) );
+   _block_ids.write( (const char*)ids.data(), ids.size() * sizeof(block_id_type) );
+   _chunks.flush();
+   _block_ids.flush();
+   _chunk_index_file.seekp( _chunk_index.size() * sizeof(chunk_index_entry) );
+   _chunk_index_file.write( (const char*)&e, sizeof(e) );
+   _chunk_index_file.flush();
+   _chunk_index.push_back( e );
+} FC_CAPTURE_AND_RETHROW( (_first_block_num)(_chunk_index.size()) ) }
+
+bool compressed_block_log::contains( const block_id_type& id )const
+{
+   if( id == block_id_type() )
+      return false;
+   const auto stored = fetch_block_id( block_header::num_from_id( id ) );
+   return stored.valid() && *stored == id;
+}
+
+optional<block_id_type> compressed_block_log::fetch_block_id( uint32_t block_num )const
+{
+   if( !contains_block_num( block_num ) )
+      return optional<block_id_type>();
+   block_id_type id;
+   _block_ids.seekg( uint64_t(block_num - _first_block_num) * sizeof(block_id_type) );
+   _block_ids.read( (char*)&id, sizeof(id) );
+   return id;
+}
+
+optional<signed_block> compressed_block_log::fetch_optional( const block_id_type& id )const
+{
+   if( !contains( id ) )
+      return optional<signed_block>();
+   return fetch_by_number( block_header::num_from_id( id ) );
+}
+
+optional<signed_block> compressed_block_log::fetch_by_number( uint32_t block_num )const
+{
+   if( !contains_block_num( block_num ) )
+      return optional<signed_block>();
+   try
+   {
+      const uint32_t offset = block_num - _first_block_num;
+      const auto chunk = get_chunk( offset / _blocks_per_chunk );
+      const uint32_t block_pos = chunk->block_offsets[offset % _blocks_per_chunk];
+      uint32_t size;
+      memcpy( &size, chunk->data.data() + block_pos, sizeof(size) );
+      FC_ASSERT( block_pos + sizeof(size) + size <= chunk->data.size() );
+      fc::datastream<const char*> ds( chunk->data.data() + block_pos + sizeof(size), size );
+      signed_block result;
+      fc::raw::unpack( ds, result );
+      return result;
+   }
+   catch( const fc::exception& e )
+   {
+      elog( "unable to read block ${n} from the compressed block log: ${e}", ("n", block_num)("e", e.to_detail_string()) );
+   }
+   catch( const std::exception& e )
+   {
+      elog( "unable to read block ${n} from the compressed block log: ${e}", ("n", block_num)("e", e.what()) );
+   }
+   return optional<signed_block>();
+}
+
+std::shared_ptr<const compressed_block_log::decoded_chunk> compressed_block_log::get_chunk( uint32_t chunk_num )const
+{
+   auto itr = _cached_chunks.find( chunk_num );
+   if( itr != _cached_chunks.end() )
+   {
+      _cache.splice( _cache.begin(), _cache, itr->second );
+      return itr->second->second;
+   }
+
+   auto chunk = decode_chunk( chunk_num );
+   _cache.emplace_front( chunk_num, chunk );
+   _cached_chunks[chunk_num] = _cache.begin();
+   if( _cache.size() > _cache_size )
+   {
+      _cached_chunks.erase( _cache.back().first );
+      _cache.pop_back();
+   }
+   return chunk;
+}
+
+std::shared_ptr<const compressed_block_log::decoded_chunk> compressed_block_log::decode_chunk( uint32_t chunk_num )const
+{
+   const chunk_index_entry& e = _chunk_index[chunk_num];
+   vector<char> compressed( e.chunk_size );
+   _chunks.seekg( e.chunk_pos );
+   _chunks.read( compressed.data(), compressed.size() );
+
+   auto chunk = std::make_shared<decoded_chunk>();
+   chunk->data.resize( e.decoded_size );
+   inflate_chunk( compressed, _dictionary, chunk->data );
+
+   chunk->block_offsets.reserve( _blocks_per_chunk );
+   uint64_t pos = 0;
+   while( pos + sizeof(uint32_t) <= chunk->data.size() )
+   {
+      uint32_t size;
+      memcpy( &size, chunk->data.data() + pos, sizeof(size) );
+      chunk->block_offsets.push_back( pos );
+      pos += sizeof(size) + size;
+   }
+   FC_ASSERT( pos == chunk->data.size() && chunk->block_offsets.size() == _blocks_per_chunk,
+              "corrupt block chunk ${n}", ("n", chunk_num) );
+   return chunk;
+}
+
+} } // graphene::chain
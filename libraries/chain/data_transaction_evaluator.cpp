@@ -119,22 +119,16 @@ object_id_type data_transaction_create_evaluator::do_apply(const data_transactio
        }
    }
 
-   vector<data_transaction_datasource_status_object> datasources_status;
+   vector<account_id_type> datasources;
    if (op.league_id.valid()) {
        // get league members as datasource list
-       auto league = db().get(*op.league_id);
-       for (auto& member : league.members) {
-           data_transaction_datasource_status_object obj;
-           obj.datasource = member;
-           datasources_status.push_back(obj);
-       }
+       const auto& league = db().get(*op.league_id);
+       datasources = league.members;
    } else {
        // get free_data_product datasource
        auto product_id = static_cast<free_data_product_id_type>(op.product_id);
-       free_data_product_object free_data_obj = db().get(product_id);
-       data_transaction_datasource_status_object obj;
-       obj.datasource = free_data_obj.datasource;
-       datasources_status.push_back(obj);
+       const auto& free_data_obj = db().get(product_id);
+       datasources.push_back(free_data_obj.datasource);
    }
 
    const auto& new_object = db().create<data_transaction_object>([&](data_transaction_object& obj) {
@@ -145,13 +139,22 @@ object_id_type data_transaction_create_evaluator::do_apply(const data_transactio
        } else {
            obj.league_id = fc::optional<league_id_type>();
        }
-       obj.datasources_status= datasources_status;
        obj.version        = op.version;
        obj.params         = op.params;
        obj.status         = data_status;
        obj.requester      = op.requester;
        obj.create_date_time= op.create_date_time;
    });
+
+   // datasource status objects, initial status
+   for (const auto& datasource : datasources) {
+       if (new_object.find_datasource_state(db(), datasource) != nullptr)
+           continue;
+       db().create<data_transaction_datasource_state_object>([&](data_transaction_datasource_state_object& obj) {
+           obj.data_transaction = new_object.get_id();
+           obj.datasource = datasource;
+       });
+   }
    return  new_object.id;
 
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -208,11 +211,7 @@ void_result data_transaction_datasource_upload_evaluator::do_evaluate(const data
     FC_ASSERT(dto != data_transaction_idx.end());
 
     // op.datasource must in datasources_status list
-    auto iter = find_if(dto->datasources_status.begin(), dto->datasources_status.end(),
-            [&](const data_transaction_datasource_status_object& status_obj) -> bool {
-                return status_obj.datasource == op.datasource;
-            });
-    FC_ASSERT(iter != dto->datasources_status.end(), "datasource account is not found datasources status!");
+    FC_ASSERT(dto->find_datasource_state(_db, op.datasource) != nullptr, "datasource account is not found datasources status!");
 
     // check status, must be 1
     FC_ASSERT(data_transaction_status_confirmed == dto->status, "data_transaction status ${status} != 1", ("status", dto->status));
@@ -233,12 +232,11 @@ void_result data_transaction_datasource_upload_evaluator::do_apply(const data_tr
 
     // set datasource status
     const data_transaction_object& dto = *maybe_found;
-    _db.modify(dto, [&](data_transaction_object& obj) {
-        for (auto& status_obj : obj.datasources_status) {
-            if (status_obj.datasource == op.datasource)
-                status_obj.status = data_transaction_datasource_status_uploaded;
-        }
-    });
+    if (const auto* state = dto.find_datasource_state(_db, op.datasource)) {
+        _db.modify(*state, [&](data_transaction_datasource_state_object& obj) {
+            obj.status = data_transaction_datasource_status_uploaded;
+        });
+    }
 
     // copyright verify
     bool copyright_verify = false;
@@ -319,10 +317,8 @@ void_result data_transaction_datasource_validate_error_evaluator::do_evaluate(co
               "data_transaction status ${status} != 1", ("status", dto->status));
 
     // check datasources_status, must be 0
-    for (auto& status_obj : dto->datasources_status) {
-        if (status_obj.datasource == op.datasource) {
-            FC_ASSERT(data_transaction_datasource_status_init == status_obj.status, "datasources_status status must be 0");
-        }
+    if (const auto* state = dto->find_datasource_state(_db, op.datasource)) {
+        FC_ASSERT(data_transaction_datasource_status_init == state->status, "datasources_status status must be 0");
     }
 
     return void_result();
@@ -340,15 +336,11 @@ void_result data_transaction_datasource_validate_error_evaluator::do_apply(const
     }
 
     const data_transaction_object &data_transaction_obj = *maybe_found;
-    _db.modify(
-       data_transaction_obj,
-       [&]( data_transaction_object& obj ) {
-        for (auto& status_obj : obj.datasources_status) {
-            if (status_obj.datasource == op.datasource) {
-                status_obj.status = data_transaction_datasource_status_error;
-            }
-        }
-       });
+    if (const auto* state = data_transaction_obj.find_datasource_state(_db, op.datasource)) {
+        _db.modify(*state, [&](data_transaction_datasource_state_object& obj) {
+            obj.status = data_transaction_datasource_status_error;
+        });
+    }
     return void_result();
 
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -373,12 +365,9 @@ void_result data_transaction_complain_evaluator::do_evaluate( const data_transac
     // check requester
     FC_ASSERT(dto->requester == op.requester, "requester not in data_transaction");
     // check datasource and pay status
-    auto iter = std::find_if(
-        dto->datasources_status.begin(), dto->datasources_status.end(),
-        [&](const data_transaction_datasource_status_object& s) -> bool {
-            return s.datasource == op.datasource && s.status == data_transaction_datasource_status_payed;
-        });
-    FC_ASSERT(iter != dto->datasources_status.end(), "datasource not in datasource_status list, or datasource_status not payed");
+    const auto* state = dto->find_datasource_state(_db, op.datasource);
+    FC_ASSERT(state != nullptr && state->status == data_transaction_datasource_status_payed,
+              "datasource not in datasource_status list, or datasource_status not payed");
 
     return void_result();
 } FC_CAPTURE_AND_RETHROW((op)) }
@@ -0,0 +1,49 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <graphene/chain/data_transaction_object.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <boost/range/iterator_range.hpp>
+
+namespace graphene { namespace chain {
+
+const data_transaction_datasource_state_object* data_transaction_object::find_datasource_state(const database& db, account_id_type datasource)const
+{
+    const auto& idx = db.get_index_type<data_transaction_datasource_state_index>().indices().get<by_data_transaction_datasource>();
+    auto itr = idx.find(boost::make_tuple(get_id(), datasource));
+    return itr == idx.end() ? nullptr : &*itr;
+}
+
+vector<data_transaction_datasource_status_object> data_transaction_object::get_datasources_status(const database& db)const
+{
+    const auto& idx = db.get_index_type<data_transaction_datasource_state_index>().indices().get<by_data_transaction_datasource>();
+    auto range = idx.equal_range(boost::make_tuple(get_id()));
+
+    vector<data_transaction_datasource_status_object> result;
+    for (const auto& state : boost::make_iterator_range(range.first, range.second)) {
+        data_transaction_datasource_status_object status_obj;
+        status_obj.datasource = state.datasource;
+        status_obj.status = state.status;
+        result.push_back(status_obj);
+    }
+    return result;
+}
+
+} } // graphene::chain
@@ -44,6 +44,16 @@
 
 namespace graphene { namespace chain {
 
+/** @return the cpu time billed to the contract calls of trx */
+static uint64_t billed_cpu_time( const processed_transaction& trx )
+{
+   uint64_t result = 0;
+   for( const auto& op_result : trx.operation_results )
+      if( op_result.which() == operation_result::tag<contract_receipt>::value )
+         result += op_result.get<contract_receipt>().billed_cpu_time_us;
+   return result;
+}
+
 bool database::is_known_block( const block_id_type& id )const
 {
    return _fork_db.is_known_block(id) || _block_id_to_block.contains(id);
@@ -117,6 +127,7 @@ std::vector<block_id_type> database::get_block_ids_on_fork(block_id_type head_of
 bool database::push_block(const signed_block& new_block, uint32_t skip)
 {
 //   idump((new_block.block_num())(new_block.id())(new_block.timestamp)(new_block.previous));
+   state_lock::write_guard write_lock( get_state_lock() );
    bool result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -222,6 +233,7 @@ bool database::_push_block(const signed_block& new_block)
  */
 processed_transaction database::push_transaction( const signed_transaction& trx, uint32_t skip )
 { try {
+   state_lock::write_guard write_lock( get_state_lock() );
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -235,7 +247,14 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    // If this is the first transaction pushed after applying a block, start a new undo session.
    // This allows us to quickly rewind to the clean state of the head block, in case a new block arrives.
    if( !_pending_tx_session.valid() )
+   {
       _pending_tx_session = _undo_db.start_undo_session();
+      // transactions left over from a popped block are not applied in the new session
+      _pending_tx_reusable = _pending_tx.empty();
+      _pending_tx_skip_flags = 0;
+      _pending_tx_block_size = 0;
+      _pending_tx_block_cpu = 0;
+   }
 
    // Create a temporary undo session as a child of _pending_tx_session.
    // The temporary session will be discarded by the destructor if
@@ -245,6 +264,9 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
    auto temp_session = _undo_db.start_undo_session();
    auto processed_trx = _apply_transaction( trx );
    _pending_tx.push_back(processed_trx);
+   _pending_tx_skip_flags |= get_node_properties().skip_flags;
+   _pending_tx_block_size += fc::raw::pack_size( processed_trx );
+   _pending_tx_block_cpu += billed_cpu_time( processed_trx );
 
    // notify_changed_objects();
    // The transaction applied successfully. Merge its changes into the pending block session.
@@ -258,6 +280,7 @@ processed_transaction database::_push_transaction( const signed_transaction& trx
 
 processed_transaction database::validate_transaction( const signed_transaction& trx )
 {
+   state_lock::write_guard write_lock( get_state_lock() );
    auto session = _undo_db.start_undo_session();
    return _apply_transaction( trx );
 }
@@ -306,6 +329,7 @@ signed_block database::generate_block(
    uint32_t skip /* = 0 */
    )
 { try {
+   state_lock::write_guard write_lock( get_state_lock() );
    signed_block result;
    detail::with_skip_flags( *this, skip, [&]()
    {
@@ -339,63 +363,69 @@ signed_block database::_generate_block(
 
    signed_block pending_block;
 
-   //
-   // The following code throws away existing pending_tx_session and
-   // rebuilds it by re-applying pending transactions.
-   //
-   // This rebuild is necessary because pending transactions' validity
-   // and semantics may have changed since they were received, because
-   // time-based semantics are evaluated based on the current block
-   // time.  These changes can only be reflected in the database when
-   // the value of the "when" variable is known, which means we need to
-   // re-apply pending transactions in this method.
-   //
-   _pending_tx_session.reset();
-   _pending_tx_session = _undo_db.start_undo_session();
-
    uint64_t block_cpu_limit = get_cpu_limit().block_cpu_limit;
-   uint64_t new_block_cpu = 0;
-   uint64_t postponed_tx_count = 0;
-   // pop pending state (reset to head block state)
-   for (const processed_transaction &tx : _pending_tx) {
-       size_t new_total_size = total_block_size + fc::raw::pack_size(tx);
-
-       // postpone transaction if it would make block too big
-       if (new_total_size >= maximum_block_size || new_block_cpu >= block_cpu_limit) {
-           postponed_tx_count++;
-           continue;
-       }
-
-       try {
-           auto temp_session = _undo_db.start_undo_session();
-           processed_transaction ptx = _apply_transaction(tx);
-           // check block cpu limit
-           for (const auto op_result : ptx.operation_results) {
-               if (op_result.which() == operation_result::tag<contract_receipt>::value) {
-                   new_block_cpu += op_result.get<contract_receipt>().billed_cpu_time_us;
-               }
-           }
-           if (new_block_cpu >= block_cpu_limit) {
-               wlog("posponed due to block cpu limit");
-               postponed_tx_count++;
-               continue;
-           }
 
-           temp_session.merge();
-
-           // We have to recompute pack_size(ptx) because it may be different
-           // than pack_size(tx) (i.e. if one or more results increased
-           // their size)
-           total_block_size += fc::raw::pack_size(ptx);
-           pending_block.transactions.push_back(ptx);
-       } catch (const fc::exception &e) {
-           // Do nothing, transaction will not be re-applied
-           wlog("Transaction was not processed while generating block due to ${e}", ("e", e));
-           wlog("The transaction was ${t}", ("t", tx));
-       }
+   // The pending transactions were applied in order on the head block when they were pushed, with the same time
+   // and no check skipped that the producer runs.  If all of them fit into the block, their results are the block.
+   const uint32_t reusable_skip = skip;
+   if( _pending_tx_session.valid() && _pending_tx_reusable && !(_pending_tx_skip_flags & ~reusable_skip)
+       && total_block_size + _pending_tx_block_size < maximum_block_size && _pending_tx_block_cpu < block_cpu_limit )
+   {
+      pending_block.transactions = _pending_tx;
    }
-   if (postponed_tx_count > 0) {
-       wlog("Postponed ${n} transactions due to block size limit or block cpu limit", ("n", postponed_tx_count));
+   else
+   {
+      //
+      // The following code throws away existing pending_tx_session and
+      // rebuilds it by re-applying pending transactions.
+      //
+      // This rebuild is necessary when the pending state no longer matches
+      // _pending_tx (e.g. after a block was popped), or when some pending
+      // transactions have to be postponed, which may change the results of
+      // the ones after them.
+      //
+      _pending_tx_session.reset();
+      _pending_tx_session = _undo_db.start_undo_session();
+
+      uint64_t new_block_cpu = 0;
+      uint64_t postponed_tx_count = 0;
+      // pop pending state (reset to head block state)
+      for (const processed_transaction &tx : _pending_tx) {
+          size_t new_total_size = total_block_size + fc::raw::pack_size(tx);
+
+          // postpone transaction if it would make block too big
+          if (new_total_size >= maximum_block_size || new_block_cpu >= block_cpu_limit) {
+              postponed_tx_count++;
+              continue;
+          }
+
+          try {
+              auto temp_session = _undo_db.start_undo_session();
+              processed_transaction ptx = _apply_transaction(tx);
+              // check block cpu limit
+              new_block_cpu += billed_cpu_time(ptx);
+              if (new_block_cpu >= block_cpu_limit) {
+                  wlog("posponed due to block cpu limit");
+                  postponed_tx_count++;
+                  continue;
+              }
+
+              temp_session.merge();
+
+              // We have to recompute pack_size(ptx) because it may be different
+              // than pack_size(tx) (i.e. if one or more results increased
+              // their size)
+              total_block_size += fc::raw::pack_size(ptx);
+              pending_block.transactions.push_back(ptx);
+          } catch (const fc::exception &e) {
+              // Do nothing, transaction will not be re-applied
+              wlog("Transaction was not processed while generating block due to ${e}", ("e", e));
+              wlog("The transaction was ${t}", ("t", tx));
+          }
+      }
+      if (postponed_tx_count > 0) {
+          wlog("Postponed ${n} transactions due to block size limit or block cpu limit", ("n", postponed_tx_count));
+      }
    }
 
    _pending_tx_session.reset();
@@ -431,6 +461,7 @@ signed_block database::_generate_block(
  */
 void database::pop_block()
 { try {
+   state_lock::write_guard write_lock( get_state_lock() );
    _pending_tx_session.reset();
    auto head_id = head_block_id();
    optional<signed_block> head_block = fetch_block_by_id( head_id );
@@ -445,11 +476,35 @@ void database::pop_block()
 
 void database::clear_pending()
 { try {
+   state_lock::write_guard write_lock( get_state_lock() );
    assert( (_pending_tx.size() == 0) || _pending_tx_session.valid() );
    _pending_tx.clear();
    _pending_tx_session.reset();
 } FC_CAPTURE_AND_RETHROW() }
 
+void database::set_transaction_verify_threads( uint32_t count )
+{
+   if( count == 0 )
+      _transaction_verifier.reset();
+   else if( !_transaction_verifier || _transaction_verifier->thread_count() != count )
+      _transaction_verifier.reset( new transaction_verifier( count ) );
+}
+
+uint32_t database::get_transaction_verify_threads()const
+{
+   return _transaction_verifier ? _transaction_verifier->thread_count() : 0;
+}
+
+void database::set_block_log_prune_window( uint32_t blocks )
+{
+   if( blocks > 0 && blocks < GRAPHENE_MAX_UNDO_HISTORY )
+   {
+      wlog( "Keeping ${n} blocks instead of ${b}, all undoable blocks must be kept", ("n", GRAPHENE_MAX_UNDO_HISTORY)("b", blocks) );
+      blocks = GRAPHENE_MAX_UNDO_HISTORY;
+   }
+   _block_id_to_block.set_prune_window( blocks );
+}
+
 uint32_t database::push_applied_operation( const operation& op )
 {
    _applied_ops.emplace_back(op);
@@ -500,13 +555,16 @@ void database::apply_block( const signed_block& next_block, uint32_t skip )
 
 void database::_apply_block( const signed_block& next_block )
 { try {
+   scoped_phase_timer block_timer( _execution_profiler, block_total );
    uint32_t next_block_num = next_block.block_num();
    uint32_t skip = get_node_properties().skip_flags;
    _applied_ops.clear();
 
    FC_ASSERT( (skip & skip_merkle_check) || next_block.transaction_merkle_root == next_block.calculate_merkle_root(), "", ("next_block.transaction_merkle_root",next_block.transaction_merkle_root)("calc",next_block.calculate_merkle_root())("next_block",next_block)("id",next_block.id()) );
 
+   scoped_phase_timer header_timer( _execution_profiler, block_header_check );
    const witness_object& signing_witness = validate_block_header(skip, next_block);
+   header_timer.stop();
    const auto& global_props = get_global_properties();
    const auto& dynamic_global_props = get<dynamic_global_property_object>(dynamic_global_property_id_type());
    bool maint_needed = (dynamic_global_props.next_maintenance_time <= next_block.timestamp);
@@ -514,6 +572,14 @@ void database::_apply_block( const signed_block& next_block )
    _current_block_num    = next_block_num;
    _current_trx_in_block = 0;
 
+   vector<bool> verified;
+   if( _transaction_verifier && !(skip & (skip_transaction_signatures | skip_authority_check)) )
+   {
+      scoped_phase_timer timer( _execution_profiler, block_signature_verification );
+      verified = _transaction_verifier->verify_block( *this, next_block );
+   }
+
+   scoped_phase_timer transactions_timer( _execution_profiler, block_transactions );
    for( const auto& trx : next_block.transactions )
    {
       /* We do not need to push the undo state for each transaction
@@ -522,9 +588,11 @@ void database::_apply_block( const signed_block& next_block )
        * for transactions when validating broadcast transactions or
        * when building a block.
        */
-      apply_transaction(trx, skip, trx.operation_results);
+      apply_transaction(trx, skip, trx.operation_results,
+                        _current_trx_in_block < verified.size() && verified[_current_trx_in_block]);
       ++_current_trx_in_block;
    }
+   transactions_timer.stop();
 
    // check block cpu limit
    uint64_t block_cpu_time_us = 0;
@@ -543,12 +611,24 @@ void database::_apply_block( const signed_block& next_block )
 
    // Are we at the maintenance interval?
    if( maint_needed )
+   {
+      scoped_phase_timer timer( _execution_profiler, block_chain_maintenance );
       perform_chain_maintenance(next_block, global_props);
+   }
 
    create_block_summary(next_block);
-   clear_expired_transactions();
-   clear_expired_proposals();
-   clear_expired_signature_objs();
+   {
+      scoped_phase_timer timer( _execution_profiler, block_clear_expired_transactions );
+      clear_expired_transactions();
+   }
+   {
+      scoped_phase_timer timer( _execution_profiler, block_clear_expired_proposals );
+      clear_expired_proposals();
+   }
+   {
+      scoped_phase_timer timer( _execution_profiler, block_clear_expired_signature_objs );
+      clear_expired_signature_objs();
+   }
    update_withdraw_permissions();
 
    // n.b., update_maintenance_flag() happens this late
@@ -562,25 +642,34 @@ void database::_apply_block( const signed_block& next_block )
       apply_debug_updates();
 
    // notify observers that the block has been applied
-   applied_block( next_block ); //emit
+   {
+      scoped_phase_timer timer( _execution_profiler, block_applied_signal );
+      applied_block( next_block ); //emit
+   }
    _applied_ops.clear();
 
-   notify_changed_objects();
+   {
+      scoped_phase_timer timer( _execution_profiler, block_notify_changed_objects );
+      notify_changed_objects();
+   }
+   _execution_profiler.log_if_due();
 } FC_CAPTURE_AND_RETHROW( (next_block.block_num()) )  }
 
 
 
-processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip, const vector<operation_result> &operation_results)
+processed_transaction database::apply_transaction(const signed_transaction& trx, uint32_t skip, const vector<operation_result> &operation_results,
+                                                  bool authority_verified)
 {
    processed_transaction result;
    detail::with_skip_flags( *this, skip, [&]()
    {
-      result = _apply_transaction(trx, operation_results);
+      result = _apply_transaction(trx, operation_results, authority_verified);
    });
    return result;
 }
 
-processed_transaction database::_apply_transaction(const signed_transaction& trx, const vector<operation_result> &operation_results)
+processed_transaction database::_apply_transaction(const signed_transaction& trx, const vector<operation_result> &operation_results,
+                                                   bool authority_verified)
 { try {
    uint32_t skip = get_node_properties().skip_flags;
 
@@ -596,11 +685,14 @@ processed_transaction database::_apply_transaction(const signed_transaction& trx
    const chain_parameters& chain_parameters = get_global_properties().parameters;
    eval_state._trx = &trx;
 
-   if( !(skip & (skip_transaction_signatures | skip_authority_check) ) )
+   if( !authority_verified && !(skip & (skip_transaction_signatures | skip_authority_check) ) )
    {
       auto get_active = [&]( account_id_type id ) { return &id(*this).active; };
       auto get_owner  = [&]( account_id_type id ) { return &id(*this).owner;  };
+      const fc::time_point start = _execution_profiler.enabled() ? fc::time_point::now() : fc::time_point();
       trx.verify_authority( chain_id, get_active, get_owner, get_global_properties().parameters.max_authority_depth );
+      if( start != fc::time_point() )
+         _execution_profiler.record_transaction_phase( transaction_authority_check, fc::time_point::now() - start );
    }
 
    //Skip all manner of expiration and TaPoS checking if we're on block 1; It's impossible that the transaction is
@@ -675,7 +767,10 @@ operation_result database::apply_operation(transaction_evaluation_state& eval_st
    if( !eval )
       assert( "No registered evaluator for this operation" && false );
    auto op_id = push_applied_operation( op );
+   const fc::time_point start = _execution_profiler.enabled() ? fc::time_point::now() : fc::time_point();
    auto result = eval->evaluate(eval_state, op, true, billed_cpu_time_us);
+   if( start != fc::time_point() )
+      _execution_profiler.record_operation( i_which, fc::time_point::now() - start );
    set_applied_operation_result( op_id, result );
    return result;
 } FC_CAPTURE_AND_RETHROW( (op) ) }
@@ -26,6 +26,7 @@
 #include <graphene/chain/fba_accumulator_id.hpp>
 
 #include <graphene/chain/account_object.hpp>
+#include <graphene/chain/account_rank_index.hpp>
 #include <graphene/chain/asset_object.hpp>
 #include <graphene/chain/balance_object.hpp>
 #include <graphene/chain/block_summary_object.hpp>
@@ -161,6 +162,9 @@ const uint8_t league_object::type_id;
 const uint8_t data_transaction_object::space_id;
 const uint8_t data_transaction_object::type_id;
 
+const uint8_t data_transaction_datasource_state_object::space_id;
+const uint8_t data_transaction_datasource_state_object::type_id;
+
 const uint8_t pocs_object::space_id;
 const uint8_t pocs_object::type_id;
 
@@ -296,12 +300,15 @@ void database::initialize_indexes()
    add_index< primary_index<data_transaction_index> >();
    add_index< primary_index<pocs_index> >();
    add_index< primary_index<datasource_copyright_index> >();
-   add_index< primary_index<data_transaction_complain_index> >();
-   add_index< primary_index<second_hand_data_index> >();
+   auto complain_index = add_index< primary_index<data_transaction_complain_index> >();
+   complain_index->add_secondary_index<data_transaction_complain_rank_index>();
+   auto second_hand_index = add_index< primary_index<second_hand_data_index> >();
+   second_hand_index->add_secondary_index<second_hand_data_rank_index>();
 
    //Implementation object indexes
    add_index< primary_index<transaction_index                             > >();
-   add_index< primary_index<account_balance_index                         > >();
+   auto bal_index = add_index< primary_index<account_balance_index        > >();
+   bal_index->add_secondary_index<asset_holder_count_index>();
    add_index< primary_index<account_balance_locked_index                  > >();
    add_index< primary_index<asset_bitasset_data_index                     > >();
    add_index< primary_index<simple_index<global_property_object          >> >();
@@ -318,6 +325,7 @@ void database::initialize_indexes()
    add_index< primary_index< simple_index< fba_accumulator_object       > > >();
 
    add_index< primary_index<signature_index                            > >();
+   add_index< primary_index<data_transaction_datasource_state_index    > >();
 
    // contract object indexes
    add_index< primary_index< table_id_multi_index> >();
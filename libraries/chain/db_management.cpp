@@ -56,6 +56,9 @@ void database::reindex(fc::path data_dir, bool fast_replay)
       return;
    }
    if( last_block->block_num() <= head_block_num()) return;
+   FC_ASSERT( head_block_num() + 1 >= _block_id_to_block.first_block_num(),
+              "Unable to replay from block ${next}, the blocks before ${first} were pruned from the block database",
+              ("next", head_block_num() + 1)("first", _block_id_to_block.first_block_num()) );
 
    ilog( "reindexing blockchain" );
    auto start = fc::time_point::now();
@@ -458,6 +458,12 @@ void get_relevant_accounts( const object* obj, flat_set<account_id_type>& accoun
               break;
              case impl_key_value_object_type:
               break;
+             case impl_data_transaction_datasource_state_object_type: {
+              const auto& aobj = dynamic_cast<const data_transaction_datasource_state_object*>(obj);
+              FC_ASSERT( aobj != nullptr );
+              accounts.insert( aobj->datasource );
+              break;
+           }
       }
 
    }
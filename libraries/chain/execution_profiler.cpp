@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/execution_profiler.hpp>
+#include <graphene/chain/protocol/operations.hpp>
+
+#include <fc/log/logger.hpp>
+
+#include <algorithm>
+
+namespace graphene { namespace chain {
+
+namespace {
+
+   struct operation_name_visitor
+   {
+      typedef string result_type;
+
+      template<typename Operation>
+      string operator()( const Operation& )const
+      {
+         string name = fc::get_typename<Operation>::name();
+         auto pos = name.rfind( "::" );
+         return pos == string::npos ? name : name.substr( pos + 2 );
+      }
+   };
+
+   string operation_name( int which )
+   {
+      operation op;
+      op.set_which( which );
+      return op.visit( operation_name_visitor() );
+   }
+
+   execution_profile_entry make_entry( const char* category, string name, const latency_histogram& histogram )
+   {
+      execution_profile_entry entry;
+      entry.category = category;
+      entry.name = std::move( name );
+      entry.count = histogram.count;
+      entry.total_us = histogram.total_us;
+      entry.max_us = histogram.max_us;
+      entry.p50_us = histogram.percentile( 0.5 );
+      entry.p90_us = histogram.percentile( 0.9 );
+      entry.p99_us = histogram.percentile( 0.99 );
+      auto last = std::find_if( histogram.buckets.rbegin(), histogram.buckets.rend(), []( uint64_t n ) { return n != 0; } );
+      entry.buckets.assign( histogram.buckets.begin(), last.base() );
+      return entry;
+   }
+
+}
+
+void latency_histogram::record( uint64_t us )
+{
+   uint32_t bucket = 0;
+   for( uint64_t rest = us >> 1; rest != 0 && bucket + 1 < bucket_count; rest >>= 1 )
+      ++bucket;
+   ++buckets[bucket];
+   ++count;
+   total_us += us;
+   max_us = std::max( max_us, us );
+}
+
+uint64_t latency_histogram::percentile( double fraction )const
+{
+   if( count == 0 )
+      return 0;
+   const uint64_t wanted = std::max<uint64_t>( 1, uint64_t( count * fraction + 0.5 ) );
+   uint64_t seen = 0;
+   for( uint32_t i = 0; i < bucket_count; ++i )
+   {
+      seen += buckets[i];
+      if( seen >= wanted )
+         return std::min( uint64_t(2) << i, max_us );
+   }
+   return max_us;
+}
+
+void execution_profiler::reset()
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _operations.clear();
+   _contracts.clear();
+   _block_phases.fill( latency_histogram() );
+   _transaction_phases.fill( latency_histogram() );
+}
+
+void execution_profiler::record_operation( int which, const fc::microseconds& elapsed )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   if( _operations.size() <= size_t( which ) )
+      _operations.resize( which + 1 );
+   _operations[which].record( elapsed.count() );
+}
+
+void execution_profiler::record_contract( account_id_type contract, const string& action, const fc::microseconds& elapsed )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _contracts[ std::make_pair( contract, action ) ].record( elapsed.count() );
+}
+
+void execution_profiler::record_block_phase( profiled_block_phase phase, const fc::microseconds& elapsed )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _block_phases[phase].record( elapsed.count() );
+}
+
+void execution_profiler::record_transaction_phase( profiled_transaction_phase phase, const fc::microseconds& elapsed )
+{
+   std::lock_guard<std::mutex> lock( _mutex );
+   _transaction_phases[phase].record( elapsed.count() );
+}
+
+vector<execution_profile_entry> execution_profiler::get_profile()const
+{
+   vector<execution_profile_entry> result;
+   std::lock_guard<std::mutex> lock( _mutex );
+   for( size_t i = 0; i < _block_phases.size(); ++i )
+      if( _block_phases[i].count > 0 )
+         result.push_back( make_entry( "block", fc::reflector<profiled_block_phase>::to_string( int64_t( i ) ), _block_phases[i] ) );
+   for( size_t i = 0; i < _transaction_phases.size(); ++i )
+      if( _transaction_phases[i].count > 0 )
+         result.push_back( make_entry( "transaction", fc::reflector<profiled_transaction_phase>::to_string( int64_t( i ) ),
+                                       _transaction_phases[i] ) );
+   for( size_t i = 0; i < _operations.size(); ++i )
+      if( _operations[i].count > 0 )
+         result.push_back( make_entry( "operation", operation_name( i ), _operations[i] ) );
+   for( const auto& contract : _contracts )
+      result.push_back( make_entry( "contract",
+                                    string( object_id_type( contract.first.first ) ) + "::" + contract.first.second,
+                                    contract.second ) );
+   return result;
+}
+
+void execution_profiler::log_if_due()
+{
+   if( !enabled() || _log_interval.count() <= 0 )
+      return;
+   const fc::time_point now = fc::time_point::now();
+   if( _last_log == fc::time_point() )
+      _last_log = now;
+   if( now - _last_log < _log_interval )
+      return;
+   _last_log = now;
+   for( const auto& entry : get_profile() )
+      ilog( "profile ${c} ${n}: count ${k}, total ${t} us, p50 ${p50} us, p90 ${p90} us, p99 ${p99} us, max ${m} us",
+            ("c", entry.category)("n", entry.name)("k", entry.count)("t", entry.total_us)
+            ("p50", entry.p50_us)("p90", entry.p90_us)("p99", entry.p99_us)("m", entry.max_us) );
+}
+
+} } // graphene::chain
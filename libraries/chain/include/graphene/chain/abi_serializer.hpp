@@ -45,6 +45,12 @@ struct abi_serializer {
 
    optional<string>  get_error_message( uint64_t error_code )const;
 
+   /**
+    *  Drops the decoding plans compiled by set_abi, so that every call resolves the types by name again.
+    *  The results are the same either way.
+    */
+   void clear_type_plans();
+
    fc::variant binary_to_variant(const type_name& type, const bytes& binary, const fc::microseconds& max_serialization_time)const {
       return _binary_to_variant(type, binary, 0, fc::time_point::now() + max_serialization_time, max_serialization_time);
    }
@@ -100,6 +106,38 @@ private:
    map<type_name, pair<unpack_function, pack_function>> built_in_types;
    void configure_built_in_types();
 
+   static const uint32_t no_plan = uint32_t(-1);
+
+   /**
+    *  A type of the ABI with its typedefs, array and optional suffixes and struct fields resolved once, so that
+    *  packing and unpacking a value follows indices instead of looking up type names.
+    */
+   struct type_plan {
+      enum kind_type { builtin_kind, array_kind, optional_kind, struct_kind, unknown_kind };
+
+      type_name                            name;      ///< the type as written in the ABI
+      type_name                            resolved;  ///< name with its typedefs resolved
+      kind_type                            kind = unknown_kind;
+      pair<unpack_function, pack_function> codec;     ///< builtin_kind
+      bool                                 codec_array = false;
+      bool                                 codec_optional = false;
+      uint32_t                             element = no_plan;  ///< array_kind, optional_kind
+      uint32_t                             base = no_plan;     ///< struct_kind
+      vector<pair<string, uint32_t>>       fields;             ///< struct_kind
+   };
+   vector<type_plan>          plans;
+   map<type_name, uint32_t>   plan_index;
+
+   void     compile_type_plans();
+   uint32_t compile_type_plan(const type_name& type);
+
+   fc::variant _binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream,
+                                  size_t recursion_depth, const fc::time_point& deadline, const fc::microseconds& max_serialization_time)const;
+   void        _binary_to_variant(const type_plan& plan, fc::datastream<const char*>& stream, fc::mutable_variant_object& obj,
+                                  size_t recursion_depth, const fc::time_point& deadline, const fc::microseconds& max_serialization_time)const;
+   void        _variant_to_binary(const type_plan& plan, const fc::variant& var, fc::datastream<char*>& ds,
+                                  size_t recursion_depth, const fc::time_point& deadline, const fc::microseconds& max_serialization_time)const;
+
    fc::variant _binary_to_variant(const type_name& type, const bytes& binary,
                                   size_t recursion_depth, const fc::time_point& deadline, const fc::microseconds& max_serialization_time)const;
    bytes       _variant_to_binary(const type_name& type, const fc::variant& var,
@@ -25,6 +25,8 @@
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/chain/abi_def.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/simple_index.hpp>
+#include <graphene/db/pool_allocator.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
 namespace graphene { namespace chain {
@@ -105,6 +107,8 @@ namespace graphene { namespace chain {
          static const uint8_t space_id = implementation_ids;
          static const uint8_t type_id  = impl_account_balance_object_type;
 
+         GRAPHENE_POOLED_OBJECT( account_balance_object )
+
          account_id_type   owner;
          asset_id_type     asset_type;
          share_type        balance;
@@ -421,13 +425,39 @@ namespace graphene { namespace chain {
                std::less< account_id_type >
             >
          >
-      >
+      >,
+      pool_allocator<account_balance_object>
    > account_balance_object_multi_index_type;
 
    /**
     * @ingroup object_index
     */
-   typedef generic_index<account_balance_object, account_balance_object_multi_index_type> account_balance_index;
+   typedef generic_index<account_balance_object, account_balance_object_multi_index_type, dense_id_lookup> account_balance_index;
+
+   /**
+    *  @brief This secondary index counts the accounts holding a non-zero balance of each asset.
+    *
+    *  The holders themselves, ordered by balance, are found through the by_asset_balance index.
+    */
+   class asset_holder_count_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override;
+         virtual void object_modified( const object& after  ) override;
+
+         uint64_t get_holder_count( asset_id_type asset_id )const;
+
+         /** maps an asset to the number of accounts with a non-zero balance of it */
+         flat_map< asset_id_type, uint64_t > holder_counts;
+
+      protected:
+         void add_holder( asset_id_type asset_id );
+         void remove_holder( asset_id_type asset_id );
+
+         bool before_holding = false;
+   };
 
     /**
     * @ingroup object_index
@@ -467,7 +497,7 @@ namespace graphene { namespace chain {
    /**
     * @ingroup object_index
     */
-   typedef generic_index<account_object, account_multi_index_type> account_index;
+   typedef generic_index<account_object, account_multi_index_type, dense_id_lookup> account_index;
 
 }}
 
@@ -502,3 +532,7 @@ FC_REFLECT_DERIVED( graphene::chain::account_statistics_object,
                     (pending_fees)(pending_vested_fees)
                   )
 
+
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::account_object, graphene::chain::account_index )
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::account_balance_object, graphene::chain::account_balance_index )
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::account_statistics_object, graphene::db::simple_index<graphene::chain::account_statistics_object> )
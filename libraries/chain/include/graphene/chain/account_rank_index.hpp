@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <graphene/chain/data_transaction_object.hpp>
+#include <graphene/chain/second_hand_data_object.hpp>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief Per-account event counters grouped into fixed width time buckets
+    *
+    *  Bucket b covers [b * bucket_seconds, (b + 1) * bucket_seconds).  Callers answering a time range query
+    *  sum the buckets fully covered by the range from here and scan only the partial head and tail buckets
+    *  in the underlying index.
+    */
+   class account_bucket_counter
+   {
+      public:
+         static const uint32_t bucket_seconds = 3600;
+
+         static uint32_t bucket_of( time_point_sec t ) { return t.sec_since_epoch() / bucket_seconds; }
+         static time_point_sec bucket_start( uint32_t bucket ) { return time_point_sec( bucket * bucket_seconds ); }
+
+         void increment( time_point_sec t, account_id_type account );
+         void decrement( time_point_sec t, account_id_type account );
+
+         /** adds the counters of buckets [first_bucket, last_bucket) into totals */
+         void accumulate( uint32_t first_bucket, uint32_t last_bucket, map<account_id_type, uint64_t>& totals )const;
+
+         /** @return the counter of account summed over buckets [first_bucket, last_bucket) */
+         uint64_t count( uint32_t first_bucket, uint32_t last_bucket, account_id_type account )const;
+
+      private:
+         map< uint32_t, flat_map<account_id_type, uint64_t> > _buckets;
+   };
+
+   /**
+    *  @brief This secondary index counts complaints per requester and per datasource so that the complaint
+    *  rankings do not have to walk every complaint in the requested period.
+    *
+    *  @note complaints are never modified after creation
+    */
+   class data_transaction_complain_rank_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override{};
+         virtual void object_modified( const object& after  ) override{};
+
+         account_bucket_counter requesters;
+         account_bucket_counter datasources;
+   };
+
+   /**
+    *  @brief This secondary index counts second hand data records per second hand datasource.
+    *
+    *  @note second hand data records are never modified after creation
+    */
+   class second_hand_data_rank_index : public secondary_index
+   {
+      public:
+         virtual void object_inserted( const object& obj ) override;
+         virtual void object_removed( const object& obj ) override;
+         virtual void about_to_modify( const object& before ) override{};
+         virtual void object_modified( const object& after  ) override{};
+
+         account_bucket_counter datasources;
+   };
+
+} } // graphene::chain
@@ -26,6 +26,7 @@
 #include <boost/multi_index/composite_key.hpp>
 #include <graphene/db/flat_index.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/simple_index.hpp>
 
 /**
  * @defgroup prediction_market Prediction Market
@@ -247,7 +248,7 @@ namespace graphene { namespace chain {
          >
       >
    > asset_object_multi_index_type;
-   typedef generic_index<asset_object, asset_object_multi_index_type> asset_index;
+   typedef generic_index<asset_object, asset_object_multi_index_type, dense_id_lookup> asset_index;
 
 } } // graphene::chain
 
@@ -274,3 +275,6 @@ FC_REFLECT_DERIVED( graphene::chain::asset_object, (graphene::db::object),
                     (bitasset_data_id)
                     (buyback_account)
                   )
+
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::asset_object, graphene::chain::asset_index )
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::asset_dynamic_data_object, graphene::db::simple_index<graphene::chain::asset_dynamic_data_object> )
@@ -24,6 +24,7 @@
 #pragma once
 #include <fstream>
 #include <graphene/chain/protocol/block.hpp>
+#include <graphene/chain/compressed_block_log.hpp>
 
 namespace graphene { namespace chain {
    struct index_entry;
@@ -36,6 +37,15 @@ namespace graphene { namespace chain {
          void flush();
          void close();
 
+         /**
+          *  Keeps only the most recent blocks stored blocks, 0 keeps all of them.  Once twice as many are stored, the files
+          *  are rewritten with the most recent ones.
+          */
+         void     set_prune_window( uint32_t blocks ) { _prune_window = blocks; }
+         uint32_t get_prune_window()const { return _prune_window; }
+         /** @return the oldest block number that can still be contained, older blocks were pruned */
+         uint32_t first_block_num()const;
+
          void store( const block_id_type& id, const signed_block& b );
          void remove( const block_id_type& id );
 
@@ -45,9 +55,31 @@ namespace graphene { namespace chain {
          optional<signed_block> fetch_by_number( uint32_t block_num )const;
          optional<signed_block> last()const;
          optional<block_id_type> last_id()const;
+
+         /**
+          *  Moves the blocks up to last_block_num into the compressed block log, in whole chunks, and rewrites the
+          *  blocks file with the blocks that remain.  Blocks in the compressed log are read from there unless a
+          *  block with the same number is stored again.  Meant to be run on irreversible blocks while no node
+          *  uses the database.
+          *
+          *  @return the last block in the compressed block log
+          */
+         uint32_t archive_blocks( uint32_t last_block_num,
+                                  uint32_t blocks_per_chunk = compressed_block_log::default_blocks_per_chunk );
+         const compressed_block_log& archive()const { return _archive; }
+
       private:
          optional<index_entry> last_index_entry()const;
+         /** @return the position of the index entry of block_num, -1 if it is older than the index */
+         int64_t index_pos( uint32_t block_num )const;
+         /** replaces the files with ones holding the blocks from first_block_num on */
+         void rewrite_files( uint32_t first_block_num );
+         fc::path _dbdir;
          fc::path _index_filename;
+         compressed_block_log _archive;
+         /** block number of the first index entry */
+         uint32_t _index_base = 0;
+         uint32_t _prune_window = 0;
          mutable std::fstream _blocks;
          mutable std::fstream _block_num_to_pos;
    };
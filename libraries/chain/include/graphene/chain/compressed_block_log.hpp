@@ -0,0 +1,109 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/block.hpp>
+
+#include <fstream>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace graphene { namespace chain {
+
+   /**
+    *  @brief Stores irreversible blocks in compressed chunks of consecutive block numbers
+    *
+    *  Every chunk holds the same number of blocks and is deflated on its own with a dictionary built from sample
+    *  blocks when the log is created, so that any block can be read by decompressing only its chunk.  The ids of
+    *  all blocks are kept uncompressed, which answers contains() and fetch_block_id() without decompressing.
+    *  Recently decompressed chunks are kept in a small LRU cache for sequential reads.
+    *
+    *  The log only grows by whole chunks and is written by block_database::archive_blocks().
+    */
+   class compressed_block_log
+   {
+      public:
+         static const uint32_t default_blocks_per_chunk = 256;
+         static const uint32_t default_cache_size = 16;
+         /** largest dictionary zlib makes use of */
+         static const uint32_t max_dictionary_size = 32 * 1024;
+
+         /** opens the log in dbdir, the log is empty if it was never created there */
+         void open( const fc::path& dbdir, uint32_t cache_size = default_cache_size );
+         bool is_open()const { return _chunks.is_open(); }
+         void flush();
+         void close();
+
+         /**
+          *  Starts an empty log whose first block is first_block_num, with a dictionary built from samples.
+          *  Fails when the log already holds blocks.
+          */
+         void create( uint32_t first_block_num, uint32_t blocks_per_chunk, const vector<signed_block>& samples );
+         /** appends blocks_per_chunk() consecutive blocks starting at last_block_num() + 1 */
+         void append_chunk( const vector<signed_block>& blocks );
+
+         bool     empty()const { return _chunk_index.empty(); }
+         /** @return the first block of the log, 0 if it was not created */
+         uint32_t first_block_num()const { return _first_block_num; }
+         /** @return the last block of the log, first_block_num() - 1 if it is empty */
+         uint32_t last_block_num()const { return _first_block_num + _chunk_index.size() * _blocks_per_chunk - 1; }
+         uint32_t blocks_per_chunk()const { return _blocks_per_chunk; }
+         bool     contains_block_num( uint32_t block_num )const
+         { return !empty() && block_num >= _first_block_num && block_num <= last_block_num(); }
+
+         bool                    contains( const block_id_type& id )const;
+         optional<block_id_type> fetch_block_id( uint32_t block_num )const;
+         optional<signed_block>  fetch_optional( const block_id_type& id )const;
+         optional<signed_block>  fetch_by_number( uint32_t block_num )const;
+
+      private:
+         struct chunk_index_entry
+         {
+            uint64_t chunk_pos = 0;
+            uint32_t chunk_size = 0;
+            uint32_t decoded_size = 0;
+         };
+         /** the packed blocks of a chunk, each preceded by its size */
+         struct decoded_chunk
+         {
+            vector<char>     data;
+            vector<uint32_t> block_offsets;
+         };
+         typedef std::list< std::pair< uint32_t, std::shared_ptr<const decoded_chunk> > > cache_list;
+
+         std::shared_ptr<const decoded_chunk> get_chunk( uint32_t chunk_num )const;
+         std::shared_ptr<const decoded_chunk> decode_chunk( uint32_t chunk_num )const;
+
+         fc::path                   _dbdir;
+         uint32_t                   _first_block_num = 0;
+         uint32_t                   _blocks_per_chunk = default_blocks_per_chunk;
+         vector<char>               _dictionary;
+         vector<chunk_index_entry>  _chunk_index;
+
+         mutable std::fstream       _chunks;
+         mutable std::fstream       _block_ids;
+         std::fstream               _chunk_index_file;
+
+         uint32_t                   _cache_size = default_cache_size;
+         mutable cache_list         _cache;
+         mutable std::unordered_map< uint32_t, cache_list::iterator > _cached_chunks;
+   };
+
+} } // graphene::chain
@@ -5,6 +5,7 @@
 #include <graphene/chain/database.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <graphene/db/object.hpp>
+#include <graphene/db/pool_allocator.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <softfloat.hpp>
 
@@ -59,6 +60,8 @@ class key_value_object : public graphene::db::abstract_object<key_value_object>
     static const uint8_t space_id = implementation_ids;
     static const uint8_t type_id = impl_key_value_object_type;
 
+    GRAPHENE_POOLED_OBJECT( key_value_object )
+
     typedef uint64_t key_type;
     static const int number_of_keys = 1;
 
@@ -79,7 +82,8 @@ using key_value_multi_index_type = multi_index_container<
         >,
         composite_key_compare< std::less<table_id>, std::less<uint64_t> >
      >
-  >
+  >,
+  pool_allocator<key_value_object>
 >;
 typedef generic_index<key_value_object, key_value_multi_index_type> key_value_index;
 
@@ -95,6 +99,8 @@ struct secondary_index {
       static const uint8_t space_id = implementation_ids;
       static const uint8_t type_id  = ObjectTypeId;
 
+      GRAPHENE_POOLED_OBJECT( index_object )
+
       table_id      t_id;
       uint64_t      primary_key;
       account_name  payer = 0;
@@ -120,7 +126,8 @@ struct secondary_index {
                >,
                composite_key_compare<std::less<table_id>, SecondaryKeyLess, std::less<uint64_t>>
             >
-        >
+        >,
+        pool_allocator<index_object>
     >;
     typedef generic_index<index_object, index_multi_index_type> index_index;
 
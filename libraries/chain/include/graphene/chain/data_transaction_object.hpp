@@ -26,6 +26,7 @@
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/generic_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
 #include <vector>
 namespace graphene {
     namespace chain {
@@ -64,13 +65,46 @@ namespace graphene {
             account_id_type                         requester;
             fc::optional<league_id_type>            league_id = fc::optional<league_id_type>();
             string                                  memo;
-            vector<data_transaction_datasource_status_object>             datasources_status;
             // product fee
             uint64_t                                product_pay = 0;
             // Data transaction fee
             uint64_t                                transaction_fee = 0;
             // commission
             uint64_t                                commission = 0;
+
+            data_transaction_id_type get_id()const { return id; }
+
+            /** @return the state of datasource in this data transaction, or nullptr if it is not a datasource of it */
+            const data_transaction_datasource_state_object* find_datasource_state(const database& db, account_id_type datasource)const;
+            /** @return the status of every datasource of this data transaction, ordered by datasource account */
+            vector<data_transaction_datasource_status_object> get_datasources_status(const database& db)const;
+        };
+
+        /**
+         * A data transaction together with the status of its datasources, as returned by the API.  The chain keeps
+         * the statuses in data_transaction_datasource_state_object.
+         */
+        struct data_transaction_api_object : public data_transaction_object {
+            data_transaction_api_object() = default;
+            data_transaction_api_object(const data_transaction_object& obj, const database& db)
+                : data_transaction_object(obj), datasources_status(obj.get_datasources_status(db)) {}
+
+            vector<data_transaction_datasource_status_object>             datasources_status;
+        };
+
+        /**
+         * Status of one datasource of a data transaction.  It is kept apart from data_transaction_object so that
+         * an acknowledgement only saves undo state for this small object instead of the whole data transaction.
+         */
+        class data_transaction_datasource_state_object : public graphene::db::abstract_object<data_transaction_datasource_state_object> {
+        public:
+            static const uint8_t space_id = implementation_ids;
+            static const uint8_t type_id = impl_data_transaction_datasource_state_object_type;
+
+            data_transaction_id_type                data_transaction;
+            account_id_type                         datasource;
+            //value is in enum data_transaction_datasource_status
+            uint8_t                                 status = 0;
         };
 
         // data_transaction_object sort function
@@ -86,7 +120,7 @@ namespace graphene {
             static const uint8_t type_id = impl_data_transaction_search_results_object_type;
 
             uint64_t total = 0;
-            vector <data_transaction_object> data;
+            vector <data_transaction_api_object> data;
         };
 
         class data_transaction_complain_object : public graphene::db::abstract_object<data_transaction_complain_object>{
@@ -115,14 +149,7 @@ namespace graphene {
                 ordered_non_unique< tag<by_requester>,
                         member<data_transaction_object, account_id_type, &data_transaction_object::requester>
                 >,
-                ordered_unique< tag<by_request_id>,
-                    composite_key<
-                        data_transaction_object,
-                        member<data_transaction_object, string, &data_transaction_object::request_id>,
-                        member<data_transaction_object, time_point_sec, &data_transaction_object::create_date_time>
-                    >,
-                    composite_key_compare<std::less<string>, std::less<time_point_sec>>
-                >
+                hashed_unique< tag<by_request_id>, member<data_transaction_object, string, &data_transaction_object::request_id> >
              >
         >;
         /**
@@ -130,13 +157,32 @@ namespace graphene {
          */
         using data_transaction_index = generic_index<data_transaction_object, data_transaction_multi_index_type>;
 
+        struct by_data_transaction_datasource {};
+        using data_transaction_datasource_state_multi_index_type = multi_index_container<
+            data_transaction_datasource_state_object,
+            indexed_by<
+                ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
+                ordered_unique< tag<by_data_transaction_datasource>,
+                    composite_key<
+                        data_transaction_datasource_state_object,
+                        member<data_transaction_datasource_state_object, data_transaction_id_type, &data_transaction_datasource_state_object::data_transaction>,
+                        member<data_transaction_datasource_state_object, account_id_type, &data_transaction_datasource_state_object::datasource>
+                    >
+                >
+            >
+        >;
+        /**
+         * @ingroup object_index
+         */
+        using data_transaction_datasource_state_index = generic_index<data_transaction_datasource_state_object, data_transaction_datasource_state_multi_index_type>;
+
 
         using data_transaction_complain_multi_index_type = multi_index_container<
             data_transaction_complain_object,
             indexed_by<
                 ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
                 ordered_non_unique< tag< by_create_date_time >, member< data_transaction_complain_object, time_point_sec, &data_transaction_complain_object::create_date_time > >,
-                ordered_unique< tag<by_request_id>, member<data_transaction_complain_object, string, &data_transaction_complain_object::data_transaction_request_id> >
+                hashed_unique< tag<by_request_id>, member<data_transaction_complain_object, string, &data_transaction_complain_object::data_transaction_request_id> >
                 >
             >;
 
@@ -171,11 +217,21 @@ FC_REFLECT_DERIVED(graphene::chain::data_transaction_object,
                    (requester)
                    (league_id)
                    (memo)
-                   (datasources_status)
                    (product_pay)
                    (transaction_fee)
                    (commission))
+FC_REFLECT_DERIVED(graphene::chain::data_transaction_api_object,
+                   (graphene::chain::data_transaction_object),
+                   (datasources_status))
+FC_REFLECT_DERIVED(graphene::chain::data_transaction_datasource_state_object,
+                   (graphene::db::object),
+                   (data_transaction)
+                   (datasource)
+                   (status))
 FC_REFLECT_DERIVED(graphene::chain::data_transaction_search_results_object,
                    (graphene::db::object),
                    (total)
                    (data))
+
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::data_transaction_object, graphene::chain::data_transaction_index )
+GRAPHENE_DEFINE_TYPED_INDEX( graphene::chain::data_transaction_datasource_state_object, graphene::chain::data_transaction_datasource_state_index )
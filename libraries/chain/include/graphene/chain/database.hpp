@@ -31,6 +31,8 @@
 #include <graphene/chain/genesis_state.hpp>
 #include <graphene/chain/evaluator.hpp>
 #include <graphene/chain/wasm_interface.hpp>
+#include <graphene/chain/transaction_verifier.hpp>
+#include <graphene/chain/execution_profiler.hpp>
 
 #include <graphene/db/object_database.hpp>
 #include <graphene/db/object.hpp>
@@ -143,6 +145,25 @@ namespace graphene { namespace chain {
          void set_max_trx_cpu_time(int32_t max_trx_cpu_time) { _max_trx_cpu_time = max_trx_cpu_time; }
          const int32_t  get_max_trx_cpu_time() { return _max_trx_cpu_time; };
 
+         /**
+          *  Verifies the signatures and authorities of the transactions of a pushed block on count threads before
+          *  applying them, 0 verifies each transaction when it is applied.
+          */
+         void     set_transaction_verify_threads( uint32_t count );
+         uint32_t get_transaction_verify_threads()const;
+
+         /**
+          *  Keeps only the most recent blocks in the block database, at least GRAPHENE_MAX_UNDO_HISTORY of them so that
+          *  forks can still be switched, 0 keeps all blocks.  A pruned database can't be replayed from genesis.
+          */
+         void     set_block_log_prune_window( uint32_t blocks );
+         /** @return the oldest block number that can be in the block database, older blocks were pruned */
+         uint32_t get_first_stored_block_num()const { return _block_id_to_block.first_block_num(); }
+
+         /** latency histograms of operations, contract actions and block phases, disabled by default */
+         execution_profiler&       get_execution_profiler()       { return _execution_profiler; }
+         const execution_profiler& get_execution_profiler()const  { return _execution_profiler; }
+
          bool push_block( const signed_block& b, uint32_t skip = skip_nothing );
          processed_transaction push_transaction( const signed_transaction& trx, uint32_t skip = skip_nothing );
          bool _push_block( const signed_block& b );
@@ -386,7 +407,8 @@ namespace graphene { namespace chain {
        public:
          // these were formerly private, but they have a fairly well-defined API, so let's make them public
          void                  apply_block( const signed_block& next_block, uint32_t skip = skip_nothing );
-         processed_transaction apply_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing, const vector<operation_result> &operation_results = {});
+         processed_transaction apply_transaction(const signed_transaction &trx, uint32_t skip = skip_nothing, const vector<operation_result> &operation_results = {},
+                                                 bool authority_verified = false);
          operation_result      apply_operation(transaction_evaluation_state &eval_state, const operation &op, uint32_t billed_cpu_time_us = 0);
 
        // set and get current trx
@@ -400,7 +422,8 @@ namespace graphene { namespace chain {
 
        private:
          void                  _apply_block( const signed_block& next_block );
-         processed_transaction _apply_transaction(const signed_transaction &trx, const vector<operation_result> &operation_results = {});
+         processed_transaction _apply_transaction(const signed_transaction &trx, const vector<operation_result> &operation_results = {},
+                                                  bool authority_verified = false);
 
          ///Steps involved in applying a new block
          ///@{
@@ -437,6 +460,15 @@ namespace graphene { namespace chain {
          ///@}
 
          vector< processed_transaction >        _pending_tx;
+         /**
+          *  Set while _pending_tx_session holds exactly _pending_tx applied in order on the head block, so that
+          *  _generate_block can take the processed transactions instead of applying them again.  The flags, size
+          *  and cpu time are accumulated over the transactions pushed into the session.
+          */
+         bool                                   _pending_tx_reusable = false;
+         uint32_t                               _pending_tx_skip_flags = 0;
+         uint64_t                               _pending_tx_block_size = 0;
+         uint64_t                               _pending_tx_block_cpu = 0;
          fork_database                          _fork_db;
 
          /**
@@ -473,6 +505,10 @@ namespace graphene { namespace chain {
          // max transaction cpu time, configured by config.ini
          int32_t                           _max_trx_cpu_time;
 
+         std::unique_ptr<transaction_verifier> _transaction_verifier;
+
+         execution_profiler                _execution_profiler;
+
          node_property_object              _node_property_object;
 
          /**
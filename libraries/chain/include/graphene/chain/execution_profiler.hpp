@@ -0,0 +1,175 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/types.hpp>
+
+#include <fc/time.hpp>
+
+#include <array>
+#include <atomic>
+#include <map>
+#include <mutex>
+
+namespace graphene { namespace chain {
+
+   /** the parts of applying a block that are timed on their own */
+   enum profiled_block_phase
+   {
+      block_total,
+      block_header_check,
+      block_signature_verification,
+      block_transactions,
+      block_chain_maintenance,
+      block_clear_expired_transactions,
+      block_clear_expired_proposals,
+      block_clear_expired_signature_objs,
+      block_applied_signal,
+      block_notify_changed_objects,
+      profiled_block_phase_count
+   };
+
+   /** the parts of applying a transaction that are timed on their own, wherever the transaction is applied */
+   enum profiled_transaction_phase
+   {
+      transaction_authority_check,
+      profiled_transaction_phase_count
+   };
+
+   /** counts latencies in buckets of powers of two microseconds, bucket i holds latencies below 2^(i+1) us */
+   struct latency_histogram
+   {
+      static const uint32_t bucket_count = 32;
+
+      uint64_t                              count = 0;
+      uint64_t                              total_us = 0;
+      uint64_t                              max_us = 0;
+      std::array<uint64_t, bucket_count>    buckets{};
+
+      void     record( uint64_t us );
+      /** @return the upper bound of the bucket below which fraction of the latencies fall */
+      uint64_t percentile( double fraction )const;
+   };
+
+   /** the latencies of one operation type, contract action or block phase */
+   struct execution_profile_entry
+   {
+      /** "operation", "contract", "block" or "transaction" */
+      string            category;
+      string            name;
+      uint64_t          count = 0;
+      uint64_t          total_us = 0;
+      uint64_t          max_us = 0;
+      uint64_t          p50_us = 0;
+      uint64_t          p90_us = 0;
+      uint64_t          p99_us = 0;
+      /** latency_histogram::buckets without the trailing empty buckets */
+      vector<uint64_t>  buckets;
+   };
+
+   /**
+    *  @brief Collects latency histograms of operations, contract actions and the phases of applying a block or a
+    *  transaction
+    *
+    *  Transaction phases are recorded whether the transaction is pushed, re-applied to the pending state or applied
+    *  with a block, so they are not part of the block phases.
+    *
+    *  The profiler is disabled by default, then the only cost of a measuring point is checking enabled().
+    *  Samples are recorded by the thread that applies blocks and may be read from any thread.
+    */
+   class execution_profiler
+   {
+      public:
+         bool enabled()const { return _enabled.load( std::memory_order_relaxed ); }
+         void set_enabled( bool enabled ) { _enabled.store( enabled, std::memory_order_relaxed ); }
+         /** drops all samples recorded so far */
+         void reset();
+
+         void record_operation( int which, const fc::microseconds& elapsed );
+         void record_contract( account_id_type contract, const string& action, const fc::microseconds& elapsed );
+         void record_block_phase( profiled_block_phase phase, const fc::microseconds& elapsed );
+         void record_transaction_phase( profiled_transaction_phase phase, const fc::microseconds& elapsed );
+
+         /** @return the measured operation types, contract actions and phases, skipping those never seen */
+         vector<execution_profile_entry> get_profile()const;
+
+         /** logs the profile every interval while enabled, 0 disables logging */
+         void set_log_interval( const fc::microseconds& interval ) { _log_interval = interval; }
+         /** called after each block, logs the profile when the log interval has passed */
+         void log_if_due();
+
+      private:
+         std::atomic<bool>                                         _enabled{ false };
+         mutable std::mutex                                        _mutex;
+         vector<latency_histogram>                                 _operations;
+         std::map< std::pair<account_id_type,string>, latency_histogram > _contracts;
+         std::array<latency_histogram, profiled_block_phase_count> _block_phases;
+         std::array<latency_histogram, profiled_transaction_phase_count> _transaction_phases;
+
+         fc::microseconds                                          _log_interval;
+         fc::time_point                                            _last_log;
+   };
+
+   /** records the time until it is destroyed as a block phase, if the profiler was enabled when it was created */
+   class scoped_phase_timer
+   {
+      public:
+         scoped_phase_timer( execution_profiler& profiler, profiled_block_phase phase )
+            : _profiler( profiler ), _phase( phase )
+         {
+            if( profiler.enabled() )
+               _start = fc::time_point::now();
+         }
+         ~scoped_phase_timer() { stop(); }
+
+         /** records the phase now instead of on destruction */
+         void stop()
+         {
+            if( _start != fc::time_point() )
+               _profiler.record_block_phase( _phase, fc::time_point::now() - _start );
+            _start = fc::time_point();
+         }
+
+      private:
+         execution_profiler&   _profiler;
+         profiled_block_phase  _phase;
+         fc::time_point        _start;
+   };
+
+} } // graphene::chain
+
+FC_REFLECT_ENUM( graphene::chain::profiled_block_phase,
+                 (block_total)
+                 (block_header_check)
+                 (block_signature_verification)
+                 (block_transactions)
+                 (block_chain_maintenance)
+                 (block_clear_expired_transactions)
+                 (block_clear_expired_proposals)
+                 (block_clear_expired_signature_objs)
+                 (block_applied_signal)
+                 (block_notify_changed_objects)
+                 (profiled_block_phase_count) )
+
+FC_REFLECT_ENUM( graphene::chain::profiled_transaction_phase,
+                 (transaction_authority_check)
+                 (profiled_transaction_phase_count) )
+
+FC_REFLECT( graphene::chain::execution_profile_entry,
+            (category)(name)(count)(total_us)(max_us)(p50_us)(p90_us)(p99_us)(buckets) )
@@ -24,6 +24,7 @@
 #pragma once
 #include <graphene/chain/protocol/operations.hpp>
 #include <graphene/db/object.hpp>
+#include <graphene/db/pool_allocator.hpp>
 #include <boost/multi_index/composite_key.hpp>
 
 namespace graphene { namespace chain {
@@ -49,6 +50,8 @@ namespace graphene { namespace chain {
          static const uint8_t space_id = protocol_ids;
          static const uint8_t type_id  = operation_history_object_type;
 
+         GRAPHENE_POOLED_OBJECT( operation_history_object )
+
          operation_history_object( const operation& o ):op(o){}
          operation_history_object(){}
 
@@ -105,7 +108,8 @@ namespace graphene { namespace chain {
       operation_history_object,
       indexed_by<
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >
-      >
+      >,
+      pool_allocator<operation_history_object>
    > operation_history_multi_index_type;
 
    typedef generic_index<operation_history_object, operation_history_multi_index_type> operation_history_index;
@@ -48,6 +48,7 @@
 #include <graphene/chain/protocol/address.hpp>
 #include <graphene/chain/protocol/name.hpp>
 #include <graphene/db/object_id.hpp>
+#include <graphene/db/json_writer.hpp>
 #include <graphene/chain/protocol/config.hpp>
 
 #define SECONDS_PER_DAY 86400 //seconds of a day
@@ -323,7 +324,8 @@ namespace graphene { namespace chain {
       //impl_search_results_object_type
       impl_signature_object_type, //22
       impl_table_id_object_type, //23
-      impl_key_value_object_type //24
+      impl_key_value_object_type, //24
+      impl_data_transaction_datasource_state_object_type //25
    };
 
    //typedef fc::unsigned_int            object_id_type;
@@ -349,6 +351,7 @@ namespace graphene { namespace chain {
    class league_object;
    class data_transaction_object;
    class data_transaction_search_results_object;
+   class data_transaction_datasource_state_object;
    class personal_auth_object;
    class pocs_object;
    class datasource_copyright_object;
@@ -430,6 +433,7 @@ namespace graphene { namespace chain {
    typedef object_id< implementation_ids, impl_signature_object_type, signature_object>      signature_id_type;
    typedef object_id< implementation_ids, impl_table_id_object_type, table_id_object>        table_id_object_id_type;
    typedef object_id< implementation_ids, impl_key_value_object_type, key_value_object>      key_value_object_id_type;
+   typedef object_id< implementation_ids, impl_data_transaction_datasource_state_object_type, data_transaction_datasource_state_object> data_transaction_datasource_state_id_type;
 
 
    //typedef object_id< implementation_ids, impl_search_results_object_type,search_results_object<DerivedClass>>          search_results_id_type;
@@ -525,6 +529,13 @@ FC_REFLECT( graphene::chain::extended_public_key_type::binary_key, (check)(data)
 FC_REFLECT( graphene::chain::extended_private_key_type, (key_data) )
 FC_REFLECT( graphene::chain::extended_private_key_type::binary_key, (check)(data) )
 
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::public_key_type )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::extended_public_key_type )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::extended_private_key_type )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::address )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::pts_address )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::name )
+
 FC_REFLECT_ENUM( graphene::chain::data_market_type_enum,
                  (free_data_market)
                  (league_data_market)
@@ -590,6 +601,7 @@ FC_REFLECT_ENUM( graphene::chain::impl_object_type,
                  (impl_signature_object_type)
                  (impl_table_id_object_type)
                  (impl_key_value_object_type)
+                 (impl_data_transaction_datasource_state_object_type)
                )
 
 FC_REFLECT_TYPENAME( graphene::chain::share_type )
@@ -638,6 +650,7 @@ FC_REFLECT_TYPENAME( graphene::chain::data_transaction_complain_id_type)
 FC_REFLECT_TYPENAME( graphene::chain::lock_balance_id_type)
 FC_REFLECT_TYPENAME( graphene::chain::signature_id_type)
 FC_REFLECT_TYPENAME( graphene::chain::table_id_object_id_type)
+FC_REFLECT_TYPENAME( graphene::chain::data_transaction_datasource_state_id_type)
 FC_REFLECT_TYPENAME( graphene::chain::key_value_object_id_type)
 
 FC_REFLECT(graphene::chain::void_t, )
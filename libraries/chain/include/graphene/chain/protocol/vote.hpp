@@ -31,6 +31,8 @@
 #include <fc/container/flat.hpp>
 #include <fc/reflect/reflect.hpp>
 
+#include <graphene/db/json_writer.hpp>
+
 namespace graphene { namespace chain {
 
 /**
@@ -150,3 +152,4 @@ FC_REFLECT_TYPENAME( fc::flat_set<graphene::chain::vote_id_type> )
 
 FC_REFLECT_ENUM( graphene::chain::vote_id_type::vote_type, (witness)(committee)(worker)(VOTE_TYPE_COUNT) )
 FC_REFLECT( graphene::chain::vote_id_type, (content) )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::vote_id_type )
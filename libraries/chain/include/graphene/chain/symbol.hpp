@@ -184,3 +184,6 @@ namespace fc {
 FC_REFLECT(graphene::chain::symbol_code, (value))
 FC_REFLECT(graphene::chain::symbol, (m_value))
 FC_REFLECT(graphene::chain::extended_symbol, (sym)(contract))
+
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::symbol_code )
+GRAPHENE_JSON_USES_VARIANT( graphene::chain::symbol )
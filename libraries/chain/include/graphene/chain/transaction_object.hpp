@@ -27,6 +27,7 @@
 #include <graphene/chain/protocol/transaction.hpp>
 #include <graphene/db/index.hpp>
 #include <graphene/db/generic_index.hpp>
+#include <graphene/db/pool_allocator.hpp>
 #include <fc/uint128.hpp>
 
 #include <boost/multi_index_container.hpp>
@@ -50,6 +51,8 @@ namespace graphene { namespace chain {
          static const uint8_t space_id = implementation_ids;
          static const uint8_t type_id  = impl_transaction_object_type;
 
+         GRAPHENE_POOLED_OBJECT( transaction_object )
+
          signed_transaction  trx;
          transaction_id_type trx_id;
 
@@ -65,7 +68,8 @@ namespace graphene { namespace chain {
          ordered_unique< tag<by_id>, member< object, object_id_type, &object::id > >,
          hashed_unique< tag<by_trx_id>, BOOST_MULTI_INDEX_MEMBER(transaction_object, transaction_id_type, trx_id), std::hash<transaction_id_type> >,
          ordered_non_unique< tag<by_expiration>, const_mem_fun<transaction_object, time_point_sec, &transaction_object::get_expiration > >
-      >
+      >,
+      pool_allocator<transaction_object>
    > transaction_multi_index_type;
 
    typedef generic_index<transaction_object, transaction_multi_index_type> transaction_index;
@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/chain/protocol/block.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <memory>
+
+namespace graphene { namespace chain {
+
+   class database;
+
+   /**
+    *  The accounts whose authorities a transaction depends on, and the accounts whose authorities its operations
+    *  may change.
+    */
+   struct transaction_footprint
+   {
+      /** accounts read while verifying the authorities of the transaction */
+      flat_set<account_id_type> authority_reads;
+      /** accounts whose owner or active authority the operations may update */
+      flat_set<account_id_type> authority_writes;
+      /** set when an operation may change the authority of any account, e.g. by executing a proposal */
+      bool                      writes_any_authority = false;
+   };
+
+   /** @return the accounts whose authorities the operations of trx may change */
+   transaction_footprint get_authority_write_footprint( const transaction& trx );
+
+   /**
+    *  @brief Verifies the signatures and authorities of the transactions of a block in parallel
+    *
+    *  Signature keys are recovered and authorities are checked against the state before the block on the verifier
+    *  threads.  A result is only used when no earlier transaction of the block may change an authority the check
+    *  read, so that the check would have succeeded in block order as well.  All other transactions are verified
+    *  when they are applied, as before, and still find their signature keys recovered.
+    */
+   class transaction_verifier
+   {
+      public:
+         explicit transaction_verifier( uint32_t thread_count );
+         ~transaction_verifier();
+
+         uint32_t thread_count()const { return _threads.size(); }
+
+         /** @return for every transaction of block, true when its authorities are verified */
+         vector<bool> verify_block( const database& db, const signed_block& block );
+
+      private:
+         vector< std::unique_ptr<fc::thread> > _threads;
+   };
+
+} } // graphene::chain
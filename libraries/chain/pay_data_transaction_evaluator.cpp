@@ -106,11 +106,9 @@ void_result pay_data_transaction_evaluator::do_evaluate( const pay_data_transact
 
    // datasource status must be "uploaded"
    const data_transaction_object& dto = *maybe_found;
-   auto iter = std::find_if(dto.datasources_status.begin(), dto.datasources_status.end(),
-           [&](const data_transaction_datasource_status_object& status_obj) {
-               return status_obj.datasource == op.to && status_obj.status == data_transaction_datasource_status_uploaded;
-           });
-   FC_ASSERT(iter != dto.datasources_status.end(), "datasource ${d} not found or status not uploaded", ("d", op.to));
+   const auto* state = dto.find_datasource_state(_db, op.to);
+   FC_ASSERT(state != nullptr && state->status == data_transaction_datasource_status_uploaded,
+             "datasource ${d} not found or status not uploaded", ("d", op.to));
    FC_ASSERT(_db.find_object(dto.product_id) != nullptr, "product not found, product_id ${p}", ("p", dto.product_id));
 
    // pay amount must equal product price;
@@ -218,17 +216,12 @@ operation_result pay_data_transaction_evaluator::do_apply(const pay_data_transac
    _db.adjust_balance(commission_account, asset(commission_amount - reserved_cut));
    // dlog("commission amount ${c}, reserve_cut ${r}, commission_account ${a}", ("c", commission_amount.value)("r", reserved_cut.value)("a", commission_account));
 
-   // update data_transaction object "payed" status
-   // update data_transaction_object datasource_list
-   _db.modify(dto, [&](data_transaction_object& obj) {
-           for (auto& status_obj : obj.datasources_status) {
-               if (status_obj.datasource == op.to)
-                   status_obj.status = data_transaction_datasource_status_payed;
-           }
-           // obj.product_pay += op.amount.amount.value;
-           // obj.commission += commission_amount.value;
-           // obj.transaction_fee += transaction_fee;
-           });
+   // update data_transaction datasource "payed" status
+   if (const auto* state = dto.find_datasource_state(_db, op.to)) {
+       _db.modify(*state, [&](data_transaction_datasource_state_object& obj) {
+               obj.status = data_transaction_datasource_status_payed;
+               });
+   }
 
    // pocs statistics
    if (dto.league_id.valid()) {
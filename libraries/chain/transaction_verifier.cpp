@@ -0,0 +1,128 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/transaction_verifier.hpp>
+#include <graphene/chain/database.hpp>
+
+#include <fc/thread/future.hpp>
+
+#include <algorithm>
+#include <future>
+
+namespace graphene { namespace chain {
+
+transaction_footprint get_authority_write_footprint( const transaction& trx )
+{
+   transaction_footprint result;
+   for( const auto& op : trx.operations )
+   {
+      if( op.which() == operation::tag<account_update_operation>::value )
+         result.authority_writes.insert( op.get<account_update_operation>().account );
+      // approving a proposal may execute any operation
+      else if( op.which() == operation::tag<proposal_update_operation>::value )
+         result.writes_any_authority = true;
+   }
+   return result;
+}
+
+transaction_verifier::transaction_verifier( uint32_t thread_count )
+{
+   for( uint32_t i = 0; i < thread_count; ++i )
+      _threads.emplace_back( new fc::thread( "transaction_verifier_" + fc::to_string( uint64_t(i) ) ) );
+}
+
+transaction_verifier::~transaction_verifier()
+{
+   for( auto& thread : _threads )
+      thread->quit();
+}
+
+vector<bool> transaction_verifier::verify_block( const database& db, const signed_block& block )
+{
+   const auto& trxs = block.transactions;
+   vector<bool> verified( trxs.size(), false );
+   if( trxs.empty() )
+      return verified;
+
+   const chain_id_type& chain_id = db.get_chain_id();
+   const uint32_t max_depth = db.get_global_properties().parameters.max_authority_depth;
+   vector<transaction_footprint> footprints( trxs.size() );
+   // one byte per transaction, threads write to distinct elements
+   vector<char> passed( trxs.size(), 0 );
+
+   // only reads the database, which is not modified until the transactions are applied
+   auto verify_range = [&]( size_t begin, size_t end ) {
+      for( size_t i = begin; i < end; ++i )
+      {
+         auto& reads = footprints[i].authority_reads;
+         auto get_active = [&]( account_id_type id ) { reads.insert( id ); return &id(db).active; };
+         auto get_owner  = [&]( account_id_type id ) { reads.insert( id ); return &id(db).owner;  };
+         try {
+            trxs[i].verify_authority( chain_id, get_active, get_owner, max_depth );
+            passed[i] = 1;
+         } catch( ... ) {
+            // verified again when applied, which reports the error
+         }
+      }
+   };
+
+   const size_t chunks = _threads.size() + 1;
+   const size_t chunk_size = ( trxs.size() + chunks - 1 ) / chunks;
+   // waiting on an fc::future would yield the calling fc thread, which could then push transactions or
+   // generate a block in the middle of applying this one; std::future blocks the thread instead
+   vector< std::future<void> > running;
+   for( size_t t = 0; t < _threads.size(); ++t )
+   {
+      const size_t begin = ( t + 1 ) * chunk_size;
+      if( begin >= trxs.size() )
+         break;
+      const size_t end = std::min( begin + chunk_size, trxs.size() );
+      auto done = std::make_shared< std::promise<void> >();
+      running.push_back( done->get_future() );
+      _threads[t]->async( [&verify_range,begin,end,done]() {
+         try {
+            verify_range( begin, end );
+            done->set_value();
+         } catch( ... ) {
+            done->set_exception( std::current_exception() );
+         }
+      }, "verify_transactions" );
+   }
+   verify_range( 0, std::min( chunk_size, trxs.size() ) );
+   for( auto& f : running )
+      f.get();
+
+   // a check holds in block order when no earlier transaction may change an authority it read
+   flat_set<account_id_type> written;
+   bool any_written = false;
+   for( size_t i = 0; i < trxs.size(); ++i )
+   {
+      if( passed[i] && !any_written )
+      {
+         const auto& reads = footprints[i].authority_reads;
+         verified[i] = std::none_of( reads.begin(), reads.end(),
+                                     [&written]( account_id_type id ) { return written.find( id ) != written.end(); } );
+      }
+      const auto writes = get_authority_write_footprint( trxs[i] );
+      any_written |= writes.writes_any_authority;
+      written.insert( writes.authority_writes.begin(), writes.authority_writes.end() );
+   }
+   return verified;
+}
+
+} } // graphene::chain
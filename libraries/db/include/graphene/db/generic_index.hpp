@@ -34,23 +34,36 @@ namespace graphene { namespace chain {
    using namespace boost::multi_index;
 
    struct by_id{};
+
+   /** objects are found by id through the by_id index of the container */
+   struct ordered_id_lookup {};
+   /**
+    *  objects are found by id through a vector indexed by instance number, which costs one pointer per
+    *  instance ever allocated.  Use it for indexes whose objects are rarely removed.
+    */
+   struct dense_id_lookup {};
+
    /**
     *  Almost all objects can be tracked and managed via a boost::multi_index container that uses
     *  an unordered_unique key on the object ID.  This template class adapts the generic index interface
     *  to work with arbitrary boost multi_index containers on the same type.
     */
-   template<typename ObjectType, typename MultiIndexType>
+   template<typename ObjectType, typename MultiIndexType, typename IdLookup = ordered_id_lookup>
    class generic_index : public index
    {
       public:
          typedef MultiIndexType index_type;
          typedef ObjectType     object_type;
 
+         static constexpr bool dense_ids = std::is_same<IdLookup, dense_id_lookup>::value;
+
          virtual const object& insert( object&& obj )override
          {
             assert( nullptr != dynamic_cast<ObjectType*>(&obj) );
             auto insert_result = _indices.insert( std::move( static_cast<ObjectType&>(obj) ) );
             FC_ASSERT( insert_result.second, "Could not insert object, most likely a uniqueness constraint was violated" );
+            if( dense_ids )
+               dense_insert( *insert_result.first );
             return *insert_result.first;
          }
 
@@ -62,14 +75,24 @@ namespace graphene { namespace chain {
             auto insert_result = _indices.insert( std::move(item) );
             FC_ASSERT(insert_result.second, "Could not create object! Most likely a uniqueness constraint is violated.");
             use_next_id();
+            if( dense_ids )
+               dense_insert( *insert_result.first );
             return *insert_result.first;
          }
 
          virtual void modify( const object& obj, const std::function<void(object&)>& m )override
          {
             assert(nullptr != dynamic_cast<const ObjectType*>(&obj));
+            modify_typed( static_cast<const ObjectType&>(obj), m );
+         }
+
+         /** modify without type erasure of m, which must be callable with ObjectType& */
+         template<typename Lambda>
+         void modify_typed( const ObjectType& obj, const Lambda& m )
+         {
+            const object_id_type id = obj.id;
             std::exception_ptr exc;
-            auto ok = _indices.modify(_indices.iterator_to(static_cast<const ObjectType&>(obj)),
+            auto ok = _indices.modify(_indices.iterator_to(obj),
                                        [&m, &exc](ObjectType& o) mutable {
                                           try {
                                              m(o);
@@ -83,6 +106,9 @@ namespace graphene { namespace chain {
                                           }
                                        }
                       );
+            // a failed modify has erased and freed the object
+            if( !ok && dense_ids )
+               dense_remove( id );
             if (exc)
                 std::rethrow_exception(exc);
             FC_ASSERT(ok, "Could not modify object, most likely an index constraint was violated");
@@ -90,13 +116,25 @@ namespace graphene { namespace chain {
 
          virtual void remove( const object& obj )override
          {
+            if( dense_ids )
+               dense_remove( obj.id );
             _indices.erase( _indices.iterator_to( static_cast<const ObjectType&>(obj) ) );
          }
 
          virtual const object* find( object_id_type id )const override
+         {
+            return find_typed( id );
+         }
+
+         const ObjectType* find_typed( object_id_type id )const
          {
             static_assert(std::is_same<typename MultiIndexType::key_type, object_id_type>::value,
                           "First index of MultiIndexType MUST be object_id_type!");
+            if( dense_ids )
+            {
+               const auto instance = id.instance();
+               return instance < _dense.size() ? _dense[instance] : nullptr;
+            }
             auto itr = _indices.find( id );
             if( itr == _indices.end() ) return nullptr;
             return &*itr;
@@ -122,9 +160,31 @@ namespace graphene { namespace chain {
             return result;
          }
 
+         /** @return the memory held by the dense id table, 0 with ordered_id_lookup */
+         size_t dense_table_bytes()const { return _dense.capacity() * sizeof( const ObjectType* ); }
+
       private:
+         void dense_insert( const ObjectType& obj )
+         {
+            const auto instance = obj.id.instance();
+            if( instance >= _dense.size() )
+               _dense.resize( instance + 1, nullptr );
+            _dense[instance] = &obj;
+         }
+
+         void dense_remove( object_id_type id )
+         {
+            const auto instance = id.instance();
+            if( instance < _dense.size() )
+               _dense[instance] = nullptr;
+            while( !_dense.empty() && _dense.back() == nullptr )
+               _dense.pop_back();
+         }
+
          fc::uint128 _current_hash;
          index_type  _indices;
+         /** multi_index nodes never move, so the table points into _indices, only used with dense_id_lookup */
+         vector<const ObjectType*> _dense;
    };
 
    /**
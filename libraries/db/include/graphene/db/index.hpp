@@ -302,9 +302,29 @@ namespace graphene { namespace db {
             DerivedIndex::modify( obj, m );
             for( const auto& item : _sindex )
                item->object_modified( obj );
-            on_modify( obj );
+            if( !_observers.empty() )
+               on_modify( obj );
          }
 
+         /**
+          *  Non-virtual modify used by object_database for object types registered with
+          *  GRAPHENE_DEFINE_TYPED_INDEX, m is passed down to the derived index without type erasure.
+          */
+         template<typename Lambda>
+         void modify_typed( const object_type& obj, const Lambda& m )
+         {
+            save_undo( obj );
+            for( const auto& item : _sindex )
+               item->about_to_modify( obj );
+            DerivedIndex::modify_typed( obj, m );
+            for( const auto& item : _sindex )
+               item->object_modified( obj );
+            if( !_observers.empty() )
+               on_modify( obj );
+         }
+
+         const object_type* find_typed( object_id_type id )const { return DerivedIndex::find_typed( id ); }
+
          virtual void add_observer( const shared_ptr<index_observer>& o ) override
          {
             _observers.emplace_back( o );
@@ -332,4 +352,29 @@ namespace graphene { namespace db {
          object_id_type _next_id;
    };
 
+   /**
+    *  Maps an object type to the type of its primary index, so that object_database can reach the index of
+    *  registered types without virtual calls.  Unregistered types map to void and use the virtual index interface.
+    *
+    *  @see GRAPHENE_DEFINE_TYPED_INDEX
+    */
+   template<typename ObjectType>
+   struct typed_index
+   {
+      typedef void type;
+   };
+
+   template<typename ObjectType>
+   struct has_typed_index : std::integral_constant<bool, !std::is_void<typename typed_index<ObjectType>::type>::value> {};
+
 } } // graphene::db
+
+/**
+ *  Registers primary_index<INDEX> as the index of OBJECT, must be used in the global namespace and only for
+ *  indexes derived from generic_index or simple_index.  object_database::add_index checks that the index
+ *  added for OBJECT is the registered one.
+ */
+#define GRAPHENE_DEFINE_TYPED_INDEX( OBJECT, INDEX ) \
+   namespace graphene { namespace db { \
+      template<> struct typed_index< OBJECT > { typedef primary_index< INDEX > type; }; \
+   } }
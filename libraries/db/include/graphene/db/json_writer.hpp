@@ -0,0 +1,315 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <graphene/db/object_id.hpp>
+
+#include <fc/container/flat.hpp>
+#include <fc/io/json.hpp>
+#include <fc/optional.hpp>
+#include <fc/reflect/reflect.hpp>
+#include <fc/reflect/variant.hpp>
+#include <fc/safe.hpp>
+#include <fc/static_variant.hpp>
+#include <fc/variant.hpp>
+
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphene { namespace db {
+
+   /**
+    *  True for reflected types that have their own fc::to_variant, which the json_writer must go through
+    *  instead of writing the reflected members.  Declare such types with GRAPHENE_JSON_USES_VARIANT next to
+    *  their to_variant.
+    */
+   template<typename T>
+   struct json_uses_variant : std::false_type {};
+
+   template<typename T, typename Enable = void>
+   struct json_serializer;
+
+   /**
+    *  @class json_writer
+    *  @brief Writes FC_REFLECTed values as JSON straight into a string
+    *
+    *  The output is identical to fc::json::to_string( fc::variant( value, max_depth ) ): reflected structs,
+    *  containers, optionals, static variants, ids, integers and plain strings are written directly, every
+    *  other type is converted through its fc::variant.
+    */
+   class json_writer
+   {
+      public:
+         explicit json_writer( std::string& out, uint32_t max_depth = MAX_NESTING_DEPTH )
+         :_out(out),_max_depth(max_depth){}
+
+         static const uint32_t MAX_NESTING_DEPTH = 200;
+
+         template<typename T>
+         void write( const T& value ) { json_serializer<T>::write( *this, value ); }
+
+         void write_null() { _out += "null"; }
+         void write_bool( bool b ) { _out += b ? "true" : "false"; }
+         void write_int( int64_t i );
+         void write_uint( uint64_t u );
+         void write_string( const std::string& s );
+         void write_variant( const fc::variant& v );
+
+         /** writes s, which must be valid JSON */
+         void write_raw( const char* s ) { _out += s; }
+         void write_raw( char c ) { _out += c; }
+         void write_raw( const std::string& s ) { _out += s; }
+
+         uint32_t max_depth()const { return _max_depth; }
+
+      private:
+         std::string& _out;
+         uint32_t     _max_depth;
+   };
+
+   /** @return value serialized to JSON, identical to fc::json::to_string( fc::variant( value, max_depth ) ) */
+   template<typename T>
+   std::string to_json( const T& value, uint32_t max_depth = json_writer::MAX_NESTING_DEPTH )
+   {
+      std::string result;
+      json_writer writer( result, max_depth );
+      writer.write( value );
+      return result;
+   }
+
+   namespace detail {
+
+      template<typename T>
+      struct json_member_visitor
+      {
+         json_member_visitor( json_writer& w, const T& v ):writer(w),value(v){}
+
+         template<typename Member, class Class, Member (Class::*member)>
+         void operator()( const char* name )const { add( name, value.*member ); }
+
+         // like fc's to_variant_visitor, unset optional members are left out
+         template<typename M>
+         void add( const char* name, const fc::optional<M>& m )const
+         {
+            if( m.valid() )
+               add( name, *m );
+         }
+         template<typename M>
+         void add( const char* name, const M& m )const
+         {
+            if( !first )
+               writer.write_raw( ',' );
+            first = false;
+            writer.write_raw( '"' );
+            writer.write_raw( name );
+            writer.write_raw( "\":" );
+            writer.write( m );
+         }
+
+         json_writer&  writer;
+         const T&      value;
+         mutable bool  first = true;
+      };
+
+      struct json_static_variant_visitor
+      {
+         typedef void result_type;
+
+         explicit json_static_variant_visitor( json_writer& w ):writer(w){}
+
+         template<typename T>
+         void operator()( const T& v )const { writer.write( v ); }
+
+         json_writer& writer;
+      };
+
+      template<typename Container>
+      void write_json_array( json_writer& w, const Container& c )
+      {
+         w.write_raw( '[' );
+         bool first = true;
+         for( const auto& item : c )
+         {
+            if( !first )
+               w.write_raw( ',' );
+            first = false;
+            w.write( item );
+         }
+         w.write_raw( ']' );
+      }
+
+      /** reflected types written by their own json_serializer below */
+      template<typename T>
+      struct json_dedicated : std::false_type {};
+      template<typename T>
+      struct json_dedicated< fc::safe<T> > : std::true_type {};
+      template<uint8_t SpaceID, uint8_t TypeID, typename T>
+      struct json_dedicated< object_id<SpaceID,TypeID,T> > : std::true_type {};
+      template<>
+      struct json_dedicated< object_id_type > : std::true_type {};
+
+      template<typename T>
+      struct json_direct_struct : std::integral_constant< bool,
+            fc::reflector<T>::is_defined::value && !fc::reflector<T>::is_enum::value
+            && !json_uses_variant<T>::value && !json_dedicated<T>::value > {};
+
+   } // detail
+
+   /** every type without a direct writer goes through fc::variant */
+   template<typename T, typename Enable>
+   struct json_serializer
+   {
+      static void write( json_writer& w, const T& v ) { w.write_variant( fc::variant( v, w.max_depth() ) ); }
+   };
+
+   template<typename T>
+   struct json_serializer< T, typename std::enable_if< detail::json_direct_struct<T>::value >::type >
+   {
+      static void write( json_writer& w, const T& v )
+      {
+         w.write_raw( '{' );
+         fc::reflector<T>::visit( detail::json_member_visitor<T>( w, v ) );
+         w.write_raw( '}' );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer< T, typename std::enable_if< std::is_integral<T>::value && std::is_signed<T>::value
+                                                       && !std::is_same<T,char>::value >::type >
+   {
+      static void write( json_writer& w, T v ) { w.write_int( v ); }
+   };
+
+   template<typename T>
+   struct json_serializer< T, typename std::enable_if< std::is_integral<T>::value && std::is_unsigned<T>::value
+                                                       && !std::is_same<T,bool>::value && !std::is_same<T,char>::value >::type >
+   {
+      static void write( json_writer& w, T v ) { w.write_uint( v ); }
+   };
+
+   template<>
+   struct json_serializer<bool>
+   {
+      static void write( json_writer& w, bool v ) { w.write_bool( v ); }
+   };
+
+   template<>
+   struct json_serializer<std::string>
+   {
+      static void write( json_writer& w, const std::string& v ) { w.write_string( v ); }
+   };
+
+   template<>
+   struct json_serializer<fc::variant>
+   {
+      static void write( json_writer& w, const fc::variant& v ) { w.write_variant( v ); }
+   };
+
+   template<>
+   struct json_serializer<object_id_type>
+   {
+      static void write( json_writer& w, const object_id_type& v ) { w.write_string( std::string( v ) ); }
+   };
+
+   template<uint8_t SpaceID, uint8_t TypeID, typename T>
+   struct json_serializer< object_id<SpaceID,TypeID,T> >
+   {
+      static void write( json_writer& w, const object_id<SpaceID,TypeID,T>& v )
+      {
+         w.write_raw( '"' );
+         w.write_raw( std::to_string( uint32_t(SpaceID) ) );
+         w.write_raw( '.' );
+         w.write_raw( std::to_string( uint32_t(TypeID) ) );
+         w.write_raw( '.' );
+         w.write_raw( std::to_string( uint64_t(v.instance.value) ) );
+         w.write_raw( '"' );
+      }
+   };
+
+   template<typename T>
+   struct json_serializer< fc::safe<T> >
+   {
+      static void write( json_writer& w, const fc::safe<T>& v ) { w.write( v.value ); }
+   };
+
+   template<typename T>
+   struct json_serializer< fc::optional<T> >
+   {
+      static void write( json_writer& w, const fc::optional<T>& v )
+      {
+         if( v.valid() )
+            w.write( *v );
+         else
+            w.write_null();
+      }
+   };
+
+   template<typename A, typename B>
+   struct json_serializer< std::pair<A,B> >
+   {
+      static void write( json_writer& w, const std::pair<A,B>& v )
+      {
+         w.write_raw( '[' );
+         w.write( v.first );
+         w.write_raw( ',' );
+         w.write( v.second );
+         w.write_raw( ']' );
+      }
+   };
+
+   /** vector<char> is written as hex by fc */
+   template<typename T>
+   struct json_serializer< std::vector<T>, typename std::enable_if< !std::is_same<T,char>::value >::type >
+   {
+      static void write( json_writer& w, const std::vector<T>& v ) { detail::write_json_array( w, v ); }
+   };
+
+   template<typename T, typename... A>
+   struct json_serializer< boost::container::flat_set<T, A...> >
+   {
+      static void write( json_writer& w, const boost::container::flat_set<T, A...>& v ) { detail::write_json_array( w, v ); }
+   };
+
+   template<typename T, typename... A>
+   struct json_serializer< std::set<T, A...> >
+   {
+      static void write( json_writer& w, const std::set<T, A...>& v ) { detail::write_json_array( w, v ); }
+   };
+
+   template<typename... T>
+   struct json_serializer< fc::static_variant<T...> >
+   {
+      static void write( json_writer& w, const fc::static_variant<T...>& v )
+      {
+         w.write_raw( '[' );
+         w.write_int( v.which() );
+         w.write_raw( ',' );
+         detail::json_static_variant_visitor visitor( w );
+         v.visit( visitor );
+         w.write_raw( ']' );
+      }
+   };
+
+} } // graphene::db
+
+#define GRAPHENE_JSON_USES_VARIANT( TYPE ) \
+   namespace graphene { namespace db { template<> struct json_uses_variant< TYPE > : std::true_type {}; } }
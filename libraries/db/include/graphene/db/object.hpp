@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <graphene/db/object_id.hpp>
+#include <graphene/db/json_writer.hpp>
 #include <fc/io/raw.hpp>
 #include <fc/crypto/city.hpp>
 #include <fc/uint128.hpp>
@@ -76,6 +77,8 @@ namespace graphene { namespace db {
          virtual unique_ptr<object> clone()const = 0;
          virtual void               move_from( object& obj ) = 0;
          virtual variant            to_variant()const  = 0;
+         /** @return the JSON of to_variant(), written without building the variant */
+         virtual std::string        to_json()const = 0;
          virtual vector<char>       pack()const = 0;
          virtual fc::uint128        hash()const = 0;
    };
@@ -101,6 +104,7 @@ namespace graphene { namespace db {
             static_cast<DerivedClass&>(*this) = std::move( static_cast<DerivedClass&>(obj) );
          }
          virtual variant to_variant()const { return variant( static_cast<const DerivedClass&>(*this), MAX_NESTING ); }
+         virtual std::string to_json()const { return graphene::db::to_json( static_cast<const DerivedClass&>(*this), MAX_NESTING ); }
          virtual vector<char> pack()const  { return fc::raw::pack( static_cast<const DerivedClass&>(*this) ); }
          virtual fc::uint128  hash()const  {  
              auto tmp = this->pack();
@@ -25,6 +25,7 @@
 #include <graphene/db/object.hpp>
 #include <graphene/db/index.hpp>
 #include <graphene/db/undo_database.hpp>
+#include <graphene/db/state_lock.hpp>
 
 #include <fc/log/logger.hpp>
 
@@ -88,7 +89,7 @@ namespace graphene { namespace db {
          void          remove( const object& obj ) { get_mutable_index(obj.id).remove( obj ); }
          template<typename T, typename Lambda>
          void modify( const T& obj, const Lambda& m ) {
-            get_mutable_index(obj.id).modify(obj,m);
+            modify( obj, m, has_typed_index<T>() );
          }
 
          ///@}
@@ -109,16 +110,14 @@ namespace graphene { namespace db {
          template<typename T>
          const T& get( object_id_type id )const
          {
-            const object& obj = get_object( id );
-            assert( nullptr != dynamic_cast<const T*>(&obj) );
-            return static_cast<const T&>(obj);
+            const T* obj = find<T>( id );
+            FC_ASSERT( obj != nullptr, "Unable to find Object ${id}", ("id", id) );
+            return *obj;
          }
          template<typename T>
          const T* find( object_id_type id )const
          {
-            const object* obj = find_object( id );
-            assert(  !obj || nullptr != dynamic_cast<const T*>(obj) );
-            return static_cast<const T*>(obj);
+            return find( id, static_cast<const T*>(nullptr), has_typed_index<T>() );
          }
 
          template<uint8_t SpaceID, uint8_t TypeID, typename T>
@@ -131,6 +130,8 @@ namespace graphene { namespace db {
          IndexType* add_index()
          {
             typedef typename IndexType::object_type ObjectType;
+            static_assert( !has_typed_index<ObjectType>::value || std::is_same<typename typed_index<ObjectType>::type, IndexType>::value,
+                           "IndexType is not the index registered for its object type by GRAPHENE_DEFINE_TYPED_INDEX" );
             if( _index[ObjectType::space_id].size() <= ObjectType::type_id  )
                 _index[ObjectType::space_id].resize( 255 );
             assert(!_index[ObjectType::space_id][ObjectType::type_id]);
@@ -149,6 +150,9 @@ namespace graphene { namespace db {
 
          fc::path get_data_dir()const { return _data_dir; }
 
+         /** taken exclusively by the entry points that modify the state, and shared by readers on other threads */
+         state_lock& get_state_lock()const { return _state_lock; }
+
          /** public for testing purposes only... should be private in practice. */
          undo_database                          _undo_db;
      protected:
@@ -163,6 +167,42 @@ namespace graphene { namespace db {
          index& get_mutable_index(uint8_t space_id, uint8_t type_id);
 
      private:
+         /** @return the index of T, which is registered with GRAPHENE_DEFINE_TYPED_INDEX */
+         template<typename T>
+         typename typed_index<T>::type& get_typed_index()const
+         {
+            const auto& space = _index[T::space_id];
+            FC_ASSERT( T::type_id < space.size() && space[T::type_id], "No index for ${space}.${type}",
+                       ("space", T::space_id)("type", T::type_id) );
+            return static_cast<typename typed_index<T>::type&>( *space[T::type_id] );
+         }
+
+         template<typename T, typename Lambda>
+         void modify( const T& obj, const Lambda& m, std::true_type )
+         {
+            assert( obj.id.space() == T::space_id && obj.id.type() == T::type_id );
+            get_typed_index<T>().modify_typed( obj, m );
+         }
+         template<typename T, typename Lambda>
+         void modify( const T& obj, const Lambda& m, std::false_type )
+         {
+            get_mutable_index(obj.id).modify(obj,m);
+         }
+
+         template<typename T>
+         const T* find( object_id_type id, const T*, std::true_type )const
+         {
+            if( id.space() != T::space_id || id.type() != T::type_id )
+               return find( id, static_cast<const T*>(nullptr), std::false_type() );
+            return get_typed_index<T>().find_typed( id );
+         }
+         template<typename T>
+         const T* find( object_id_type id, const T*, std::false_type )const
+         {
+            const object* obj = find_object( id );
+            assert(  !obj || nullptr != dynamic_cast<const T*>(obj) );
+            return static_cast<const T*>(obj);
+         }
 
          friend class base_primary_index;
          friend class undo_database;
@@ -172,6 +212,7 @@ namespace graphene { namespace db {
 
          fc::path                                                  _data_dir;
          vector< vector< unique_ptr<index> > >                     _index;
+         mutable state_lock                                        _state_lock;
    };
 
 } } // graphene::db
@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <boost/pool/singleton_pool.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace graphene { namespace db {
+
+   /**
+    *  Supplies the chunks the object pools carve into nodes.  When built with GRAPHENE_DB_HUGE_PAGES, chunks of
+    *  2 MiB and more are aligned and advised to be backed by transparent huge pages.
+    */
+   struct pool_chunk_allocator
+   {
+      typedef std::size_t    size_type;
+      typedef std::ptrdiff_t difference_type;
+
+      static char* malloc( const size_type bytes );
+      static void  free( char* const block );
+   };
+
+   struct object_pool_tag {};
+
+   /**
+    *  A free list of blocks of Size bytes shared by every pool_allocator and pooled object of that size.
+    *
+    *  The pools are not synchronized: objects of the pooled indexes must only be created, cloned and destroyed
+    *  on the thread that modifies the database.
+    */
+   template<std::size_t Size>
+   using object_pool = boost::singleton_pool< object_pool_tag, ( Size + 15 ) & ~std::size_t(15), pool_chunk_allocator,
+                                              boost::details::pool::null_mutex >;
+
+#ifdef GRAPHENE_DB_POOL_ALLOCATOR
+
+   /**
+    *  @class pool_allocator
+    *  @brief Allocates single multi_index_container nodes from the object_pool of the node size
+    *
+    *  Arrays, such as the bucket arrays of hashed indices, still come from the heap.
+    */
+   template<typename T>
+   class pool_allocator
+   {
+      public:
+         typedef T              value_type;
+         typedef T*             pointer;
+         typedef const T*       const_pointer;
+         typedef T&             reference;
+         typedef const T&       const_reference;
+         typedef std::size_t    size_type;
+         typedef std::ptrdiff_t difference_type;
+
+         template<typename U>
+         struct rebind { typedef pool_allocator<U> other; };
+
+         pool_allocator(){}
+         template<typename U>
+         pool_allocator( const pool_allocator<U>& ){}
+
+         pointer allocate( size_type n, const void* = nullptr )
+         {
+            if( n != 1 )
+               return std::allocator<T>().allocate( n );
+            void* result = object_pool<sizeof(T)>::malloc();
+            if( result == nullptr )
+               throw std::bad_alloc();
+            return static_cast<pointer>( result );
+         }
+
+         void deallocate( pointer p, size_type n )
+         {
+            if( n != 1 )
+               std::allocator<T>().deallocate( p, n );
+            else
+               object_pool<sizeof(T)>::free( p );
+         }
+
+         template<typename U, typename... Args>
+         void construct( U* p, Args&&... args ) { ::new( static_cast<void*>(p) ) U( std::forward<Args>(args)... ); }
+         template<typename U>
+         void destroy( U* p ) { p->~U(); }
+
+         size_type max_size()const { return std::allocator<T>().max_size(); }
+         pointer address( reference r )const { return std::addressof( r ); }
+         const_pointer address( const_reference r )const { return std::addressof( r ); }
+   };
+
+   template<typename T, typename U>
+   bool operator==( const pool_allocator<T>&, const pool_allocator<U>& ) { return true; }
+   template<typename T, typename U>
+   bool operator!=( const pool_allocator<T>&, const pool_allocator<U>& ) { return false; }
+
+   /** allocates CLASS, and so its undo copies made by clone(), from the object_pool of its size */
+   #define GRAPHENE_POOLED_OBJECT( CLASS ) \
+      static void* operator new( std::size_t size ) \
+      { \
+         if( size != sizeof(CLASS) ) return ::operator new( size ); \
+         void* result = graphene::db::object_pool<sizeof(CLASS)>::malloc(); \
+         if( result == nullptr ) throw std::bad_alloc(); \
+         return result; \
+      } \
+      static void operator delete( void* p, std::size_t size ) \
+      { \
+         if( size != sizeof(CLASS) ) ::operator delete( p ); \
+         else graphene::db::object_pool<sizeof(CLASS)>::free( p ); \
+      }
+
+#else
+
+   template<typename T>
+   using pool_allocator = std::allocator<T>;
+
+   #define GRAPHENE_POOLED_OBJECT( CLASS )
+
+#endif
+
+} } // graphene::db
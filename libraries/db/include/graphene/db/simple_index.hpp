@@ -59,6 +59,14 @@ namespace graphene { namespace db {
             modify_callback( *_objects[obj.id.instance()] );
          }
 
+         /** modify without type erasure of modify_callback, which must be callable with T& */
+         template<typename Lambda>
+         void modify_typed( const T& obj, const Lambda& modify_callback )
+         {
+            assert( obj.id.instance() < _objects.size() );
+            modify_callback( static_cast<T&>( *_objects[obj.id.instance()] ) );
+         }
+
          virtual const object& insert( object&& obj )override
          {
             auto instance = obj.id.instance();
@@ -79,13 +87,18 @@ namespace graphene { namespace db {
          }
 
          virtual const object* find( object_id_type id )const override
+         {
+            return find_typed( id );
+         }
+
+         const T* find_typed( object_id_type id )const
          {
             assert( id.space() == T::space_id );
             assert( id.type() == T::type_id );
 
             const auto instance = id.instance();
             if( instance >= _objects.size() ) return nullptr;
-            return _objects[instance].get();
+            return static_cast<const T*>( _objects[instance].get() );
          }
 
          virtual void inspect_all_objects(std::function<void (const object&)> inspector)const override
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace graphene { namespace db {
+
+   /**
+    *  @class state_lock
+    *  @brief Hands the object state over between the thread that modifies it and threads that only read it
+    *
+    *  The writer is exclusive and may re-enter from its thread, so that nested write entry points
+    *  (generate_block calls push_block) lock once.  A waiting writer blocks new readers, so block application
+    *  waits only for the reads already in progress and is never starved by a steady stream of API calls.
+    */
+   class state_lock
+   {
+      public:
+         void lock();
+         void unlock();
+
+         void lock_shared();
+         void unlock_shared();
+
+         /** true while some thread holds or waits for the write lock */
+         bool writer_active()const;
+         /** true if the calling thread holds the write lock */
+         bool owns_write_lock()const;
+
+         class write_guard
+         {
+            public:
+               explicit write_guard( state_lock& l ):_lock(l) { _lock.lock(); }
+               ~write_guard() { _lock.unlock(); }
+               write_guard( const write_guard& ) = delete;
+               write_guard& operator=( const write_guard& ) = delete;
+            private:
+               state_lock& _lock;
+         };
+
+         class read_guard
+         {
+            public:
+               explicit read_guard( state_lock& l ):_lock(l) { _lock.lock_shared(); }
+               ~read_guard() { _lock.unlock_shared(); }
+               read_guard( const read_guard& ) = delete;
+               read_guard& operator=( const read_guard& ) = delete;
+            private:
+               state_lock& _lock;
+         };
+
+      private:
+         mutable std::mutex      _mutex;
+         std::condition_variable _cond;
+         uint32_t                _readers = 0;
+         uint32_t                _waiting_writers = 0;
+         uint32_t                _write_depth = 0;
+         std::thread::id         _writer;
+   };
+
+} } // graphene::db
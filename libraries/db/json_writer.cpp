@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/db/json_writer.hpp>
+
+namespace graphene { namespace db {
+
+const uint32_t json_writer::MAX_NESTING_DEPTH;
+
+void json_writer::write_int( int64_t i )
+{
+   // fc::json stringifies integers beyond 32 bits; how it treats large negative ones depends on the fc version
+   if( i < -int64_t(0xffffffff) )
+   {
+      write_variant( fc::variant( i ) );
+      return;
+   }
+   if( i > int64_t(0xffffffff) )
+   {
+      _out += '"';
+      _out += std::to_string( i );
+      _out += '"';
+      return;
+   }
+   _out += std::to_string( i );
+}
+
+void json_writer::write_uint( uint64_t u )
+{
+   if( u > 0xffffffff )
+   {
+      _out += '"';
+      _out += std::to_string( u );
+      _out += '"';
+      return;
+   }
+   _out += std::to_string( u );
+}
+
+void json_writer::write_string( const std::string& s )
+{
+   // strings that need no escaping are copied, escaping is left to fc::json
+   for( char c : s )
+   {
+      const unsigned char u = c;
+      if( u < 0x20 || u >= 0x7f || c == '"' || c == '\\' )
+      {
+         write_variant( fc::variant( s ) );
+         return;
+      }
+   }
+   _out.reserve( _out.size() + s.size() + 2 );
+   _out += '"';
+   _out += s;
+   _out += '"';
+}
+
+void json_writer::write_variant( const fc::variant& v )
+{
+   _out += fc::json::to_string( v );
+}
+
+} } // graphene::db
@@ -53,19 +53,15 @@ const object& object_database::get_object( object_id_type id )const
 
 const index& object_database::get_index(uint8_t space_id, uint8_t type_id)const
 {
-   FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
-   FC_ASSERT( _index[space_id].size() > type_id, "", ("space_id",space_id)("type_id",type_id)("index[space_id].size",_index[space_id].size()) );
-   const auto& tmp = _index[space_id][type_id];
-   FC_ASSERT( tmp );
-   return *tmp;
+   FC_ASSERT( _index.size() > space_id && _index[space_id].size() > type_id && _index[space_id][type_id],
+              "No index for ${space_id}.${type_id}", ("space_id",space_id)("type_id",type_id) );
+   return *_index[space_id][type_id];
 }
 index& object_database::get_mutable_index(uint8_t space_id, uint8_t type_id)
 {
-   FC_ASSERT( _index.size() > space_id, "", ("space_id",space_id)("type_id",type_id)("index.size",_index.size()) );
-   FC_ASSERT( _index[space_id].size() > type_id , "", ("space_id",space_id)("type_id",type_id)("index[space_id].size",_index[space_id].size()) );
-   const auto& idx = _index[space_id][type_id];
-   FC_ASSERT(idx, "idx null, ${space}, ${type_id}", ("space", space_id)("type", type_id));
-   return *idx;
+   FC_ASSERT( _index.size() > space_id && _index[space_id].size() > type_id && _index[space_id][type_id],
+              "No index for ${space_id}.${type_id}", ("space_id",space_id)("type_id",type_id) );
+   return *_index[space_id][type_id];
 }
 
 void object_database::flush()
@@ -0,0 +1,50 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/db/pool_allocator.hpp>
+
+#include <cstdlib>
+
+#if defined(GRAPHENE_DB_HUGE_PAGES) && defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace graphene { namespace db {
+
+char* pool_chunk_allocator::malloc( const size_type bytes )
+{
+#if defined(GRAPHENE_DB_HUGE_PAGES) && defined(__linux__)
+   const size_type huge_page_size = 2 * 1024 * 1024;
+   if( bytes >= huge_page_size )
+   {
+      void* block = nullptr;
+      if( posix_memalign( &block, huge_page_size, bytes ) != 0 )
+         return nullptr;
+      madvise( block, bytes - bytes % huge_page_size, MADV_HUGEPAGE );
+      return static_cast<char*>( block );
+   }
+#endif
+   return static_cast<char*>( std::malloc( bytes ) );
+}
+
+void pool_chunk_allocator::free( char* const block )
+{
+   std::free( block );
+}
+
+} } // graphene::db
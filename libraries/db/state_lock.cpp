@@ -0,0 +1,75 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/db/state_lock.hpp>
+
+namespace graphene { namespace db {
+
+void state_lock::lock()
+{
+   const auto self = std::this_thread::get_id();
+   std::unique_lock<std::mutex> guard( _mutex );
+   if( _write_depth > 0 && _writer == self )
+   {
+      ++_write_depth;
+      return;
+   }
+   ++_waiting_writers;
+   _cond.wait( guard, [this]() { return _readers == 0 && _write_depth == 0; } );
+   --_waiting_writers;
+   _write_depth = 1;
+   _writer = self;
+}
+
+void state_lock::unlock()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   if( --_write_depth == 0 )
+   {
+      _writer = std::thread::id();
+      _cond.notify_all();
+   }
+}
+
+void state_lock::lock_shared()
+{
+   std::unique_lock<std::mutex> guard( _mutex );
+   _cond.wait( guard, [this]() { return _write_depth == 0 && _waiting_writers == 0; } );
+   ++_readers;
+}
+
+void state_lock::unlock_shared()
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   if( --_readers == 0 )
+      _cond.notify_all();
+}
+
+bool state_lock::writer_active()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _write_depth > 0 || _waiting_writers > 0;
+}
+
+bool state_lock::owns_write_lock()const
+{
+   std::lock_guard<std::mutex> guard( _mutex );
+   return _write_depth > 0 && _writer == std::this_thread::get_id();
+}
+
+} } // graphene::db
@@ -23,6 +23,8 @@
  */
 #include <graphene/net/core_messages.hpp>
 
+#include <cstring>
+
 
 namespace graphene { namespace net {
 
@@ -45,6 +47,27 @@ namespace graphene { namespace net {
   const core_message_type_enum check_firewall_reply_message::type            = core_message_type_enum::check_firewall_reply_message_type;
   const core_message_type_enum get_current_connections_request_message::type = core_message_type_enum::get_current_connections_request_message_type;
   const core_message_type_enum get_current_connections_reply_message::type   = core_message_type_enum::get_current_connections_reply_message_type;
+  const core_message_type_enum compact_block_message::type                   = core_message_type_enum::compact_block_message_type;
+  const core_message_type_enum fetch_block_transactions_message::type        = core_message_type_enum::fetch_block_transactions_message_type;
+  const core_message_type_enum block_transactions_message::type              = core_message_type_enum::block_transactions_message_type;
+
+  uint64_t short_transaction_id( const transaction_id_type& id )
+  {
+    uint64_t result;
+    memcpy( &result, id.data(), sizeof(result) );
+    return result;
+  }
+
+  compact_block_message::compact_block_message( const signed_block& block, const block_id_type& block_id,
+                                                const item_hash_t& block_message_hash ) :
+    header(block),
+    block_id(block_id),
+    block_message_hash(block_message_hash)
+  {
+    transactions.reserve( block.transactions.size() );
+    for( const auto& trx : block.transactions )
+      transactions.push_back( compact_block_transaction{ short_transaction_id( trx.id() ), trx.operation_results } );
+  }
 
 } } // graphene::net
 
@@ -37,6 +37,12 @@
  * 2MiB
  */
 #define MAX_MESSAGE_SIZE                                     1024*1024*2
+
+/**
+ * Messages smaller than this are sent uncompressed to peers that accept compressed messages,
+ * compressing them saves less than it costs
+ */
+#define GRAPHENE_NET_MIN_COMPRESSED_MESSAGE_SIZE             256
 #define GRAPHENE_NET_DEFAULT_PEER_CONNECTION_RETRY_TIME      30 // seconds
 
 /**
@@ -71,6 +77,11 @@
  */
 #define GRAPHENE_NET_MESSAGE_CACHE_DURATION_IN_BLOCKS        5
 
+/**
+ * The number of compact blocks from one peer that may wait for missing transactions at the same time
+ */
+#define GRAPHENE_NET_MAX_COMPACT_BLOCKS_AWAITING_TRANSACTIONS 4
+
 /**
  * We prevent a peer from offering us a list of blocks which, if we fetched them
  * all, would result in a blockchain that extended into the future.
@@ -84,6 +95,12 @@
 
 #define GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING      200
 
+/**
+ * How many bytes of sync blocks may wait for earlier blocks to arrive.  Beyond that the blocks
+ * furthest ahead are dropped and fetched again later.
+ */
+#define GRAPHENE_NET_MAX_SYNC_BLOCK_BUFFER_SIZE              (128 * 1024 * 1024)
+
 /**
  * During normal operation, how many items will be fetched from each
  * peer at a time.  This will only come into play when the network
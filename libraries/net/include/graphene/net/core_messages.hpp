@@ -44,6 +44,8 @@ namespace graphene { namespace net {
   using graphene::chain::block_id_type;
   using graphene::chain::transaction_id_type;
   using graphene::chain::signed_block;
+  using graphene::chain::signed_block_header;
+  using graphene::chain::operation_result;
 
   typedef fc::ecc::public_key_data node_id_t;
   typedef fc::ripemd160 item_hash_t;
@@ -86,6 +88,10 @@ namespace graphene { namespace net {
     check_firewall_reply_message_type            = 5015,
     get_current_connections_request_message_type = 5016,
     get_current_connections_reply_message_type   = 5017,
+    compact_block_message_type                   = 5018,
+    fetch_block_transactions_message_type        = 5019,
+    block_transactions_message_type              = 5020,
+    compressed_message_type                      = 5021, // unwrapped by message_oriented_connection, never seen by the node
     core_message_type_last                       = 5099
   };
 
@@ -400,6 +406,66 @@ namespace graphene { namespace net {
     std::vector<current_connection_data> current_connections;
   };
 
+  /** @return the first 8 bytes of a transaction id, used to find the transaction in the message cache */
+  uint64_t short_transaction_id( const transaction_id_type& id );
+
+  struct compact_block_transaction
+  {
+    uint64_t                      short_id;
+    std::vector<operation_result> operation_results;
+  };
+
+  struct prefilled_transaction
+  {
+    uint32_t           index;
+    signed_transaction trx;
+  };
+
+  /**
+   * Sent instead of a block_message to peers that announced "compact_blocks" in their hello.  It carries the
+   * header and the short ids and operation results of the transactions, which the peer looks up in the
+   * transaction messages it has cached.  Transactions the peer is not known to have are sent along.
+   */
+  struct compact_block_message
+  {
+    static const core_message_type_enum type;
+
+    compact_block_message() {}
+    compact_block_message( const signed_block& block, const block_id_type& block_id,
+                           const item_hash_t& block_message_hash );
+
+    signed_block_header                    header;
+    block_id_type                          block_id;
+    /** id of the block_message this stands for, i.e. the item that was requested */
+    item_hash_t                            block_message_hash;
+    std::vector<compact_block_transaction> transactions;
+    std::vector<prefilled_transaction>     prefilled_transactions;
+  };
+
+  /** requests the transactions of a compact block the peer could not find */
+  struct fetch_block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type         block_id;
+    std::vector<uint32_t> indices;
+
+    fetch_block_transactions_message() {}
+    fetch_block_transactions_message( const block_id_type& block_id, std::vector<uint32_t> indices ) :
+      block_id(block_id),
+      indices(std::move(indices))
+    {}
+  };
+
+  /** the transactions requested by a fetch_block_transactions_message, in the order of the requested indices */
+  struct block_transactions_message
+  {
+    static const core_message_type_enum type;
+
+    block_id_type                   block_id;
+    std::vector<signed_transaction> transactions;
+  };
+
 
 } } // graphene::net
 
@@ -424,6 +490,10 @@ FC_REFLECT_ENUM( graphene::net::core_message_type_enum,
                  (check_firewall_reply_message_type)
                  (get_current_connections_request_message_type)
                  (get_current_connections_reply_message_type)
+                 (compact_block_message_type)
+                 (fetch_block_transactions_message_type)
+                 (block_transactions_message_type)
+                 (compressed_message_type)
                  (core_message_type_last) )
 
 FC_REFLECT( graphene::net::trx_message, (trx) )
@@ -508,6 +578,11 @@ FC_REFLECT(graphene::net::get_current_connections_reply_message, (upload_rate_on
                                                             (upload_rate_one_hour)
                                                             (download_rate_one_hour)
                                                             (current_connections))
+FC_REFLECT(graphene::net::compact_block_transaction, (short_id)(operation_results))
+FC_REFLECT(graphene::net::prefilled_transaction, (index)(trx))
+FC_REFLECT(graphene::net::compact_block_message, (header)(block_id)(block_message_hash)(transactions)(prefilled_transactions))
+FC_REFLECT(graphene::net::fetch_block_transactions_message, (block_id)(indices))
+FC_REFLECT(graphene::net::block_transactions_message, (block_id)(transactions))
 
 #include <unordered_map>
 #include <fc/crypto/city.hpp>
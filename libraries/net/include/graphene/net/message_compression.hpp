@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#pragma once
+#include <graphene/net/message.hpp>
+
+#include <memory>
+
+struct z_stream_s;
+
+namespace graphene { namespace net {
+
+  /**
+   * The deflate side of a connection's compressed messages.  All messages of a connection go through one stream,
+   * so later messages are compressed against the earlier ones, and each is flushed to a byte boundary so that
+   * the peer can inflate it as soon as it arrives.
+   */
+  class deflate_stream
+  {
+  public:
+    deflate_stream();
+    ~deflate_stream();
+
+    /** appends the compressed data to result */
+    void compress(const char* data, size_t size, std::vector<char>& result);
+  private:
+    std::unique_ptr<z_stream_s> _stream;
+  };
+
+  /** the inflate side of a connection's compressed messages, fed the messages in the order they were deflated */
+  class inflate_stream
+  {
+  public:
+    inflate_stream();
+    ~inflate_stream();
+
+    /** inflates data into result, which must be resized to the expected size */
+    void decompress(const char* data, size_t size, std::vector<char>& result);
+  private:
+    std::unique_ptr<z_stream_s> _stream;
+  };
+
+  /** wraps message_to_compress in a compressed_message whose payload continues stream */
+  message compress_message(deflate_stream& stream, const message& message_to_compress);
+  /** unwraps a compressed_message, throws if it is corrupt or does not continue stream */
+  message decompress_message(inflate_stream& stream, const message& compressed_message);
+
+} } // graphene::net
@@ -23,6 +23,7 @@
  */
 #pragma once
 #include <fc/network/tcp_socket.hpp>
+#include <fc/time.hpp>
 #include <graphene/net/message.hpp>
 
 namespace graphene { namespace net {
@@ -39,6 +40,19 @@ namespace graphene { namespace net {
     virtual void on_connection_closed(message_oriented_connection* originating_connection) = 0;
   };
 
+  /** what compressing the messages of one connection saved and cost */
+  struct message_compression_stats
+  {
+    uint64_t         messages_compressed = 0;
+    uint64_t         bytes_before_compression = 0;
+    uint64_t         bytes_after_compression = 0;
+    fc::microseconds compression_time;
+    uint64_t         messages_decompressed = 0;
+    uint64_t         bytes_before_decompression = 0;
+    uint64_t         bytes_after_decompression = 0;
+    fc::microseconds decompression_time;
+  };
+
   /** uses a secure socket to create a connection that reads and writes a stream of `fc::net::message` objects */
   class message_oriented_connection
   {
@@ -51,10 +65,19 @@ namespace graphene { namespace net {
        void bind(const fc::ip::endpoint& local_endpoint);
        void connect_to(const fc::ip::endpoint& remote_endpoint);
 
-       void send_message(const message& message_to_send);
+       /** with flush_socket false the message may stay buffered until a later message is sent with it true */
+       void send_message(const message& message_to_send, bool flush_socket = true);
        void close_connection();
        void destroy_connection();
 
+       /**
+        * Sends messages of at least min_message_size bytes zlib compressed from now on.  All compressed messages
+        * of a connection share one deflate stream, so later messages are compressed against the earlier ones.
+        * Only call this once the peer announced it accepts compressed messages, they are always accepted here.
+        */
+       void enable_compression(uint32_t min_message_size);
+       message_compression_stats get_compression_stats() const;
+
        uint64_t       get_total_bytes_sent() const;
        uint64_t       get_total_bytes_received() const;
        fc::time_point get_last_message_sent_time() const;
@@ -67,3 +90,12 @@ namespace graphene { namespace net {
   typedef std::shared_ptr<message_oriented_connection> message_oriented_connection_ptr;
 
 } } // graphene::net
+
+FC_REFLECT( graphene::net::message_compression_stats, (messages_compressed)
+                                                      (bytes_before_compression)
+                                                      (bytes_after_compression)
+                                                      (compression_time)
+                                                      (messages_decompressed)
+                                                      (bytes_before_decompression)
+                                                      (bytes_after_decompression)
+                                                      (decompression_time) )
@@ -207,6 +207,8 @@ namespace graphene { namespace net
       fc::optional<fc::time_point_sec> fc_git_revision_unix_timestamp;
       fc::optional<std::string> platform;
       fc::optional<uint32_t> bitness;
+      /** set when the peer announced in its hello that it accepts compact_block_messages */
+      bool             supports_compact_blocks;
 
       // for inbound connections, these fields record what the peer sent us in
       // its hello message.  For outbound, they record what we sent the peer
@@ -262,6 +264,19 @@ namespace graphene { namespace net
 
       uint32_t last_known_fork_block_number;
 
+      /// compact blocks from this peer that wait for the transactions we asked it for
+      /// @{
+      struct partial_compact_block
+      {
+        compact_block_message                         compact_block;
+        std::vector<fc::optional<signed_transaction>> transactions;
+        std::vector<uint32_t>                         requested_indices;
+        uint32_t                                      round_trips = 0;
+        bool                                          requested_all = false; /// set when the transactions we found did not add up to the block
+      };
+      std::map<block_id_type, partial_compact_block> compact_blocks_awaiting_transactions;
+      /// @}
+
       fc::future<void> accept_or_connect_task_done;
 
       firewall_check_state_data *firewall_check_state;
@@ -307,6 +322,8 @@ namespace graphene { namespace net
 
       bool is_transaction_fetching_inhibited() const;
       fc::sha512 get_shared_secret() const;
+      void enable_compression(uint32_t min_message_size);
+      message_compression_stats get_compression_stats() const;
       void clear_old_inventory();
       bool is_inventory_advertised_to_us_list_full_for_transactions() const;
       bool is_inventory_advertised_to_us_list_full() const;
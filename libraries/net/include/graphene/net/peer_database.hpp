@@ -31,6 +31,7 @@
 #include <fc/reflect/variant.hpp>
 #include <fc/exception/exception.hpp>
 #include <fc/io/raw.hpp>
+#include <fc/filesystem.hpp>
 
 namespace graphene { namespace net {
 
@@ -52,10 +53,16 @@ namespace graphene { namespace net {
     uint32_t                          number_of_successful_connection_attempts;
     uint32_t                          number_of_failed_connection_attempts;
     fc::optional<fc::exception>       last_error;
+    uint32_t                          round_trip_delay_ms; ///< smoothed over the time replies of all connections, 0 if never measured
+    uint32_t                          download_rate;       ///< smoothed bytes per second received over past connections
+    uint32_t                          connected_seconds;   ///< total time spent connected to the peer
 
     potential_peer_record() :
       number_of_successful_connection_attempts(0),
-    number_of_failed_connection_attempts(0){}
+    number_of_failed_connection_attempts(0),
+      round_trip_delay_ms(0),
+      download_rate(0),
+      connected_seconds(0){}
 
     potential_peer_record(fc::ip::endpoint endpoint,
                           fc::time_point_sec last_seen_time = fc::time_point_sec(),
@@ -64,8 +71,18 @@ namespace graphene { namespace net {
       last_seen_time(last_seen_time),
       last_connection_disposition(last_connection_disposition),
       number_of_successful_connection_attempts(0),
-      number_of_failed_connection_attempts(0)
+      number_of_failed_connection_attempts(0),
+      round_trip_delay_ms(0),
+      download_rate(0),
+      connected_seconds(0)
     {}  
+
+    /**
+     * Ranks the peer for choosing whom to connect to first: low latency, high throughput and long
+     * uptime raise the score, failed connection attempts lower it.  Peers never measured rank in
+     * the middle so that new addresses still get tried.
+     */
+    int64_t selection_score() const;
   };
 
   namespace detail
@@ -98,7 +115,11 @@ namespace graphene { namespace net {
     peer_database();
     ~peer_database();
 
-    void open(const fc::path& databaseFilename);
+    /**
+     * Opens the binary database, creating it if it does not exist.  If it does not exist and
+     * legacy_json_filename names a peer list in the old JSON format, that list is imported.
+     */
+    void open(const fc::path& databaseFilename, const fc::path& legacy_json_filename = fc::path());
     void close();
     void clear();
 
@@ -119,4 +140,4 @@ namespace graphene { namespace net {
 } } // end namespace graphene::net
 
 FC_REFLECT_ENUM(graphene::net::potential_peer_last_connection_disposition, (never_attempted_to_connect)(last_connection_failed)(last_connection_rejected)(last_connection_handshaking_failed)(last_connection_succeeded))
-FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error) )
+FC_REFLECT(graphene::net::potential_peer_record, (endpoint)(last_seen_time)(last_connection_disposition)(last_connection_attempt_time)(number_of_successful_connection_attempts)(number_of_failed_connection_attempts)(last_error)(round_trip_delay_ms)(download_rate)(connected_seconds) )
@@ -31,6 +31,10 @@ namespace graphene { namespace net {
 /**
  *  Uses ECDH to negotiate a aes key for communicating
  *  with other nodes on the network.
+ *
+ *  Reads decrypt everything the socket has available at once and serve later reads from it.  Writes are
+ *  encrypted into a buffer that is only written to the socket when it is full or on flush(), so several
+ *  messages written before a flush() leave in one socket write.
  */
 class stcp_socket : public virtual fc::iostream
 {
@@ -58,6 +62,7 @@ class stcp_socket : public virtual fc::iostream
     fc::sha512       get_shared_secret() const { return _shared_secret; }
   private:
     void do_key_exchange();
+    void write_buffered_data();
 
     fc::sha512           _shared_secret;
     fc::ecc::private_key _priv_key;
@@ -67,7 +72,10 @@ class stcp_socket : public virtual fc::iostream
     fc::aes_encoder      _send_aes;
     fc::aes_decoder      _recv_aes;
     std::shared_ptr<char> _read_buffer;
+    size_t               _read_buffer_begin; /// first decrypted byte not yet returned by readsome()
+    size_t               _read_buffer_end;
     std::shared_ptr<char> _write_buffer;
+    size_t               _write_buffer_used; /// encrypted bytes waiting for write_buffered_data()
 #ifndef NDEBUG
     bool _read_buffer_in_use;
     bool _write_buffer_in_use;
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2015 Cryptonomex, Inc., and contributors.
+ *
+ * The MIT License
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <graphene/net/message_compression.hpp>
+#include <graphene/net/config.hpp>
+#include <graphene/net/core_messages.hpp>
+
+#include <zlib.h>
+
+#include <cstring>
+
+namespace graphene { namespace net {
+
+  namespace
+  {
+    /**
+     * The payload of a compressed_message: the header of the original message followed by its data,
+     * deflated and flushed to a byte boundary so the peer can inflate it on its own
+     */
+    struct compressed_message_prefix
+    {
+      uint32_t original_msg_type;
+      uint32_t original_size;
+    };
+  }
+
+  deflate_stream::deflate_stream() :
+    _stream(new z_stream())
+  {
+    // blocks are compressed while syncing, favor speed over ratio
+    FC_ASSERT(deflateInit(_stream.get(), Z_BEST_SPEED) == Z_OK, "unable to initialize zlib: ${e}", ("e", _stream->msg ? _stream->msg : ""));
+  }
+
+  deflate_stream::~deflate_stream()
+  {
+    deflateEnd(_stream.get());
+  }
+
+  void deflate_stream::compress(const char* data, size_t size, std::vector<char>& result)
+  {
+    _stream->next_in = (Bytef*)data;
+    _stream->avail_in = (uInt)size;
+    size_t offset = result.size();
+    result.resize(offset + deflateBound(_stream.get(), size) + 16);
+    while (true)
+    {
+      _stream->next_out = (Bytef*)result.data() + offset;
+      _stream->avail_out = (uInt)(result.size() - offset);
+      FC_ASSERT(deflate(_stream.get(), Z_SYNC_FLUSH) == Z_OK, "unable to compress message: ${e}", ("e", _stream->msg ? _stream->msg : ""));
+      offset = result.size() - _stream->avail_out;
+      // a full output buffer might have left part of the flush behind
+      if (_stream->avail_out > 0)
+        break;
+      result.resize(result.size() * 2);
+    }
+    result.resize(offset);
+  }
+
+  inflate_stream::inflate_stream() :
+    _stream(new z_stream())
+  {
+    FC_ASSERT(inflateInit(_stream.get()) == Z_OK, "unable to initialize zlib: ${e}", ("e", _stream->msg ? _stream->msg : ""));
+  }
+
+  inflate_stream::~inflate_stream()
+  {
+    inflateEnd(_stream.get());
+  }
+
+  void inflate_stream::decompress(const char* data, size_t size, std::vector<char>& result)
+  {
+    // one spare byte, so that output beyond the expected size is detected instead of left in the stream
+    size_t expected_size = result.size();
+    result.resize(expected_size + 1);
+    _stream->next_in = (Bytef*)data;
+    _stream->avail_in = (uInt)size;
+    _stream->next_out = (Bytef*)result.data();
+    _stream->avail_out = (uInt)result.size();
+    int status = inflate(_stream.get(), Z_SYNC_FLUSH);
+    FC_ASSERT(status == Z_OK || (status == Z_BUF_ERROR && size == 0),
+              "unable to decompress message: ${e}", ("e", _stream->msg ? _stream->msg : ""));
+    FC_ASSERT(_stream->avail_in == 0 && _stream->avail_out == 1, "compressed message does not match its size");
+    result.resize(expected_size);
+  }
+
+  message compress_message(deflate_stream& stream, const message& message_to_compress)
+  {
+    compressed_message_prefix prefix{message_to_compress.msg_type, message_to_compress.size};
+    message compressed_message;
+    compressed_message.msg_type = core_message_type_enum::compressed_message_type;
+    compressed_message.data.resize(sizeof(prefix));
+    memcpy(compressed_message.data.data(), &prefix, sizeof(prefix));
+    stream.compress(message_to_compress.data.data(), message_to_compress.size, compressed_message.data);
+    compressed_message.size = (uint32_t)compressed_message.data.size();
+    return compressed_message;
+  }
+
+  message decompress_message(inflate_stream& stream, const message& compressed_message)
+  {
+    compressed_message_prefix prefix;
+    FC_ASSERT(compressed_message.size >= sizeof(prefix), "compressed message is too short");
+    memcpy(&prefix, compressed_message.data.data(), sizeof(prefix));
+    FC_ASSERT(prefix.original_size <= MAX_MESSAGE_SIZE, "",
+              ("original_size", prefix.original_size)("MAX_MESSAGE_SIZE", MAX_MESSAGE_SIZE));
+    FC_ASSERT(prefix.original_msg_type != core_message_type_enum::compressed_message_type, "compressed message contains a compressed message");
+
+    message original_message;
+    original_message.msg_type = prefix.original_msg_type;
+    original_message.size = prefix.original_size;
+    original_message.data.resize(prefix.original_size);
+    stream.decompress(compressed_message.data.data() + sizeof(prefix), compressed_message.size - sizeof(prefix),
+                      original_message.data);
+    return original_message;
+  }
+
+} } // graphene::net
@@ -29,8 +29,10 @@
 #include <fc/io/enum_type.hpp>
 
 #include <graphene/net/message_oriented_connection.hpp>
+#include <graphene/net/message_compression.hpp>
 #include <graphene/net/stcp_socket.hpp>
 #include <graphene/net/config.hpp>
+#include <graphene/net/core_messages.hpp>
 
 #ifdef DEFAULT_LOGGER
 # undef DEFAULT_LOGGER
@@ -62,12 +64,19 @@ namespace graphene { namespace net {
 
       bool _send_message_in_progress;
 
+      fc::optional<uint32_t> _min_compressed_message_size; /// set once the peer accepts compressed messages
+      std::unique_ptr<deflate_stream> _deflate_stream;
+      std::unique_ptr<inflate_stream> _inflate_stream;
+      message_compression_stats _compression_stats;
+
 #ifndef NDEBUG
       fc::thread* _thread;
 #endif
 
       void read_loop();
       void start_read_loop();
+      message compress_message(const message& message_to_compress);
+      message decompress_message(const message& compressed_message);
     public:
       fc::tcp_socket& get_socket();
       void accept();
@@ -78,7 +87,7 @@ namespace graphene { namespace net {
                                        message_oriented_connection_delegate* delegate = nullptr);
       ~message_oriented_connection_impl();
 
-      void send_message(const message& message_to_send);
+      void send_message(const message& message_to_send, bool flush_socket);
       void close_connection();
       void destroy_connection();
 
@@ -89,6 +98,9 @@ namespace graphene { namespace net {
       fc::time_point get_last_message_received_time() const;
       fc::time_point get_connection_time() const { return _connected_time; }
       fc::sha512 get_shared_secret() const;
+
+      void enable_compression(uint32_t min_message_size);
+      message_compression_stats get_compression_stats() const;
     };
 
     message_oriented_connection_impl::message_oriented_connection_impl(message_oriented_connection* self,
@@ -177,7 +189,10 @@ namespace graphene { namespace net {
           try
           {
             // message handling errors are warnings...
-            _delegate->on_message(_self, m);
+            if (m.msg_type == core_message_type_enum::compressed_message_type)
+              _delegate->on_message(_self, decompress_message(m));
+            else
+              _delegate->on_message(_self, m);
           }
           /// Dedicated catches needed to distinguish from general fc::exception
           catch ( const fc::canceled_exception& e ) { throw; }
@@ -226,7 +241,7 @@ namespace graphene { namespace net {
         throw *exception_to_rethrow;
     }
 
-    void message_oriented_connection_impl::send_message(const message& message_to_send)
+    void message_oriented_connection_impl::send_message(const message& message_to_send, bool flush_socket)
     {
       VERIFY_CORRECT_THREAD();
 #if 0 // this gets too verbose
@@ -255,21 +270,71 @@ namespace graphene { namespace net {
 
       try
       {
-        size_t size_of_message_and_header = sizeof(message_header) + message_to_send.size;
-        if( message_to_send.size > MAX_MESSAGE_SIZE )
+        std::unique_ptr<message> compressed_message;
+        if (_min_compressed_message_size && message_to_send.size >= *_min_compressed_message_size)
+          compressed_message.reset(new message(compress_message(message_to_send)));
+        const message& message_on_wire = compressed_message ? *compressed_message : message_to_send;
+
+        size_t size_of_message_and_header = sizeof(message_header) + message_on_wire.size;
+        if( message_on_wire.size > MAX_MESSAGE_SIZE )
            elog("Trying to send a message larger than MAX_MESSAGE_SIZE. This probably won't work...");
         //pad the message we send to a multiple of 16 bytes
         size_t size_with_padding = 16 * ((size_of_message_and_header + 15) / 16);
         std::unique_ptr<char[]> padded_message(new char[size_with_padding]);
-        memcpy(padded_message.get(), (char*)&message_to_send, sizeof(message_header));
-        memcpy(padded_message.get() + sizeof(message_header), message_to_send.data.data(), message_to_send.size );
+        memcpy(padded_message.get(), (char*)&message_on_wire, sizeof(message_header));
+        memcpy(padded_message.get() + sizeof(message_header), message_on_wire.data.data(), message_on_wire.size );
         _sock.write(padded_message.get(), size_with_padding);
-        _sock.flush();
+        if (flush_socket)
+          _sock.flush();
         _bytes_sent += size_with_padding;
         _last_message_sent_time = fc::time_point::now();
       } FC_RETHROW_EXCEPTIONS( warn, "unable to send message" );
     }
 
+    message message_oriented_connection_impl::compress_message(const message& message_to_compress)
+    {
+      VERIFY_CORRECT_THREAD();
+      fc::time_point start_time = fc::time_point::now();
+      if (!_deflate_stream)
+        _deflate_stream.reset(new deflate_stream());
+
+      message compressed_message = graphene::net::compress_message(*_deflate_stream, message_to_compress);
+
+      ++_compression_stats.messages_compressed;
+      _compression_stats.bytes_before_compression += message_to_compress.size;
+      _compression_stats.bytes_after_compression += compressed_message.size;
+      _compression_stats.compression_time += fc::time_point::now() - start_time;
+      return compressed_message;
+    }
+
+    message message_oriented_connection_impl::decompress_message(const message& compressed_message)
+    {
+      VERIFY_CORRECT_THREAD();
+      fc::time_point start_time = fc::time_point::now();
+      if (!_inflate_stream)
+        _inflate_stream.reset(new inflate_stream());
+
+      message original_message = graphene::net::decompress_message(*_inflate_stream, compressed_message);
+
+      ++_compression_stats.messages_decompressed;
+      _compression_stats.bytes_before_decompression += compressed_message.size;
+      _compression_stats.bytes_after_decompression += original_message.size;
+      _compression_stats.decompression_time += fc::time_point::now() - start_time;
+      return original_message;
+    }
+
+    void message_oriented_connection_impl::enable_compression(uint32_t min_message_size)
+    {
+      VERIFY_CORRECT_THREAD();
+      _min_compressed_message_size = min_message_size;
+    }
+
+    message_compression_stats message_oriented_connection_impl::get_compression_stats() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _compression_stats;
+    }
+
     void message_oriented_connection_impl::close_connection()
     {
       VERIFY_CORRECT_THREAD();
@@ -366,9 +431,9 @@ namespace graphene { namespace net {
     my->bind(local_endpoint);
   }
 
-  void message_oriented_connection::send_message(const message& message_to_send)
+  void message_oriented_connection::send_message(const message& message_to_send, bool flush_socket)
   {
-    my->send_message(message_to_send);
+    my->send_message(message_to_send, flush_socket);
   }
 
   void message_oriented_connection::close_connection()
@@ -409,4 +474,14 @@ namespace graphene { namespace net {
     return my->get_shared_secret();
   }
 
+  void message_oriented_connection::enable_compression(uint32_t min_message_size)
+  {
+    my->enable_compression(min_message_size);
+  }
+
+  message_compression_stats message_oriented_connection::get_compression_stats() const
+  {
+    return my->get_compression_stats();
+  }
+
 } } // end namespace graphene::net
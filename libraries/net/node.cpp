@@ -29,7 +29,10 @@
 #include <forward_list>
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <tuple>
+#include <cstring>
+#include <iterator>
 #include <boost/tuple/tuple.hpp>
 #include <boost/circular_buffer.hpp>
 
@@ -177,6 +180,7 @@ namespace graphene { namespace net {
                         const message_propagation_data& propagation_data, const fc::uint160_t& message_content_hash );
       message get_message( const message_hash_type& hash_of_message_to_lookup );
       message_propagation_data get_message_propagation_data( const fc::uint160_t& hash_of_message_contents_to_lookup ) const;
+      fc::optional<signed_transaction> find_transaction( uint64_t short_id ) const;
       size_t size() const { return _message_cache.size(); }
     };
 
@@ -221,6 +225,116 @@ namespace graphene { namespace net {
       FC_THROW_EXCEPTION(  fc::key_not_found_exception, "Requested message not in cache" );
     }
 
+    fc::optional<signed_transaction> blockchain_tied_message_cache::find_transaction( uint64_t short_id ) const
+    {
+      // transaction ids are the contents hash of their messages, so all ids starting with short_id follow this one
+      fc::uint160_t lowest_id_with_prefix;
+      memcpy( lowest_id_with_prefix.data(), &short_id, sizeof(short_id) );
+
+      fc::optional<signed_transaction> result;
+      const auto& contents_index = _message_cache.get<message_contents_hash_index>();
+      for( auto iter = contents_index.lower_bound( lowest_id_with_prefix );
+           iter != contents_index.end() && memcmp( iter->message_contents_hash.data(), &short_id, sizeof(short_id) ) == 0;
+           ++iter )
+      {
+        if( iter->message_body.msg_type != trx_message_type )
+          continue;
+        signed_transaction trx = iter->message_body.as<trx_message>().trx;
+        if( result && result->id() != trx.id() )
+          return fc::optional<signed_transaction>(); // ambiguous, let the peer send it
+        result = std::move( trx );
+      }
+      return result;
+    }
+
+    /** averages a peer statistic over connections, a new sample weighs a quarter and 0 means not measured yet */
+    static uint32_t smooth_peer_statistic(uint32_t average, uint32_t sample)
+    {
+      return average == 0 ? sample : (uint32_t)((3 * (uint64_t)average + sample) / 4);
+    }
+
+    /**
+     * Sync blocks that arrived but were not yet handed to the client, because blocks before them are missing.
+     * Looked up by id, ordered by block number and limited in total size.
+     */
+    class sync_block_buffer
+    {
+    private:
+      struct block_id_index{};
+      struct block_number_index{};
+      struct buffered_block
+      {
+        graphene::net::block_id_type block_id;
+        uint32_t                     block_number;
+        size_t                       size;
+        graphene::net::block_message block;
+      };
+      typedef boost::multi_index_container
+        < buffered_block,
+            bmi::indexed_by< bmi::hashed_unique< bmi::tag<block_id_index>,
+                                                 bmi::member<buffered_block, graphene::net::block_id_type, &buffered_block::block_id>,
+                                                 std::hash<graphene::net::block_id_type> >,
+                             bmi::ordered_non_unique< bmi::tag<block_number_index>,
+                                                      bmi::member<buffered_block, uint32_t, &buffered_block::block_number> > >
+        > buffered_block_container;
+
+      buffered_block_container _blocks;
+      uint64_t _size_in_bytes = 0;
+      const uint64_t _max_size_in_bytes;
+
+    public:
+      explicit sync_block_buffer( uint64_t max_size_in_bytes ) : _max_size_in_bytes( max_size_in_bytes ) {}
+
+      /** adds block, dropping the blocks with the highest numbers if the buffer grows too large */
+      void insert( const graphene::net::block_message& block );
+      bool contains( const item_hash_t& block_id ) const { return _blocks.find( block_id ) != _blocks.end(); }
+      /** removes the block with block_id, which must be in the buffer, and returns it */
+      graphene::net::block_message take( const item_hash_t& block_id );
+      void erase( const item_hash_t& block_id );
+      size_t size() const { return _blocks.size(); }
+      uint64_t size_in_bytes() const { return _size_in_bytes; }
+      /** past half of the limit, blocks still in flight could push out the ones already here */
+      bool half_full() const { return _size_in_bytes >= _max_size_in_bytes / 2; }
+    };
+
+    void sync_block_buffer::insert( const graphene::net::block_message& block )
+    {
+      const size_t block_size = fc::raw::pack_size( block );
+      buffered_block entry{ block.block_id, graphene::chain::block_header::num_from_id( block.block_id ), block_size, block };
+      if( !_blocks.insert( std::move( entry ) ).second )
+        return;
+      _size_in_bytes += block_size;
+
+      auto& by_number = _blocks.get<block_number_index>();
+      while( _size_in_bytes > _max_size_in_bytes && _blocks.size() > 1 )
+      {
+        auto highest = std::prev( by_number.end() );
+        dlog( "sync block buffer is full, dropping block ${num}", ("num", highest->block_number) );
+        _size_in_bytes -= highest->size;
+        by_number.erase( highest );
+      }
+    }
+
+    graphene::net::block_message sync_block_buffer::take( const item_hash_t& block_id )
+    {
+      auto iter = _blocks.find( block_id );
+      FC_ASSERT( iter != _blocks.end() );
+      graphene::net::block_message block = iter->block;
+      _size_in_bytes -= iter->size;
+      _blocks.erase( iter );
+      return block;
+    }
+
+    void sync_block_buffer::erase( const item_hash_t& block_id )
+    {
+      auto iter = _blocks.find( block_id );
+      if( iter != _blocks.end() )
+      {
+        _size_in_bytes -= iter->size;
+        _blocks.erase( iter );
+      }
+    }
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
 
     // This specifies configuration info for the local node.  It's stored as JSON
@@ -289,6 +403,7 @@ namespace graphene { namespace net { namespace detail {
       _is_firewalled(firewalled_state::unknown),
       _potential_peer_database_updated(false),
       _sync_items_to_fetch_updated(false),
+      _received_sync_items(GRAPHENE_NET_MAX_SYNC_BLOCK_BUFFER_SIZE),
       _suspend_fetching_sync_blocks(false),
       _items_to_fetch_updated(false),
       _items_to_fetch_sequence_counter(0),
@@ -314,7 +429,9 @@ namespace graphene { namespace net { namespace detail {
       _node_is_shutting_down(false),
       _maximum_number_of_blocks_to_handle_at_one_time(MAXIMUM_NUMBER_OF_BLOCKS_TO_HANDLE_AT_ONE_TIME),
       _maximum_number_of_sync_blocks_to_prefetch(MAXIMUM_NUMBER_OF_BLOCKS_TO_PREFETCH),
-      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING)
+      _maximum_blocks_per_peer_during_syncing(GRAPHENE_NET_MAX_BLOCKS_PER_PEER_DURING_SYNCING),
+      _compression_enabled(true),
+      _min_compressed_message_size(GRAPHENE_NET_MIN_COMPRESSED_MESSAGE_SIZE)
     {
       _rate_limiter.set_actual_rate_time_constant(fc::seconds(2));
       fc::rand_pseudo_bytes(&_node_id.data[0], (int)_node_id.size());
@@ -410,9 +527,9 @@ namespace graphene { namespace net { namespace detail {
             bool initiated_connection_this_pass = false;
             _potential_peer_database_updated = false;
 
-            for (peer_database::iterator iter = _potential_peer_db.begin();
-                 iter != _potential_peer_db.end() && is_wanting_new_connections();
-                 ++iter)
+            // gather everyone we could connect to now, then try the best scoring peers first
+            std::vector<std::pair<int64_t, fc::ip::endpoint> > candidates;
+            for (peer_database::iterator iter = _potential_peer_db.begin(); iter != _potential_peer_db.end(); ++iter)
             {
               fc::microseconds delay_until_retry = fc::seconds((iter->number_of_failed_connection_attempts + 1) * _peer_connection_retry_timeout);
 
@@ -421,10 +538,15 @@ namespace graphene { namespace net { namespace detail {
                     iter->last_connection_disposition != last_connection_rejected &&
                     iter->last_connection_disposition != last_connection_handshaking_failed) ||
                    (fc::time_point::now() - iter->last_connection_attempt_time) > delay_until_retry))
-              {
-                connect_to_endpoint(iter->endpoint);
-                initiated_connection_this_pass = true;
-              }
+                candidates.emplace_back(iter->selection_score(), iter->endpoint);
+            }
+            std::stable_sort(candidates.begin(), candidates.end(),
+                             [](const std::pair<int64_t, fc::ip::endpoint>& a, const std::pair<int64_t, fc::ip::endpoint>& b) { return a.first > b.first; });
+
+            for (auto iter = candidates.begin(); iter != candidates.end() && is_wanting_new_connections(); ++iter)
+            {
+              connect_to_endpoint(iter->second);
+              initiated_connection_this_pass = true;
             }
 
             if (!initiated_connection_this_pass && !_potential_peer_database_updated)
@@ -480,10 +602,7 @@ namespace graphene { namespace net { namespace detail {
     bool node_impl::have_already_received_sync_item( const item_hash_t& item_hash )
     {
       VERIFY_CORRECT_THREAD();
-      return std::find_if(_received_sync_items.begin(), _received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _received_sync_items.end() ||
-             std::find_if(_new_received_sync_items.begin(), _new_received_sync_items.end(),
-                          [&item_hash]( const graphene::net::block_message& message ) { return message.block_id == item_hash; } ) != _new_received_sync_items.end();                          ;
+      return _received_sync_items.contains(item_hash);
     }
 
     void node_impl::request_sync_item_from_peer( const peer_connection_ptr& peer, const item_hash_t& item_to_request )
@@ -527,8 +646,18 @@ namespace graphene { namespace net { namespace detail {
             ASSERT_TASK_NOT_PREEMPTED();
             std::set<item_hash_t> sync_items_to_request;
 
+            // the peers with the shortest round trip get the first pick of the blocks we need next
+            std::vector<peer_connection_ptr> peers_by_round_trip_delay(_active_connections.begin(), _active_connections.end());
+            std::stable_sort(peers_by_round_trip_delay.begin(), peers_by_round_trip_delay.end(),
+                             [](const peer_connection_ptr& a, const peer_connection_ptr& b) {
+                               // peers not measured yet go last
+                               int64_t a_delay = a->round_trip_delay.count() > 0 ? a->round_trip_delay.count() : std::numeric_limits<int64_t>::max();
+                               int64_t b_delay = b->round_trip_delay.count() > 0 ? b->round_trip_delay.count() : std::numeric_limits<int64_t>::max();
+                               return a_delay < b_delay;
+                             });
+
             // for each idle peer that we're syncing with
-            for( const peer_connection_ptr& peer : _active_connections )
+            for( const peer_connection_ptr& peer : peers_by_round_trip_delay )
             {
               if( peer->we_need_sync_items_from_peer &&
                   sync_item_requests_to_send.find(peer) == sync_item_requests_to_send.end() && // if we've already scheduled a request for this peer, don't consider scheduling another
@@ -536,8 +665,11 @@ namespace graphene { namespace net { namespace detail {
               {
                 if (!peer->inhibit_fetching_sync_blocks)
                 {
-                  // loop through the items it has that we don't yet have on our blockchain
-                  for( unsigned i = 0; i < peer->ids_of_items_to_get.size(); ++i )
+                  // loop through the items it has that we don't yet have on our blockchain.  once the buffer
+                  // of received blocks fills up, only ask for the block this peer's list continues with
+                  unsigned items_to_consider = _received_sync_items.half_full() ? std::min<unsigned>(1, peer->ids_of_items_to_get.size())
+                                                                                : peer->ids_of_items_to_get.size();
+                  for( unsigned i = 0; i < items_to_consider; ++i )
                   {
                     item_hash_t item_to_potentially_request = peer->ids_of_items_to_get[i];
                     // if we don't already have this item in our temporary storage and we haven't requested from another syncing peer
@@ -1314,6 +1446,15 @@ namespace graphene { namespace net { namespace detail {
       case core_message_type_enum::get_current_connections_reply_message_type:
         on_get_current_connections_reply_message(originating_peer, received_message.as<get_current_connections_reply_message>());
         break;
+      case core_message_type_enum::compact_block_message_type:
+        on_compact_block_message(originating_peer, received_message.as<compact_block_message>());
+        break;
+      case core_message_type_enum::fetch_block_transactions_message_type:
+        on_fetch_block_transactions_message(originating_peer, received_message.as<fetch_block_transactions_message>());
+        break;
+      case core_message_type_enum::block_transactions_message_type:
+        on_block_transactions_message(originating_peer, received_message.as<block_transactions_message>());
+        break;
 
       default:
         // ignore any message in between core_message_type_first and _last that we don't handle above
@@ -1346,6 +1487,8 @@ namespace graphene { namespace net { namespace detail {
       user_data["platform"] = "other";
 #endif
       user_data["bitness"] = sizeof(void*) * 8;
+      user_data["compact_blocks"] = true;
+      user_data["compression"] = "zlib";
 
       user_data["node_id"] = fc::variant( _node_id, 1 );
 
@@ -1375,6 +1518,10 @@ namespace graphene { namespace net { namespace detail {
         originating_peer->platform = user_data["platform"].as_string();
       if (user_data.contains("bitness"))
         originating_peer->bitness = user_data["bitness"].as<uint32_t>(1);
+      if (user_data.contains("compact_blocks"))
+        originating_peer->supports_compact_blocks = user_data["compact_blocks"].as<bool>(1);
+      if (user_data.contains("compression") && user_data["compression"].as_string() == "zlib" && _compression_enabled)
+        originating_peer->enable_compression(_min_compressed_message_size);
       if (user_data.contains("node_id"))
         originating_peer->node_id = user_data["node_id"].as<node_id_t>(1);
       if (user_data.contains("last_known_fork_block_number"))
@@ -2263,9 +2410,17 @@ namespace graphene { namespace net { namespace detail {
           dlog("received item request for item ${id} from peer ${endpoint}, returning the item from my message cache",
                ("endpoint", originating_peer->get_remote_endpoint())
                ("id", requested_message.id()));
-          reply_messages.push_back(requested_message);
           if (fetch_items_message_received.item_type == block_message_type)
+          {
             last_block_message_sent = requested_message;
+            // a block still in the cache is new, the peer has most likely seen its transactions
+            if (originating_peer->supports_compact_blocks && !originating_peer->peer_needs_sync_items_from_us)
+            {
+              reply_messages.push_back(make_compact_block_message(originating_peer, requested_message, item_hash));
+              continue;
+            }
+          }
+          reply_messages.push_back(requested_message);
           continue;
         }
         catch (fc::key_not_found_exception&)
@@ -2477,6 +2632,7 @@ namespace graphene { namespace net { namespace detail {
           if (updated_peer_record)
           {
             updated_peer_record->last_seen_time = fc::time_point::now();
+            record_connection_statistics(originating_peer, *updated_peer_record);
             _potential_peer_db.update_entry(*updated_peer_record);
           }
         }
@@ -2748,84 +2904,90 @@ namespace graphene { namespace net { namespace detail {
 
       do
       {
-        std::copy(std::make_move_iterator(_new_received_sync_items.begin()),
-                  std::make_move_iterator(_new_received_sync_items.end()),
-                  std::front_inserter(_received_sync_items));
-        _new_received_sync_items.clear();
         dlog("currently ${count} sync items to consider", ("count", _received_sync_items.size()));
 
         block_processed_this_iteration = false;
-        for (auto received_block_iter = _received_sync_items.begin();
-             received_block_iter != _received_sync_items.end();
-             ++received_block_iter)
+
+        // of the blocks our sync peers will give us next, take the lowest one we already have
+        fc::optional<item_hash_t> next_block_id;
+        uint32_t next_block_number = 0;
+        for (const peer_connection_ptr& peer : _active_connections)
         {
+          ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
+          if (!peer->ids_of_items_to_get.empty() &&
+              _received_sync_items.contains(peer->ids_of_items_to_get.front()))
+          {
+            const item_hash_t& candidate_id = peer->ids_of_items_to_get.front();
+            uint32_t candidate_number = graphene::chain::block_header::num_from_id(candidate_id);
+            if (!next_block_id || candidate_number < next_block_number)
+            {
+              next_block_id = candidate_id;
+              next_block_number = candidate_number;
+            }
+          }
+        }
 
-          // find out if this block is the next block on the active chain or one of the forks
-          bool potential_first_block = false;
+        // if there is one, process it, remove it from all sync peers lists
+        if (next_block_id)
+        {
+          const item_hash_t received_block_id = *next_block_id;
           for (const peer_connection_ptr& peer : _active_connections)
           {
             ASSERT_TASK_NOT_PREEMPTED(); // don't yield while iterating over _active_connections
             if (!peer->ids_of_items_to_get.empty() &&
-                peer->ids_of_items_to_get.front() == received_block_iter->block_id)
+                peer->ids_of_items_to_get.front() == received_block_id)
             {
-              potential_first_block = true;
               peer->ids_of_items_to_get.pop_front();
-              peer->ids_of_items_being_processed.insert(received_block_iter->block_id);
+              peer->ids_of_items_being_processed.insert(received_block_id);
             }
           }
 
-          // if it is, process it, remove it from all sync peers lists
-          if (potential_first_block)
+          // we can get into an interesting situation near the end of synchronization.  We can be in
+          // sync with one peer who is sending us the last block on the chain via a regular inventory
+          // message, while at the same time still be synchronizing with a peer who is sending us the
+          // block through the sync mechanism.  Further, we must request both blocks because
+          // we don't know they're the same (for the peer in normal operation, it has only told us the
+          // message id, for the peer in the sync case we only known the block_id).
+          if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
+                        received_block_id) == _most_recent_blocks_accepted.end())
           {
-            // we can get into an interesting situation near the end of synchronization.  We can be in
-            // sync with one peer who is sending us the last block on the chain via a regular inventory
-            // message, while at the same time still be synchronizing with a peer who is sending us the
-            // block through the sync mechanism.  Further, we must request both blocks because
-            // we don't know they're the same (for the peer in normal operation, it has only told us the
-            // message id, for the peer in the sync case we only known the block_id).
-            if (std::find(_most_recent_blocks_accepted.begin(), _most_recent_blocks_accepted.end(),
-                          received_block_iter->block_id) == _most_recent_blocks_accepted.end())
-            {
-              graphene::net::block_message block_message_to_process = *received_block_iter;
-              _received_sync_items.erase(received_block_iter);
-              _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
-                send_sync_block_to_node_delegate(block_message_to_process);
-              }, "send_sync_block_to_node_delegate"));
-              ++blocks_processed;
-              block_processed_this_iteration = true;
-            }
-            else
+            graphene::net::block_message block_message_to_process = _received_sync_items.take(received_block_id);
+            _handle_message_calls_in_progress.emplace_back(fc::async([this, block_message_to_process](){
+              send_sync_block_to_node_delegate(block_message_to_process);
+            }, "send_sync_block_to_node_delegate"));
+            ++blocks_processed;
+            block_processed_this_iteration = true;
+          }
+          else
+          {
+            dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
+            _received_sync_items.erase(received_block_id);
+            std::vector< peer_connection_ptr > peers_needing_next_batch;
+            for (const peer_connection_ptr& peer : _active_connections)
             {
-              dlog("Already received and accepted this block (presumably through normal inventory mechanism), treating it as accepted");
-              std::vector< peer_connection_ptr > peers_needing_next_batch;
-              for (const peer_connection_ptr& peer : _active_connections)
+              auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_id);
+              if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
               {
-                auto items_being_processed_iter = peer->ids_of_items_being_processed.find(received_block_iter->block_id);
-                if (items_being_processed_iter != peer->ids_of_items_being_processed.end())
+                peer->ids_of_items_being_processed.erase(items_being_processed_iter);
+                dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
+                     ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
+
+                // if we just processed the last item in our list from this peer, we will want to
+                // send another request to find out if we are now in sync (this is normally handled in
+                // send_sync_block_to_node_delegate)
+                if (peer->ids_of_items_to_get.empty() &&
+                    peer->number_of_unfetched_item_ids == 0 &&
+                    peer->ids_of_items_being_processed.empty())
                 {
-                  peer->ids_of_items_being_processed.erase(items_being_processed_iter);
-                  dlog("Removed item from ${endpoint}'s list of items being processed, still processing ${len} blocks",
-                       ("endpoint", peer->get_remote_endpoint())("len", peer->ids_of_items_being_processed.size()));
-
-                  // if we just processed the last item in our list from this peer, we will want to
-                  // send another request to find out if we are now in sync (this is normally handled in
-                  // send_sync_block_to_node_delegate)
-                  if (peer->ids_of_items_to_get.empty() &&
-                      peer->number_of_unfetched_item_ids == 0 &&
-                      peer->ids_of_items_being_processed.empty())
-                  {
-                    dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
-                    peers_needing_next_batch.push_back( peer );
-                  }
+                  dlog("We received last item in our list for peer ${endpoint}, setup to do a sync check", ("endpoint", peer->get_remote_endpoint()));
+                  peers_needing_next_batch.push_back( peer );
                 }
               }
-              for( const peer_connection_ptr& peer : peers_needing_next_batch )
-                fetch_next_batch_of_item_ids_from_peer(peer.get());
             }
-
-            break; // start iterating _received_sync_items from the beginning
-          } // end if potential_first_block
-        } // end for each block in _received_sync_items
+            for( const peer_connection_ptr& peer : peers_needing_next_batch )
+              fetch_next_batch_of_item_ids_from_peer(peer.get());
+          }
+        } // end if next_block_id
 
         if (_handle_message_calls_in_progress.size() >= _maximum_number_of_blocks_to_handle_at_one_time)
         {
@@ -2833,7 +2995,7 @@ namespace graphene { namespace net { namespace detail {
                ("count", _handle_message_calls_in_progress.size()));
           //ulog("stopping processing sync block backlog because we have ${count} blocks in progress, total on hand: ${received}",
           //     ("count", _handle_message_calls_in_progress.size())("received", _received_sync_items.size()));
-          if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch)
+          if (_received_sync_items.size() >= _maximum_number_of_sync_blocks_to_prefetch || _received_sync_items.half_full())
             _suspend_fetching_sync_blocks = true;
           break;
         }
@@ -2858,9 +3020,9 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
       dlog( "received a sync block from peer ${endpoint}", ("endpoint", originating_peer->get_remote_endpoint() ) );
 
-      // add it to the front of _received_sync_items, then process _received_sync_items to try to
+      // add it to _received_sync_items, then process _received_sync_items to try to
       // pass as many messages as possible to the client.
-      _new_received_sync_items.push_front( block_message_to_process );
+      _received_sync_items.insert( block_message_to_process );
       trigger_process_backlog_of_sync_blocks();
     }
 
@@ -3109,6 +3271,30 @@ namespace graphene { namespace net { namespace detail {
                                                          (current_time_reply_message_received.reply_transmitted_time - reply_received_time)).count() / 2);
       originating_peer->round_trip_delay = (reply_received_time - current_time_reply_message_received.request_sent_time) -
                                            (current_time_reply_message_received.reply_transmitted_time - current_time_reply_message_received.request_received_time);
+
+      fc::optional<fc::ip::endpoint> inbound_endpoint = originating_peer->get_endpoint_for_connecting();
+      if (inbound_endpoint && originating_peer->round_trip_delay.count() >= 0)
+      {
+        fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+        if (updated_peer_record)
+        {
+          uint32_t round_trip_delay_ms = std::max<int64_t>(originating_peer->round_trip_delay.count() / 1000, 1);
+          updated_peer_record->round_trip_delay_ms = smooth_peer_statistic(updated_peer_record->round_trip_delay_ms, round_trip_delay_ms);
+          _potential_peer_db.update_entry(*updated_peer_record);
+        }
+      }
+    }
+
+    void node_impl::record_connection_statistics(peer_connection* peer, potential_peer_record& record)
+    {
+      // remember how well the connection went for choosing peers later
+      int64_t connected_seconds = (fc::time_point::now() - peer->get_connection_time()).to_seconds();
+      if (connected_seconds <= 0)
+        return;
+      record.connected_seconds += connected_seconds;
+      uint32_t download_rate = std::min<uint64_t>(peer->get_total_bytes_received() / connected_seconds,
+                                                  std::numeric_limits<uint32_t>::max());
+      record.download_rate = smooth_peer_statistic(record.download_rate, download_rate);
     }
 
     void node_impl::forward_firewall_check_to_next_available_peer(firewall_check_state_data* firewall_check_state)
@@ -3348,6 +3534,212 @@ namespace graphene { namespace net { namespace detail {
       VERIFY_CORRECT_THREAD();
     }
 
+    message node_impl::make_compact_block_message(peer_connection* peer, const message& block_message_to_send, const message_hash_type& message_hash)
+    {
+      VERIFY_CORRECT_THREAD();
+      graphene::net::block_message block_message_to_compact = block_message_to_send.as<graphene::net::block_message>();
+      const signed_block& block = block_message_to_compact.block;
+      compact_block_message compact_block(block, block_message_to_compact.block_id, message_hash);
+      for (uint32_t i = 0; i < block.transactions.size(); ++i)
+      {
+        // send along the transactions we can't tell the peer has
+        const signed_transaction& trx = block.transactions[i];
+        item_id trx_item(trx_message_type, message(trx_message(trx)).id());
+        if (peer->inventory_peer_advertised_to_us.find(trx_item) == peer->inventory_peer_advertised_to_us.end() &&
+            peer->inventory_advertised_to_peer.find(trx_item) == peer->inventory_advertised_to_peer.end())
+          compact_block.prefilled_transactions.push_back(prefilled_transaction{i, trx});
+      }
+
+      message compact_block_message_to_send(compact_block);
+      ++_compact_blocks_sent;
+      if (block_message_to_send.size > compact_block_message_to_send.size)
+        _compact_block_bytes_saved += block_message_to_send.size - compact_block_message_to_send.size;
+      dlog("sending block ${id} to peer ${endpoint} as a compact block with ${prefilled} of ${count} transactions, ${size} instead of ${full_size} bytes",
+           ("id", compact_block.block_id)("endpoint", peer->get_remote_endpoint())
+           ("prefilled", compact_block.prefilled_transactions.size())("count", compact_block.transactions.size())
+           ("size", compact_block_message_to_send.size)("full_size", block_message_to_send.size));
+      return compact_block_message_to_send;
+    }
+
+    void node_impl::on_compact_block_message(peer_connection* originating_peer,
+                                             const compact_block_message& compact_block_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      const compact_block_message& compact_block = compact_block_message_received;
+      ++_compact_blocks_received;
+      if (originating_peer->items_requested_from_peer.find(item_id(block_message_type, compact_block.block_message_hash)) ==
+            originating_peer->items_requested_from_peer.end() &&
+          originating_peer->sync_items_requested_from_peer.find(compact_block.block_id) ==
+            originating_peer->sync_items_requested_from_peer.end())
+      {
+        wlog("received compact block ${id} we didn't request from peer ${endpoint}, ignoring it",
+             ("id", compact_block.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      if (originating_peer->compact_blocks_awaiting_transactions.find(compact_block.block_id) !=
+          originating_peer->compact_blocks_awaiting_transactions.end())
+        return;
+
+      peer_connection::partial_compact_block partial_block;
+      partial_block.compact_block = compact_block;
+      partial_block.transactions.resize(compact_block.transactions.size());
+      for (const prefilled_transaction& prefilled : compact_block.prefilled_transactions)
+      {
+        if (prefilled.index >= partial_block.transactions.size())
+        {
+          disconnect_from_peer(originating_peer, "You sent a compact block with an invalid transaction index", true,
+                               fc::exception(FC_LOG_MESSAGE(error, "invalid prefilled transaction index ${index} in compact block ${id}",
+                                                            ("index", prefilled.index)("id", compact_block.block_id))));
+          return;
+        }
+        partial_block.transactions[prefilled.index] = prefilled.trx;
+      }
+      for (uint32_t i = 0; i < partial_block.transactions.size(); ++i)
+        if (!partial_block.transactions[i])
+        {
+          partial_block.transactions[i] = _message_cache.find_transaction(compact_block.transactions[i].short_id);
+          if (!partial_block.transactions[i])
+            partial_block.requested_indices.push_back(i);
+        }
+
+      process_partial_compact_block(originating_peer, std::move(partial_block));
+    }
+
+    void node_impl::process_partial_compact_block(peer_connection* originating_peer, peer_connection::partial_compact_block&& partial_block)
+    {
+      VERIFY_CORRECT_THREAD();
+      const compact_block_message& compact_block = partial_block.compact_block;
+      auto request_transactions = [&]() {
+        auto& awaiting = originating_peer->compact_blocks_awaiting_transactions;
+        if (awaiting.size() >= GRAPHENE_NET_MAX_COMPACT_BLOCKS_AWAITING_TRANSACTIONS &&
+            awaiting.find(compact_block.block_id) == awaiting.end())
+        {
+          ++_compact_blocks_failed;
+          disconnect_from_peer(originating_peer, "You sent more compact blocks than we can complete at once", true,
+                               fc::exception(FC_LOG_MESSAGE(error, "too many incomplete compact blocks from peer, dropping ${id}",
+                                                            ("id", compact_block.block_id))));
+          return;
+        }
+        dlog("requesting ${count} transactions of compact block ${id} from peer ${endpoint}",
+             ("count", partial_block.requested_indices.size())("id", compact_block.block_id)
+             ("endpoint", originating_peer->get_remote_endpoint()));
+        _compact_block_transactions_requested += partial_block.requested_indices.size();
+        ++partial_block.round_trips;
+        originating_peer->send_message(fetch_block_transactions_message(compact_block.block_id, partial_block.requested_indices));
+        block_id_type block_id = compact_block.block_id;
+        awaiting[block_id] = std::move(partial_block);
+      };
+
+      if (!partial_block.requested_indices.empty())
+      {
+        request_transactions();
+        return;
+      }
+
+      signed_block block;
+      static_cast<signed_block_header&>(block) = compact_block.header;
+      block.transactions.reserve(partial_block.transactions.size());
+      for (uint32_t i = 0; i < partial_block.transactions.size(); ++i)
+      {
+        block.transactions.emplace_back(*partial_block.transactions[i]);
+        block.transactions.back().operation_results = compact_block.transactions[i].operation_results;
+      }
+
+      graphene::net::block_message reconstructed_block(block);
+      message block_message_to_process(reconstructed_block);
+      message_hash_type message_hash = block_message_to_process.id();
+      if (message_hash != compact_block.block_message_hash || reconstructed_block.block_id != compact_block.block_id)
+      {
+        if (partial_block.requested_all)
+        {
+          ++_compact_blocks_failed;
+          disconnect_from_peer(originating_peer, "You sent a compact block that does not match its transactions", true,
+                               fc::exception(FC_LOG_MESSAGE(error, "compact block ${id} does not match its transactions",
+                                                            ("id", compact_block.block_id))));
+          return;
+        }
+        // most likely a short id matched a different cached transaction, ask for all of them
+        wlog("compact block ${id} from peer ${endpoint} does not match the cached transactions, requesting all of them",
+             ("id", compact_block.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        partial_block.requested_all = true;
+        partial_block.requested_indices.clear();
+        for (uint32_t i = 0; i < partial_block.transactions.size(); ++i)
+          partial_block.requested_indices.push_back(i);
+        request_transactions();
+        return;
+      }
+
+      if (partial_block.round_trips == 0)
+        ++_compact_blocks_reconstructed;
+      process_block_message(originating_peer, block_message_to_process, message_hash);
+    }
+
+    void node_impl::on_fetch_block_transactions_message(peer_connection* originating_peer,
+                                                        const fetch_block_transactions_message& fetch_block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      block_transactions_message reply;
+      reply.block_id = fetch_block_transactions_message_received.block_id;
+      try
+      {
+        graphene::net::block_message requested_block =
+          _delegate->get_item(item_id(block_message_type, reply.block_id)).as<graphene::net::block_message>();
+        const auto& transactions = requested_block.block.transactions;
+        reply.transactions.reserve(fetch_block_transactions_message_received.indices.size());
+        for (uint32_t index : fetch_block_transactions_message_received.indices)
+        {
+          if (index >= transactions.size())
+          {
+            reply.transactions.clear();
+            break;
+          }
+          reply.transactions.push_back(transactions[index]);
+        }
+      }
+      catch (const fc::exception&)
+      {
+        // an empty reply tells the peer to get the block elsewhere
+        dlog("peer ${endpoint} asked for transactions of block ${id} which we don't have",
+             ("endpoint", originating_peer->get_remote_endpoint())("id", reply.block_id));
+      }
+      originating_peer->send_message(reply);
+    }
+
+    void node_impl::on_block_transactions_message(peer_connection* originating_peer,
+                                                  const block_transactions_message& block_transactions_message_received)
+    {
+      VERIFY_CORRECT_THREAD();
+      auto& awaiting = originating_peer->compact_blocks_awaiting_transactions;
+      auto iter = awaiting.find(block_transactions_message_received.block_id);
+      if (iter == awaiting.end())
+      {
+        wlog("received transactions of block ${id} we didn't request from peer ${endpoint}, ignoring them",
+             ("id", block_transactions_message_received.block_id)("endpoint", originating_peer->get_remote_endpoint()));
+        return;
+      }
+      peer_connection::partial_compact_block partial_block = std::move(iter->second);
+      awaiting.erase(iter);
+
+      const auto& transactions = block_transactions_message_received.transactions;
+      if (transactions.size() != partial_block.requested_indices.size())
+      {
+        // the peer lost the block, treat it like any other item it can't provide
+        ++_compact_blocks_failed;
+        const compact_block_message& compact_block = partial_block.compact_block;
+        item_hash_t requested_hash = compact_block.block_message_hash;
+        if (originating_peer->sync_items_requested_from_peer.find(compact_block.block_id) !=
+            originating_peer->sync_items_requested_from_peer.end())
+          requested_hash = compact_block.block_id;
+        on_item_not_available_message(originating_peer, item_not_available_message(item_id(block_message_type, requested_hash)));
+        return;
+      }
+      for (uint32_t i = 0; i < transactions.size(); ++i)
+        partial_block.transactions[partial_block.requested_indices[i]] = transactions[i];
+      partial_block.requested_indices.clear();
+
+      process_partial_compact_block(originating_peer, std::move(partial_block));
+    }
+
 
     // this handles any message we get that doesn't require any special processing.
     // currently, this is any message other than block messages and p2p-specific
@@ -3446,6 +3838,19 @@ namespace graphene { namespace net { namespace detail {
 
       try
       {
+        // connections still open won't be reported closed until the database is gone
+        for (const peer_connection_ptr& active_peer : _active_connections)
+        {
+          fc::optional<fc::ip::endpoint> inbound_endpoint = active_peer->get_endpoint_for_connecting();
+          if (!inbound_endpoint)
+            continue;
+          fc::optional<potential_peer_record> updated_peer_record = _potential_peer_db.lookup_entry_for_endpoint(*inbound_endpoint);
+          if (updated_peer_record)
+          {
+            record_connection_statistics(active_peer.get(), *updated_peer_record);
+            _potential_peer_db.update_entry(*updated_peer_record);
+          }
+        }
         _potential_peer_db.close();
       }
       catch ( const fc::exception& e )
@@ -3985,7 +4390,8 @@ namespace graphene { namespace net { namespace detail {
       fc::path potential_peer_database_file_name(_node_configuration_directory / POTENTIAL_PEER_DATABASE_FILENAME);
       try
       {
-        _potential_peer_db.open(potential_peer_database_file_name);
+        _potential_peer_db.open(potential_peer_database_file_name,
+                                _node_configuration_directory / LEGACY_POTENTIAL_PEER_DATABASE_FILENAME);
 
         // push back the time on all peers loaded from the database so we will be able to retry them immediately
         for (peer_database::iterator itr = _potential_peer_db.begin(); itr != _potential_peer_db.end(); ++itr)
@@ -4253,8 +4659,7 @@ namespace graphene { namespace net { namespace detail {
 
       ilog( "--------- MEMORY USAGE ------------" );
       ilog( "node._active_sync_requests size: ${size}", ("size", _active_sync_requests.size() ) );
-      ilog( "node._received_sync_items size: ${size}", ("size", _received_sync_items.size() ) );
-      ilog( "node._new_received_sync_items size: ${size}", ("size", _new_received_sync_items.size() ) );
+      ilog( "node._received_sync_items size: ${size}, ${bytes} bytes", ("size", _received_sync_items.size() )("bytes", _received_sync_items.size_in_bytes() ) );
       ilog( "node._items_to_fetch size: ${size}", ("size", _items_to_fetch.size() ) );
       ilog( "node._new_inventory size: ${size}", ("size", _new_inventory.size() ) );
       ilog( "node._message_cache size: ${size}", ("size", _message_cache.size() ) );
@@ -4372,6 +4777,7 @@ namespace graphene { namespace net { namespace detail {
         peer_details["lastrecv"] = peer->get_last_message_received_time().sec_since_epoch();
         peer_details["bytessent"] = peer->get_total_bytes_sent();
         peer_details["bytesrecv"] = peer->get_total_bytes_received();
+        peer_details["compression"] = fc::variant( peer->get_compression_stats(), 2 );
         peer_details["conntime"] = peer->get_connection_time();
         peer_details["pingtime"] = "";
         peer_details["pingwait"] = "";
@@ -4499,6 +4905,10 @@ namespace graphene { namespace net { namespace detail {
         _maximum_number_of_sync_blocks_to_prefetch = params["maximum_number_of_sync_blocks_to_prefetch"].as<uint32_t>(1);
       if (params.contains("maximum_blocks_per_peer_during_syncing"))
         _maximum_blocks_per_peer_during_syncing = params["maximum_blocks_per_peer_during_syncing"].as<uint32_t>(1);
+      if (params.contains("enable_compression"))
+        _compression_enabled = params["enable_compression"].as<bool>(1);
+      if (params.contains("min_compressed_message_size"))
+        _min_compressed_message_size = params["min_compressed_message_size"].as<uint32_t>(1);
 
       _desired_number_of_connections = std::min(_desired_number_of_connections, _maximum_number_of_connections);
 
@@ -4518,6 +4928,24 @@ namespace graphene { namespace net { namespace detail {
       result["maximum_number_of_blocks_to_handle_at_one_time"] = _maximum_number_of_blocks_to_handle_at_one_time;
       result["maximum_number_of_sync_blocks_to_prefetch"] = _maximum_number_of_sync_blocks_to_prefetch;
       result["maximum_blocks_per_peer_during_syncing"] = _maximum_blocks_per_peer_during_syncing;
+      result["enable_compression"] = _compression_enabled;
+      result["min_compressed_message_size"] = _min_compressed_message_size;
+
+      // totals of the current connections, per connection in get_connected_peers()
+      message_compression_stats compression;
+      for (const peer_connection_ptr& peer : _active_connections)
+      {
+        message_compression_stats peer_compression = peer->get_compression_stats();
+        compression.messages_compressed += peer_compression.messages_compressed;
+        compression.bytes_before_compression += peer_compression.bytes_before_compression;
+        compression.bytes_after_compression += peer_compression.bytes_after_compression;
+        compression.compression_time += peer_compression.compression_time;
+        compression.messages_decompressed += peer_compression.messages_decompressed;
+        compression.bytes_before_decompression += peer_compression.bytes_before_decompression;
+        compression.bytes_after_decompression += peer_compression.bytes_after_decompression;
+        compression.decompression_time += peer_compression.decompression_time;
+      }
+      result["compression"] = fc::variant( compression, 2 );
       return result;
     }
 
@@ -4586,6 +5014,15 @@ namespace graphene { namespace net { namespace detail {
       info["node_public_key"] = fc::variant( _node_public_key, 1 );
       info["node_id"] = fc::variant( _node_id, 1 );
       info["firewalled"] = fc::variant( _is_firewalled, 1 );
+
+      fc::mutable_variant_object compact_blocks;
+      compact_blocks["sent"] = _compact_blocks_sent;
+      compact_blocks["bytes_saved"] = _compact_block_bytes_saved;
+      compact_blocks["received"] = _compact_blocks_received;
+      compact_blocks["reconstructed_from_cache"] = _compact_blocks_reconstructed;
+      compact_blocks["transactions_requested"] = _compact_block_transactions_requested;
+      compact_blocks["failed"] = _compact_blocks_failed;
+      info["compact_blocks"] = compact_blocks;
       return info;
     }
     fc::variant_object node_impl::network_get_usage_stats() const
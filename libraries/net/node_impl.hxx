@@ -173,7 +173,8 @@ class node_impl : public peer_connection_delegate
       fc::sha256           _chain_id;
 
 #define NODE_CONFIGURATION_FILENAME      "node_config.json"
-#define POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
+#define POTENTIAL_PEER_DATABASE_FILENAME "peers.dat"
+#define LEGACY_POTENTIAL_PEER_DATABASE_FILENAME "peers.json"
       fc::path             _node_configuration_directory;
       node_configuration   _node_configuration;
 
@@ -207,8 +208,7 @@ class node_impl : public peer_connection_delegate
       typedef std::unordered_map<graphene::net::block_id_type, fc::time_point> active_sync_requests_map;
 
       active_sync_requests_map              _active_sync_requests; /// list of sync blocks we've asked for from peers but have not yet received
-      std::list<graphene::net::block_message> _new_received_sync_items; /// list of sync blocks we've just received but haven't yet tried to process
-      std::list<graphene::net::block_message> _received_sync_items; /// list of sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
+      sync_block_buffer                     _received_sync_items; /// sync blocks we've received, but can't yet process because we are still missing blocks that come earlier in the chain
       // @}
 
       fc::future<void> _process_backlog_of_sync_blocks_done;
@@ -288,6 +288,16 @@ class node_impl : public peer_connection_delegate
 
       blockchain_tied_message_cache _message_cache; /// cache message we have received and might be required to provide to other peers via inventory requests
 
+      /// compact block relay counters, reported by network_get_info()
+      /// @{
+      uint64_t _compact_blocks_sent = 0;
+      uint64_t _compact_block_bytes_saved = 0; /// size of the block messages replaced minus the size of the compact blocks
+      uint64_t _compact_blocks_received = 0;
+      uint64_t _compact_blocks_reconstructed = 0; /// without asking the peer for transactions
+      uint64_t _compact_block_transactions_requested = 0;
+      uint64_t _compact_blocks_failed = 0;
+      /// @}
+
       fc::rate_limiting_group _rate_limiter;
 
       uint32_t _last_reported_number_of_connections; // number of connections last reported to the client (to avoid sending duplicate messages)
@@ -335,6 +345,9 @@ class node_impl : public peer_connection_delegate
       unsigned _maximum_number_of_sync_blocks_to_prefetch;
       unsigned _maximum_blocks_per_peer_during_syncing;
 
+      bool     _compression_enabled; /// compress messages to peers that accept it, applies to new connections
+      uint32_t _min_compressed_message_size;
+
       std::list<fc::future<void> > _handle_message_calls_in_progress;
 
       node_impl(const std::string& user_agent);
@@ -421,6 +434,7 @@ class node_impl : public peer_connection_delegate
 
       void on_current_time_reply_message( peer_connection* originating_peer,
                                           const current_time_reply_message& current_time_reply_message_received );
+      void record_connection_statistics(peer_connection* peer, potential_peer_record& record);
 
       void forward_firewall_check_to_next_available_peer(firewall_check_state_data* firewall_check_state);
 
@@ -436,6 +450,19 @@ class node_impl : public peer_connection_delegate
       void on_get_current_connections_reply_message(peer_connection* originating_peer,
                                                     const get_current_connections_reply_message& get_current_connections_reply_message_received);
 
+      message make_compact_block_message(peer_connection* peer, const message& block_message_to_send, const message_hash_type& message_hash);
+
+      void on_compact_block_message(peer_connection* originating_peer,
+                                    const compact_block_message& compact_block_message_received);
+
+      void on_fetch_block_transactions_message(peer_connection* originating_peer,
+                                               const fetch_block_transactions_message& fetch_block_transactions_message_received);
+
+      void on_block_transactions_message(peer_connection* originating_peer,
+                                         const block_transactions_message& block_transactions_message_received);
+
+      void process_partial_compact_block(peer_connection* originating_peer, peer_connection::partial_compact_block&& partial_block);
+
       void on_connection_closed(peer_connection* originating_peer) override;
 
       void send_sync_block_to_node_delegate(const graphene::net::block_message& block_message_to_send);
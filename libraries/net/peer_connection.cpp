@@ -82,6 +82,7 @@ namespace graphene { namespace net
       their_state(their_connection_state::disconnected),
       we_have_requested_close(false),
       negotiation_status(connection_negotiation_status::disconnected),
+      supports_compact_blocks(false),
       number_of_unfetched_item_ids(0),
       peer_needs_sync_items_from_us(true),
       we_need_sync_items_from_peer(true),
@@ -301,7 +302,8 @@ namespace graphene { namespace net
           //dlog("peer_connection::send_queued_messages_task() calling message_oriented_connection::send_message() "
           //     "to send message of type ${type} for peer ${endpoint}",
           //     ("type", message_to_send.msg_type)("endpoint", get_remote_endpoint()));
-          _message_connection.send_message(message_to_send);
+          // messages queued behind this one are encrypted and written together with it
+          _message_connection.send_message(message_to_send, _queued_messages.size() == 1);
           //dlog("peer_connection::send_queued_messages_task()'s call to message_oriented_connection::send_message() completed normally for peer ${endpoint}",
           //     ("endpoint", get_remote_endpoint()));
         }
@@ -475,6 +477,18 @@ namespace graphene { namespace net
       return _message_connection.get_shared_secret();
     }
 
+    void peer_connection::enable_compression(uint32_t min_message_size)
+    {
+      VERIFY_CORRECT_THREAD();
+      _message_connection.enable_compression(min_message_size);
+    }
+
+    message_compression_stats peer_connection::get_compression_stats() const
+    {
+      VERIFY_CORRECT_THREAD();
+      return _message_connection.get_compression_stats();
+    }
+
     void peer_connection::clear_old_inventory()
     {
       VERIFY_CORRECT_THREAD();
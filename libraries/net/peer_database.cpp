@@ -36,11 +36,56 @@
 #include <graphene/net/peer_database.hpp>
 #include <graphene/net/config.hpp>
 
+#include <algorithm>
+#include <fstream>
+
 namespace graphene { namespace net {
+
+  int64_t potential_peer_record::selection_score() const
+  {
+    int64_t score = 0;
+    // up to 1000 for latency, unmeasured peers count as 500ms
+    score += 1000 - std::min<int64_t>(round_trip_delay_ms ? round_trip_delay_ms : 500, 1000);
+    // up to 1000 for throughput, in KiB/s
+    score += std::min<int64_t>(download_rate / 1024, 1000);
+    // up to 1000 for uptime, in minutes
+    score += std::min<int64_t>(connected_seconds / 60, 1000);
+    score -= 250 * (int64_t)number_of_failed_connection_attempts;
+    if (last_connection_disposition == last_connection_succeeded)
+      score += 250;
+    return score;
+  }
+
   namespace detail
   {
     using namespace boost::multi_index;
 
+    /**
+     * The database file is a log of these entries, each preceded by its packed size.  Every change
+     * to a record appends the whole record and erasing an endpoint appends a tombstone, the last
+     * entry for an endpoint wins when the log is replayed.  The log is rewritten with only the live
+     * records once most of it is superseded.
+     */
+    struct peer_database_log_entry
+    {
+      bool                  erased = false;
+      potential_peer_record record;
+    };
+
+    const uint32_t peer_database_log_magic = 0x31424450; // "PDB1"
+    /** the log is not compacted before it holds this many superseded entries */
+    const uint32_t peer_database_min_superseded_entries = 1000;
+    /** no record comes close to this, a larger size means the log is damaged */
+    const uint32_t peer_database_max_entry_size = 1024 * 1024;
+  }
+} } // end namespace graphene::net
+
+FC_REFLECT(graphene::net::detail::peer_database_log_entry, (erased)(record))
+
+namespace graphene { namespace net {
+  namespace detail
+  {
+
     class peer_database_impl
     {
     public:
@@ -60,9 +105,18 @@ namespace graphene { namespace net {
     private:
       potential_peer_set     _potential_peer_set;
       fc::path _peer_database_filename;
+      std::ofstream _log;
+      /** number of entries in the log, including superseded ones */
+      uint32_t _log_entry_count = 0;
+
+      void append_to_log(const peer_database_log_entry& entry);
+      void replay_log();
+      void import_json(const fc::path& json_filename);
+      void prune();
+      void compact();
 
     public:
-      void open(const fc::path& databaseFilename);
+      void open(const fc::path& databaseFilename, const fc::path& legacy_json_filename);
       void close();
       void clear();
       void erase(const fc::ip::endpoint& endpointToErase);
@@ -87,62 +141,204 @@ namespace graphene { namespace net {
     peer_database_iterator::peer_database_iterator( const peer_database_iterator& c ) :
       boost::iterator_facade<peer_database_iterator, const potential_peer_record, boost::forward_traversal_tag>(c){}
 
-    void peer_database_impl::open(const fc::path& peer_database_filename)
+    void peer_database_impl::open(const fc::path& peer_database_filename, const fc::path& legacy_json_filename)
     {
       _peer_database_filename = peer_database_filename;
       if (fc::exists(_peer_database_filename))
+        replay_log();
+      else if (legacy_json_filename != fc::path() && fc::exists(legacy_json_filename))
+        import_json(legacy_json_filename);
+      prune();
+
+      try
       {
-        try
+        compact();
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error writing peer database file ${peer_database_filename}: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e));
+      }
+    }
+
+    void peer_database_impl::replay_log()
+    {
+      try
+      {
+        std::ifstream in(_peer_database_filename.generic_string(), std::ios::in | std::ios::binary);
+        const uint64_t file_size = fc::file_size(_peer_database_filename);
+        uint32_t magic = 0;
+        in.read((char*)&magic, sizeof(magic));
+        FC_ASSERT(in && magic == peer_database_log_magic, "not a peer database file");
+
+        std::vector<char> packed_entry;
+        while (true)
         {
-          std::vector<potential_peer_record> peer_records = fc::json::from_file(_peer_database_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
-          std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
-          if (_potential_peer_set.size() > MAXIMUM_PEERDB_SIZE)
+          uint32_t entry_size = 0;
+          in.read((char*)&entry_size, sizeof(entry_size));
+          if (!in)
+            break;
+          const uint64_t remaining = file_size - std::min<uint64_t>(in.tellg(), file_size);
+          if (entry_size <= remaining && entry_size <= peer_database_max_entry_size)
           {
-            // prune database to a reasonable size
-            auto iter = _potential_peer_set.begin();
-            std::advance(iter, MAXIMUM_PEERDB_SIZE);
-            _potential_peer_set.erase(iter, _potential_peer_set.end());
+            packed_entry.resize(entry_size);
+            in.read(packed_entry.data(), entry_size);
           }
+          else
+            in.setstate(std::ios::failbit);
+          if (!in)
+          {
+            // the node went down while appending, the entries before it are intact.  A size running
+            // past the end of the file is the same damaged tail and must not be trusted for allocation
+            wlog("ignoring truncated entry at the end of peer database file ${peer_database_filename}",
+                 ("peer_database_filename", _peer_database_filename));
+            break;
+          }
+          peer_database_log_entry entry = fc::raw::unpack<peer_database_log_entry>(packed_entry);
+          if (entry.erased)
+            erase(entry.record.endpoint);
+          else
+            update_entry(entry.record);
         }
-        catch (const fc::exception& e)
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error reading peer database file ${peer_database_filename}, keeping the ${count} peers read before the error: ${e}",
+             ("peer_database_filename", _peer_database_filename)("count", _potential_peer_set.size())("e", e));
+      }
+    }
+
+    void peer_database_impl::import_json(const fc::path& json_filename)
+    {
+      try
+      {
+        std::vector<potential_peer_record> peer_records = fc::json::from_file(json_filename).as<std::vector<potential_peer_record> >( GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        std::copy(peer_records.begin(), peer_records.end(), std::inserter(_potential_peer_set, _potential_peer_set.end()));
+        ilog("imported ${count} peers from ${json_filename}", ("count", _potential_peer_set.size())("json_filename", json_filename));
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
+             ("peer_database_filename", json_filename));
+      }
+    }
+
+    void peer_database_impl::prune()
+    {
+      if (_potential_peer_set.size() <= MAXIMUM_PEERDB_SIZE)
+        return;
+      // prune database to a reasonable size, dropping the peers we'd be least likely to connect to
+      std::vector<std::pair<int64_t, fc::ip::endpoint> > scored_endpoints;
+      scored_endpoints.reserve(_potential_peer_set.size());
+      for (const potential_peer_record& record : _potential_peer_set)
+        scored_endpoints.emplace_back(record.selection_score(), record.endpoint);
+      auto first_to_drop = scored_endpoints.begin() + MAXIMUM_PEERDB_SIZE;
+      std::nth_element(scored_endpoints.begin(), first_to_drop, scored_endpoints.end(),
+                       [](const std::pair<int64_t, fc::ip::endpoint>& a, const std::pair<int64_t, fc::ip::endpoint>& b) { return a.first > b.first; });
+      for (auto iter = first_to_drop; iter != scored_endpoints.end(); ++iter)
+        _potential_peer_set.get<endpoint_index>().erase(iter->second);
+    }
+
+    void peer_database_impl::compact()
+    {
+      if (_log.is_open())
+        _log.close();
+
+      fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
+      if (!fc::exists(peer_database_filename_dir))
+        fc::create_directories(peer_database_filename_dir);
+
+      fc::path temp_filename = _peer_database_filename.generic_string() + ".tmp";
+      {
+        std::ofstream out(temp_filename.generic_string(), std::ios::out | std::ios::binary | std::ios::trunc);
+        out.write((const char*)&peer_database_log_magic, sizeof(peer_database_log_magic));
+        peer_database_log_entry entry;
+        for (const potential_peer_record& record : _potential_peer_set)
         {
-          elog("error opening peer database file ${peer_database_filename}, starting with a clean database", 
-               ("peer_database_filename", _peer_database_filename));
+          entry.record = record;
+          std::vector<char> packed_entry = fc::raw::pack(entry);
+          uint32_t entry_size = packed_entry.size();
+          out.write((const char*)&entry_size, sizeof(entry_size));
+          out.write(packed_entry.data(), packed_entry.size());
         }
+        out.flush();
+        FC_ASSERT(out, "unable to write ${temp_filename}", ("temp_filename", temp_filename));
       }
+      fc::rename(temp_filename, _peer_database_filename);
+      _log_entry_count = _potential_peer_set.size();
+
+      _log.open(_peer_database_filename.generic_string(), std::ios::out | std::ios::binary | std::ios::app);
     }
 
-    void peer_database_impl::close()
+    void peer_database_impl::append_to_log(const peer_database_log_entry& entry)
     {
-      std::vector<potential_peer_record> peer_records;
-      peer_records.reserve(_potential_peer_set.size());
-      std::copy(_potential_peer_set.begin(), _potential_peer_set.end(), std::back_inserter(peer_records));
+      if (!_log.is_open())
+        return;
+      try
+      {
+        if (_log_entry_count >= 2 * _potential_peer_set.size() + peer_database_min_superseded_entries)
+        {
+          compact();
+          return;
+        }
+        std::vector<char> packed_entry = fc::raw::pack(entry);
+        uint32_t entry_size = packed_entry.size();
+        _log.write((const char*)&entry_size, sizeof(entry_size));
+        _log.write(packed_entry.data(), packed_entry.size());
+        _log.flush();
+        ++_log_entry_count;
+      }
+      catch (const fc::exception& e)
+      {
+        elog("error writing peer database file ${peer_database_filename}: ${e}",
+             ("peer_database_filename", _peer_database_filename)("e", e));
+      }
+    }
 
+    void peer_database_impl::close()
+    {
       try
       {
-        fc::path peer_database_filename_dir = _peer_database_filename.parent_path();
-        if (!fc::exists(peer_database_filename_dir))
-          fc::create_directories(peer_database_filename_dir);
-        fc::json::save_to_file( peer_records, _peer_database_filename, GRAPHENE_NET_MAX_NESTED_OBJECTS );
+        if (_log.is_open() && _log_entry_count > _potential_peer_set.size())
+          compact();
       }
       catch (const fc::exception& e)
       {
         elog("error saving peer database to file ${peer_database_filename}", 
              ("peer_database_filename", _peer_database_filename));
       }
+      _log.close();
       _potential_peer_set.clear();
     }
 
     void peer_database_impl::clear()
     {
       _potential_peer_set.clear();
+      if (_log.is_open())
+      {
+        try
+        {
+          compact();
+        }
+        catch (const fc::exception& e)
+        {
+          elog("error clearing peer database file ${peer_database_filename}: ${e}",
+               ("peer_database_filename", _peer_database_filename)("e", e));
+        }
+      }
     }
 
     void peer_database_impl::erase(const fc::ip::endpoint& endpointToErase)
     {
       auto iter = _potential_peer_set.get<endpoint_index>().find(endpointToErase);
       if (iter != _potential_peer_set.get<endpoint_index>().end())
+      {
         _potential_peer_set.get<endpoint_index>().erase(iter);
+        peer_database_log_entry entry;
+        entry.erased = true;
+        entry.record.endpoint = endpointToErase;
+        append_to_log(entry);
+      }
     }
 
     void peer_database_impl::update_entry(const potential_peer_record& updatedRecord)
@@ -152,6 +348,9 @@ namespace graphene { namespace net {
         _potential_peer_set.get<endpoint_index>().modify(iter, [&updatedRecord](potential_peer_record& record) { record = updatedRecord; });
       else
         _potential_peer_set.get<endpoint_index>().insert(updatedRecord);
+      peer_database_log_entry entry;
+      entry.record = updatedRecord;
+      append_to_log(entry);
     }
 
     potential_peer_record peer_database_impl::lookup_or_create_entry_for_endpoint(const fc::ip::endpoint& endpointToLookup)
@@ -223,9 +422,9 @@ namespace graphene { namespace net {
   peer_database::~peer_database()
   {}
 
-  void peer_database::open(const fc::path& databaseFilename)
+  void peer_database::open(const fc::path& databaseFilename, const fc::path& legacy_json_filename)
   {
-    my->open(databaseFilename);
+    my->open(databaseFilename, legacy_json_filename);
   }
 
   void peer_database::close()
@@ -36,10 +36,18 @@
 
 namespace graphene { namespace net {
 
+namespace {
+   /** large enough for a few blocks, a multiple of the aes block size */
+   const size_t stcp_buffer_length = 64 * 1024;
+}
+
 stcp_socket::stcp_socket()
 //:_buf_len(0)
+   : _read_buffer_begin(0),
+     _read_buffer_end(0),
+     _write_buffer_used(0)
 #ifndef NDEBUG
-   : _read_buffer_in_use(false),
+   , _read_buffer_in_use(false),
      _write_buffer_in_use(false)
 #endif
 {
@@ -83,7 +91,8 @@ void stcp_socket::bind( const fc::ip::endpoint& local_endpoint )
 /**
  *   This method must read at least 16 bytes at a time from
  *   the underlying TCP socket so that it can decrypt them. It
- *   will buffer any left-over.
+ *   decrypts whatever the socket has available and buffers
+ *   what the caller did not ask for.
  */
 size_t stcp_socket::readsome( char* buffer, size_t len )
 { try {
@@ -100,20 +109,28 @@ size_t stcp_socket::readsome( char* buffer, size_t len )
     } buffer_in_use_checker(_read_buffer_in_use);
 #endif
 
-    const size_t read_buffer_length = 4096;
-    if (!_read_buffer)
-      _read_buffer.reset(new char[read_buffer_length], [](char* p){ delete[] p; });
-
-    len = std::min<size_t>(read_buffer_length, len);
-
-    size_t s = _sock.readsome( _read_buffer, len, 0 );
-    if( s % 16 ) 
+    if (_read_buffer_begin == _read_buffer_end)
     {
-      _sock.read(_read_buffer, 16 - (s%16), s);
-      s += 16-(s%16);
+      if (!_read_buffer)
+        _read_buffer.reset(new char[stcp_buffer_length], [](char* p){ delete[] p; });
+
+      size_t s = _sock.readsome( _read_buffer, stcp_buffer_length, 0 );
+      if( s % 16 ) 
+      {
+        _sock.read(_read_buffer, 16 - (s%16), s);
+        s += 16-(s%16);
+      }
+      // decrypted in place, the cipher works on whole blocks
+      _recv_aes.decode( _read_buffer.get(), s, _read_buffer.get() );
+      _read_buffer_begin = 0;
+      _read_buffer_end = s;
     }
-    _recv_aes.decode( _read_buffer.get(), s, buffer );
-    return s;
+
+    // both are multiples of 16, so what is left stays aligned to blocks
+    len = std::min<size_t>(_read_buffer_end - _read_buffer_begin, len);
+    memcpy( buffer, _read_buffer.get() + _read_buffer_begin, len );
+    _read_buffer_begin += len;
+    return len;
 } FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
 
 size_t stcp_socket::readsome( const std::shared_ptr<char>& buf, size_t len, size_t offset ) 
@@ -141,20 +158,14 @@ size_t stcp_socket::writesome( const char* buffer, size_t len )
     } buffer_in_use_checker(_write_buffer_in_use);
 #endif
 
-    const std::size_t write_buffer_length = 4096;
     if (!_write_buffer)
-      _write_buffer.reset(new char[write_buffer_length], [](char* p){ delete[] p; });
-    len = std::min<size_t>(write_buffer_length, len);
-    memset(_write_buffer.get(), 0, len); // just in case aes.encode screws up
-    /**
-     * every sizeof(crypt_buf) bytes the aes channel
-     * has an error and doesn't decrypt properly...  disable
-     * for now because we are going to upgrade to something
-     * better.
-     */
-    uint32_t ciphertext_len = _send_aes.encode( buffer, len, _write_buffer.get() );
+      _write_buffer.reset(new char[stcp_buffer_length], [](char* p){ delete[] p; });
+    if (_write_buffer_used == stcp_buffer_length)
+      write_buffered_data();
+    len = std::min<size_t>(stcp_buffer_length - _write_buffer_used, len);
+    uint32_t ciphertext_len = _send_aes.encode( buffer, len, _write_buffer.get() + _write_buffer_used );
     assert(ciphertext_len == len);
-    _sock.write( _write_buffer, ciphertext_len );
+    _write_buffer_used += ciphertext_len;
     return ciphertext_len;
 } FC_RETHROW_EXCEPTIONS( warn, "", ("len",len) ) }
 
@@ -163,8 +174,18 @@ size_t stcp_socket::writesome( const std::shared_ptr<const char>& buf, size_t le
   return writesome(buf.get() + offset, len);
 }
 
+void stcp_socket::write_buffered_data()
+{
+  if (_write_buffer_used)
+  {
+    _sock.write( _write_buffer, _write_buffer_used );
+    _write_buffer_used = 0;
+  }
+}
+
 void stcp_socket::flush()
 {
+  write_buffered_data();
   _sock.flush();
 }
 
@@ -74,8 +74,14 @@ void data_transaction_plugin::check_data_transaction( const graphene::chain::sig
         // look for expired data_transaction objects, and remove them.
         graphene::chain::database& db = database();
         const auto& dt_idx = db.get_index_type<data_transaction_index>().indices().get<by_create_date_time>();
-
-        while ((!dt_idx.empty()) && (db.head_block_time() > dt_idx.begin()->create_date_time + fc::hours(data_transaction_lifetime)))
-            db.remove(*dt_idx.begin());
+        const auto& state_idx = db.get_index_type<data_transaction_datasource_state_index>().indices().get<by_data_transaction_datasource>();
+
+        while ((!dt_idx.empty()) && (db.head_block_time() > dt_idx.begin()->create_date_time + fc::hours(data_transaction_lifetime))) {
+            const data_transaction_object& dto = *dt_idx.begin();
+            auto state = state_idx.lower_bound(boost::make_tuple(dto.get_id()));
+            while (state != state_idx.end() && state->data_transaction == dto.get_id())
+                db.remove(*state++);
+            db.remove(dto);
+        }
     }
 } FC_LOG_AND_RETHROW() }
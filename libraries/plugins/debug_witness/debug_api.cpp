@@ -29,6 +29,9 @@ class debug_api_impl
       void debug_update_object( const fc::variant_object& update );
       void debug_stream_json_objects( const std::string& filename );
       void debug_stream_json_objects_flush();
+      void debug_enable_execution_profiler( bool enabled );
+      std::vector< graphene::chain::execution_profile_entry > debug_get_execution_profile();
+      void debug_reset_execution_profile();
       std::shared_ptr< graphene::debug_witness_plugin::debug_witness_plugin > get_plugin();
 
       graphene::app::application& app;
@@ -120,6 +123,21 @@ void debug_api_impl::debug_stream_json_objects_flush()
    get_plugin()->flush_json_object_stream();
 }
 
+void debug_api_impl::debug_enable_execution_profiler( bool enabled )
+{
+   app.chain_database()->get_execution_profiler().set_enabled( enabled );
+}
+
+std::vector< graphene::chain::execution_profile_entry > debug_api_impl::debug_get_execution_profile()
+{
+   return app.chain_database()->get_execution_profiler().get_profile();
+}
+
+void debug_api_impl::debug_reset_execution_profile()
+{
+   app.chain_database()->get_execution_profiler().reset();
+}
+
 } // detail
 
 debug_api::debug_api( graphene::app::application& app )
@@ -152,5 +170,20 @@ void debug_api::debug_stream_json_objects_flush()
    my->debug_stream_json_objects_flush();
 }
 
+void debug_api::debug_enable_execution_profiler( bool enabled )
+{
+   my->debug_enable_execution_profiler( enabled );
+}
+
+std::vector< graphene::chain::execution_profile_entry > debug_api::debug_get_execution_profile()
+{
+   return my->debug_get_execution_profile();
+}
+
+void debug_api::debug_reset_execution_profile()
+{
+   my->debug_reset_execution_profile();
+}
+
 
 } } // graphene::debug_witness
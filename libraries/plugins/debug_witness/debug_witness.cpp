@@ -114,7 +114,7 @@ void debug_witness_plugin::on_changed_objects( const std::vector<graphene::db::o
          const graphene::db::object* obj = db.find_object( oid );
          if( obj != nullptr )
          {
-            (*_json_object_stream) << fc::json::to_string( obj->to_variant() ) << '\n';
+            (*_json_object_stream) << obj->to_json() << '\n';
          }
       }
    }
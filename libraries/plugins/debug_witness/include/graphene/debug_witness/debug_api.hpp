@@ -26,6 +26,8 @@
 #include <memory>
 #include <string>
 
+#include <graphene/chain/execution_profiler.hpp>
+
 #include <fc/api.hpp>
 #include <fc/variant_object.hpp>
 
@@ -82,6 +84,21 @@ class debug_api
        */
       void debug_stream_json_objects_flush();
 
+      /**
+       * Start or stop collecting latency histograms of operations, contract actions and block and transaction phases.
+       */
+      void debug_enable_execution_profiler( bool enabled );
+
+      /**
+       * Get the latency histograms collected so far.
+       */
+      std::vector< graphene::chain::execution_profile_entry > debug_get_execution_profile();
+
+      /**
+       * Drop the latency histograms collected so far.
+       */
+      void debug_reset_execution_profile();
+
       std::shared_ptr< detail::debug_api_impl > my;
 };
 
@@ -93,4 +110,7 @@ FC_API(graphene::debug_witness::debug_api,
        (debug_update_object)
        (debug_stream_json_objects)
        (debug_stream_json_objects_flush)
+       (debug_enable_execution_profiler)
+       (debug_get_execution_profile)
+       (debug_reset_execution_profile)
      )
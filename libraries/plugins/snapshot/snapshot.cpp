@@ -105,7 +105,7 @@ static void create_snapshot( const graphene::chain::database& db, const fc::path
          }
          auto& index = db.get_index( (uint8_t)space_id, (uint8_t)type_id );
          index.inspect_all_objects( [&out]( const graphene::db::object& o ) {
-            out << fc::json::to_string( o.to_variant() ) << '\n';
+            out << o.to_json() << '\n';
          });
       }
    out.close();
@@ -271,6 +271,7 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       return block_production_condition::lag;
    }
 
+   fc::time_point generate_start = fc::time_point::now();
    auto block = db.generate_block(
       scheduled_time,
       scheduled_witness,
@@ -278,7 +279,14 @@ block_production_condition::block_production_condition_enum witness_plugin::mayb
       _production_skip_flags
       );
    capture("n", block.block_num())("t", block.timestamp)("c", now);
-   fc::async( [this,block](){ p2p_node().broadcast(net::block_message(block)); } );
+   const int64_t generate_us = ( fc::time_point::now() - generate_start ).count();
+   fc::async( [this,block,scheduled_time,generate_us](){
+      p2p_node().broadcast(net::block_message(block));
+      // negative when the block is produced ahead of its slot time
+      const int64_t latency_us = ( fc::time_point::now() - fc::time_point( scheduled_time ) ).count();
+      ilog( "Block #${n} with ${x} transactions generated in ${g} us, broadcast ${l} us after its slot time",
+            ("n", block.block_num())("x", block.transactions.size())("g", generate_us)("l", latency_us) );
+   } );
 
    return block_production_condition::produced;
 }
@@ -1281,7 +1281,7 @@ class wallet_api
        * @param request_id
        * @return
        */
-      optional<data_transaction_object> get_data_transaction_by_request_id(string request_id) const;
+      optional<data_transaction_api_object> get_data_transaction_by_request_id(string request_id) const;
 
       /** Creates a new account and registers it on the blockchain.
        *
@@ -1984,7 +1984,7 @@
            return _remote_db->list_total_second_hand_transaction_counts_by_datasource(start_date_time, end_date_time, *acct_id);
        }
 
-       optional<data_transaction_object> get_data_transaction_by_request_id(string request_id) const {
+       optional<data_transaction_api_object> get_data_transaction_by_request_id(string request_id) const {
            return _remote_db->get_data_transaction_by_request_id(request_id);
        }
 
@@ -4219,7 +4219,7 @@
         return my->list_data_transactions_by_requester(requester, limit);
     }
 
-    optional<data_transaction_object> wallet_api::get_data_transaction_by_request_id(string request_id) const
+    optional<data_transaction_api_object> wallet_api::get_data_transaction_by_request_id(string request_id) const
     {
         return my->get_data_transaction_by_request_id(request_id);
     }
@@ -0,0 +1,105 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+
+#include <fc/exception/exception.hpp>
+#include <fc/filesystem.hpp>
+
+#include <graphene/chain/block_database.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+using namespace graphene::chain;
+namespace bpo = boost::program_options;
+
+uint64_t directory_size( const fc::path& dir )
+{
+   uint64_t size = 0;
+   for( const char* name : { "blocks", "index", "chunks", "chunk_index", "block_ids", "chunk_header" } )
+      if( fc::exists( dir / name ) )
+         size += fc::file_size( dir / name );
+   return size;
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Moves the blocks of a stopped node into the compressed block log");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("data-dir,d", bpo::value<boost::filesystem::path>()->default_value("witness_node_data_dir"), "Data directory of the node")
+            ("keep-recent,k", bpo::value<uint32_t>()->default_value(10000), "Number of recent blocks to leave uncompressed")
+            ("blocks-per-chunk,c", bpo::value<uint32_t>()->default_value(compressed_block_log::default_blocks_per_chunk),
+             "Number of blocks compressed together, only used when the compressed block log is created")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         bpo::store( bpo::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const bpo::error& e)
+      {
+         std::cerr << "compress_block_log:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+
+      fc::path data_dir = options["data-dir"].as<boost::filesystem::path>();
+      fc::path block_db_dir = data_dir / "blockchain" / "database" / "block_num_to_block";
+      if( !fc::exists( block_db_dir / "index" ) )
+      {
+         std::cerr << "compress_block_log:  no block database in " << block_db_dir.preferred_string() << "\n";
+         return 1;
+      }
+
+      const uint64_t size_before = directory_size( block_db_dir );
+      block_database blocks;
+      blocks.open( block_db_dir );
+      optional<block_id_type> last_id = blocks.last_id();
+      if( !last_id.valid() )
+      {
+         std::cerr << "compress_block_log:  the block database is empty\n";
+         return 1;
+      }
+      const uint32_t head_block_num = block_header::num_from_id( *last_id );
+      const uint32_t keep_recent = options["keep-recent"].as<uint32_t>();
+      if( head_block_num > keep_recent )
+         blocks.archive_blocks( head_block_num - keep_recent, options["blocks-per-chunk"].as<uint32_t>() );
+      const uint32_t archived = blocks.archive().empty() ? 0 : blocks.archive().last_block_num();
+      blocks.close();
+
+      std::cout << "head block " << head_block_num << ", blocks 1 to " << archived << " compressed, "
+                << size_before << " bytes before, " << directory_size( block_db_dir ) << " bytes after\n";
+      return 0;
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cerr << e.to_detail_string() << "\n";
+      return 1;
+   }
+}
@@ -30,6 +30,11 @@
 
 #include <graphene/account_history/account_history_plugin.hpp>
 
+#include <graphene/net/core_messages.hpp>
+#include <graphene/net/message_compression.hpp>
+#include <graphene/net/message_oriented_connection.hpp>
+
+#include <fc/network/tcp_socket.hpp>
 #include <fc/thread/thread.hpp>
 #include <fc/smart_ref_impl.hpp>
 
@@ -79,6 +84,8 @@ BOOST_AUTO_TEST_CASE( two_node_network )
       BOOST_REQUIRE_EQUAL(app1.p2p_node()->get_connection_count(), 1);
       BOOST_CHECK_EQUAL(std::string(app1.p2p_node()->get_connected_peers().front().host.get_address()), "127.0.0.1");
       BOOST_TEST_MESSAGE( "app1 and app2 successfully connected" );
+      BOOST_CHECK( app1.p2p_node()->get_advanced_node_parameters()["enable_compression"].as_bool() );
+      BOOST_CHECK( app1.p2p_node()->get_connected_peers().front().info.contains("compression") );
 
       std::shared_ptr<chain::database> db1 = app1.chain_database();
       std::shared_ptr<chain::database> db2 = app2.chain_database();
@@ -137,16 +144,189 @@ BOOST_AUTO_TEST_CASE( two_node_network )
          database::skip_nothing);
 
       BOOST_TEST_MESSAGE( "Broadcasting block" );
+      fc::time_point broadcast_time = fc::time_point::now();
       app2.p2p_node()->broadcast(graphene::net::block_message( block_1 ));
 
-      fc::usleep(fc::milliseconds(500));
+      while( db1->head_block_num() < 1 && fc::time_point::now() - broadcast_time < fc::milliseconds(500) )
+         fc::usleep(fc::milliseconds(1));
+      BOOST_TEST_MESSAGE( "Block propagated in " + fc::to_string( (fc::time_point::now() - broadcast_time).count() ) + " us" );
+      fc::usleep(fc::milliseconds(100));
       BOOST_TEST_MESSAGE( "Verifying nodes are still connected" );
       BOOST_CHECK_EQUAL(app1.p2p_node()->get_connection_count(), 1);
       BOOST_CHECK_EQUAL(app1.chain_database()->head_block_num(), 1);
 
+      BOOST_TEST_MESSAGE( "Verifying the block was relayed as a compact block" );
+      // app1 relayed the transaction, so the block only carries its short id
+      fc::variant_object sent = app2.p2p_node()->network_get_info()["compact_blocks"].get_object();
+      fc::variant_object received = app1.p2p_node()->network_get_info()["compact_blocks"].get_object();
+      BOOST_CHECK_EQUAL( sent["sent"].as_uint64(), 1 );
+      BOOST_CHECK_GT( sent["bytes_saved"].as_uint64(), 0 );
+      BOOST_CHECK_EQUAL( received["received"].as_uint64(), 1 );
+      BOOST_CHECK_EQUAL( received["reconstructed_from_cache"].as_uint64(), 1 );
+      BOOST_CHECK_EQUAL( received["transactions_requested"].as_uint64(), 0 );
+
+      BOOST_TEST_MESSAGE( "Syncing app3 from app1 with compressed blocks" );
+      // a syncing node fetches block 1 whole, above the lowered threshold of its connection to app1
+      app1.p2p_node()->set_advanced_node_parameters( fc::mutable_variant_object()( "min_compressed_message_size", 64 ) );
+      fc::temp_directory app3_dir( graphene::utilities::temp_directory_path() );
+      graphene::app::application app3;
+      app3.register_plugin<account_history::account_history_plugin>();
+      auto cfg3 = cfg2;
+      cfg3.erase("p2p-endpoint");
+      cfg3.emplace("p2p-endpoint", boost::program_options::variable_value(string("127.0.0.1:4141"), false));
+      app3.initialize(app3_dir.path(), cfg3);
+      app3.startup();
+      fc::time_point sync_start = fc::time_point::now();
+      while( app3.chain_database()->head_block_num() < 1 && fc::time_point::now() - sync_start < fc::seconds(5) )
+         fc::usleep(fc::milliseconds(10));
+      BOOST_REQUIRE_EQUAL( app3.chain_database()->head_block_num(), 1 );
+      fc::variant_object compressed = app1.p2p_node()->get_advanced_node_parameters()["compression"].get_object();
+      fc::variant_object decompressed = app3.p2p_node()->get_advanced_node_parameters()["compression"].get_object();
+      BOOST_CHECK_GT( compressed["messages_compressed"].as_uint64(), 0 );
+      BOOST_CHECK_GT( compressed["bytes_before_compression"].as_uint64(), 0 );
+      BOOST_CHECK_GT( decompressed["messages_decompressed"].as_uint64(), 0 );
+      BOOST_CHECK_GT( decompressed["bytes_after_decompression"].as_uint64(), 0 );
+
       BOOST_TEST_MESSAGE( "Checking GRAPHENE_NULL_ACCOUNT has balance" );
    } catch( fc::exception& e ) {
       edump((e.to_detail_string()));
       throw;
    }
 }
+
+BOOST_AUTO_TEST_CASE( compressed_message_round_trip )
+{
+   using namespace graphene::net;
+   try {
+      std::vector<message> originals;
+      for( uint32_t i = 0; i < 3; ++i )
+      {
+         message m;
+         m.msg_type = core_message_type_enum::block_message_type;
+         m.data.resize( 4096 );
+         for( size_t j = 0; j < m.data.size(); ++j )
+            m.data[j] = char( ( j * 7 + i ) % 61 );
+         m.size = m.data.size();
+         originals.push_back( m );
+      }
+      // the same data again, the deflate stream still has it in its window
+      originals.push_back( originals.front() );
+
+      deflate_stream deflater;
+      inflate_stream inflater;
+      std::vector<uint32_t> compressed_sizes;
+      for( const message& original : originals )
+      {
+         message compressed = compress_message( deflater, original );
+         BOOST_CHECK_EQUAL( compressed.msg_type, core_message_type_enum::compressed_message_type );
+         BOOST_CHECK_LT( compressed.size, original.size );
+         compressed_sizes.push_back( compressed.size );
+
+         message restored = decompress_message( inflater, compressed );
+         BOOST_CHECK_EQUAL( restored.msg_type, original.msg_type );
+         BOOST_CHECK_EQUAL( restored.size, original.size );
+         BOOST_CHECK( restored.data == original.data );
+      }
+      BOOST_CHECK_LT( compressed_sizes.back(), compressed_sizes.front() );
+
+      // a damaged deflate stream, a size that does not match the data and a truncated header are all rejected
+      {
+         deflate_stream d;
+         inflate_stream i;
+         message corrupt = compress_message( d, originals.front() );
+         std::fill( corrupt.data.begin() + 2 * sizeof(uint32_t), corrupt.data.end(), char(0xff) );
+         BOOST_CHECK_THROW( decompress_message( i, corrupt ), fc::exception );
+      }
+      {
+         deflate_stream d;
+         inflate_stream i;
+         message wrong_size = compress_message( d, originals.front() );
+         uint32_t original_size = originals.front().size + 1;
+         memcpy( wrong_size.data.data() + sizeof(uint32_t), &original_size, sizeof(original_size) );
+         BOOST_CHECK_THROW( decompress_message( i, wrong_size ), fc::exception );
+      }
+      {
+         inflate_stream i;
+         message truncated;
+         truncated.msg_type = core_message_type_enum::compressed_message_type;
+         truncated.data.resize( 3 );
+         truncated.size = truncated.data.size();
+         BOOST_CHECK_THROW( decompress_message( i, truncated ), fc::exception );
+      }
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+namespace {
+
+struct recording_delegate : graphene::net::message_oriented_connection_delegate
+{
+   std::vector<graphene::net::message> received;
+   bool closed = false;
+
+   void on_message( graphene::net::message_oriented_connection*, const graphene::net::message& m ) override
+   {
+      received.push_back( m );
+   }
+   void on_connection_closed( graphene::net::message_oriented_connection* ) override
+   {
+      closed = true;
+   }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE( corrupt_compressed_message_disconnects )
+{
+   using namespace graphene::net;
+   try {
+      recording_delegate receiver_delegate;
+      recording_delegate sender_delegate;
+      message_oriented_connection receiver( &receiver_delegate );
+      message_oriented_connection sender( &sender_delegate );
+
+      fc::tcp_server server;
+      server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+      fc::future<void> accepted = fc::async( [&]() {
+         server.accept( receiver.get_socket() );
+         receiver.accept();
+      }, "accept" );
+      sender.connect_to( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), server.get_port() ) );
+      accepted.wait();
+
+      auto wait_for = [&]( std::function<bool()> done ) {
+         fc::time_point start = fc::time_point::now();
+         while( !done() && fc::time_point::now() - start < fc::seconds(5) )
+            fc::usleep( fc::milliseconds(10) );
+      };
+
+      message m;
+      m.msg_type = core_message_type_enum::block_message_type;
+      m.data.assign( 1024, 'b' );
+      m.size = m.data.size();
+
+      // compressed messages are unwrapped before the delegate sees them
+      sender.enable_compression( 256 );
+      sender.send_message( m );
+      wait_for( [&]() { return receiver_delegate.received.size() == 1; } );
+      BOOST_REQUIRE_EQUAL( receiver_delegate.received.size(), 1 );
+      BOOST_CHECK_EQUAL( receiver_delegate.received.front().msg_type, m.msg_type );
+      BOOST_CHECK( receiver_delegate.received.front().data == m.data );
+      BOOST_CHECK_EQUAL( sender.get_compression_stats().messages_compressed, 1 );
+      BOOST_CHECK_EQUAL( receiver.get_compression_stats().messages_decompressed, 1 );
+
+      // a frame that does not inflate closes the connection
+      deflate_stream other_stream;
+      message corrupt = compress_message( other_stream, m );
+      std::fill( corrupt.data.begin() + 2 * sizeof(uint32_t), corrupt.data.end(), char(0xff) );
+      sender.send_message( corrupt );
+      wait_for( [&]() { return receiver_delegate.closed; } );
+      BOOST_CHECK( receiver_delegate.closed );
+      BOOST_CHECK_EQUAL( receiver_delegate.received.size(), 1 );
+   } catch( fc::exception& e ) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,120 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/abi_serializer.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "bench_timing.hpp"
+
+using namespace graphene::chain;
+using graphene::chain::test::time_us;
+
+namespace {
+
+/** the tables of the redpacket example contract */
+const char* redpacket_abi = R"({
+   "version": "gjc::abi/1.0",
+   "types": [],
+   "structs": [
+      { "name": "packet", "base": "", "fields": [{ "name": "issuer", "type": "uint64" },
+                                                 { "name": "pub_key", "type": "string" },
+                                                 { "name": "total_amount", "type": "contract_asset" },
+                                                 { "name": "number", "type": "uint32" },
+                                                 { "name": "subpackets", "type": "int64[]" }] },
+      { "name": "account", "base": "", "fields": [{ "name": "account_id", "type": "uint64" },
+                                                  { "name": "amount", "type": "int64" }] },
+      { "name": "record", "base": "", "fields": [{ "name": "packet_issuer", "type": "uint64" },
+                                                 { "name": "accounts", "type": "account[]" }] }
+   ],
+   "actions": [],
+   "tables": [{ "name": "packet", "index_type": "i64", "key_names": ["issuer"], "key_types": ["uint64"], "type": "packet" },
+              { "name": "record", "index_type": "i64", "key_names": ["packet_issuer"], "key_types": ["uint64"], "type": "record" }],
+   "error_messages": [],
+   "abi_extensions": []
+})";
+
+}
+
+/** Unpacks and packs redpacket table rows with the compiled type plans and by type name. */
+BOOST_AUTO_TEST_CASE( abi_serializer_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t rows = 20000;
+#else
+      const uint32_t rows = 2000;
+#endif
+      const auto limit = fc::seconds( 60 );
+      const abi_serializer planned( fc::json::from_string( redpacket_abi ).as<abi_def>( GRAPHENE_MAX_NESTED_OBJECTS ), limit );
+      abi_serializer by_name( planned );
+      by_name.clear_type_plans();
+
+      fc::mutable_variant_object record;
+      fc::variants accounts;
+      for( uint64_t i = 0; i < 20; ++i )
+         accounts.emplace_back( fc::mutable_variant_object( "account_id", 100 + i )( "amount", int64_t( i * 1000 ) ) );
+      record( "packet_issuer", 17 )( "accounts", fc::variant( accounts, 3 ) );
+      const fc::variant record_var( record, 4 );
+      const fc::variant packet_var( fc::mutable_variant_object( "issuer", 17 )( "pub_key", "GJC6MRyAjQq8ud7hVNYcfnVPJqcVpscN5So8BhtHuGYqET5GDW5CV" )
+                                    ( "total_amount", fc::mutable_variant_object( "amount", 100000 )( "asset_id", 1 ) )
+                                    ( "number", 10 )( "subpackets", fc::variant( std::vector<int64_t>( 10, 10000 ), 2 ) ), 3 );
+
+      for( const auto& table : { std::make_pair( "record", record_var ), std::make_pair( "packet", packet_var ) } )
+      {
+         const bytes packed = planned.variant_to_binary( table.first, table.second, limit );
+         BOOST_REQUIRE( packed == by_name.variant_to_binary( table.first, table.second, limit ) );
+
+         fc::variant planned_row, by_name_row;
+         const int64_t planned_unpack = time_us( [&]() {
+            for( uint32_t i = 0; i < rows; ++i )
+               planned_row = planned.binary_to_variant( table.first, packed, limit );
+         } );
+         const int64_t by_name_unpack = time_us( [&]() {
+            for( uint32_t i = 0; i < rows; ++i )
+               by_name_row = by_name.binary_to_variant( table.first, packed, limit );
+         } );
+         BOOST_CHECK_EQUAL( fc::json::to_string( planned_row ), fc::json::to_string( by_name_row ) );
+
+         std::vector<char> buffer( packed.size() );
+         const int64_t planned_pack = time_us( [&]() {
+            for( uint32_t i = 0; i < rows; ++i )
+            {
+               fc::datastream<char*> ds( buffer.data(), buffer.size() );
+               planned.variant_to_binary( table.first, table.second, ds, limit );
+            }
+         } );
+         const int64_t by_name_pack = time_us( [&]() {
+            for( uint32_t i = 0; i < rows; ++i )
+            {
+               fc::datastream<char*> ds( buffer.data(), buffer.size() );
+               by_name.variant_to_binary( table.first, table.second, ds, limit );
+            }
+         } );
+
+         ilog( "${t}: ${n} rows of ${b} bytes, unpack ${pu} ms planned / ${nu} ms by name, pack ${pp} ms planned / ${np} ms by name",
+               ("t", table.first)("n", rows)("b", packed.size())("pu", planned_unpack / 1000)("nu", by_name_unpack / 1000)
+               ("pp", planned_pack / 1000)("np", by_name_pack / 1000) );
+      }
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
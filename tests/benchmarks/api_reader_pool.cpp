@@ -0,0 +1,121 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/database_api.hpp>
+#include <graphene/app/api_reader_pool.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include <atomic>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+using namespace graphene::app;
+
+/**
+ *  Local client driver: client threads keep issuing get_full_accounts and get_objects, dispatched to the main
+ *  thread as the websocket server does, while the main thread pushes transfers and produces blocks.  Runs once
+ *  with the calls on the main thread and once on reader threads, and reports the block production time and the
+ *  API latency histograms of both modes.
+ */
+BOOST_FIXTURE_TEST_CASE( api_reader_pool_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t account_count = 2000;
+      const uint32_t block_count = 200;
+#else
+      const uint32_t account_count = 200;
+      const uint32_t block_count = 20;
+#endif
+      const uint32_t client_count = 8;
+      const uint32_t transfers_per_block = 20;
+
+      vector<string> names;
+      vector<account_id_type> accounts;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         names.push_back( "reader-bench-" + fc::to_string( uint64_t(i) ) );
+         accounts.push_back( create_account( names.back() ).id );
+      }
+      generate_block();
+      const uint32_t first_block = db.head_block_num();
+
+      vector<object_id_type> ids( accounts.begin(), accounts.end() );
+      auto pool = api_reader_pool::get( db );
+      database_api api( db );
+      fc::thread& main_thread = fc::thread::current();
+
+      for( uint32_t reader_threads : { 0u, 4u } )
+      {
+         pool->set_thread_count( reader_threads );
+         pool->clear_latency_metrics();
+
+         std::atomic<bool> done{ false };
+         vector< std::unique_ptr<fc::thread> > clients;
+         vector< fc::future<void> > runs;
+         for( uint32_t c = 0; c < client_count; ++c )
+         {
+            clients.emplace_back( new fc::thread( "api_client_" + fc::to_string( uint64_t(c) ) ) );
+            runs.push_back( clients.back()->async( [&,c]() {
+               const uint32_t first = c * 10 % ( account_count - 10 );
+               vector<string> batch( names.begin() + first, names.begin() + first + 10 );
+               while( !done )
+               {
+                  main_thread.async( [&]() { api.get_full_accounts( batch, false ); } ).wait();
+                  main_thread.async( [&]() { api.get_objects( ids ); } ).wait();
+               }
+            }) );
+         }
+
+         int64_t block_us = 0;
+         for( uint32_t b = 0; b < block_count; ++b )
+         {
+            fc::time_point start = fc::time_point::now();
+            for( uint32_t t = 0; t < transfers_per_block; ++t )
+               transfer( account_id_type(), accounts[( b * transfers_per_block + t ) % account_count], asset( 1 ) );
+            generate_block();
+            block_us += ( fc::time_point::now() - start ).count();
+            fc::yield();
+         }
+
+         done = true;
+         for( auto& run : runs )
+            run.wait();
+         for( auto& client : clients )
+            client->quit();
+
+         ilog( "${r} reader threads: ${b} blocks of ${t} transfers in ${ms} ms",
+               ("r", reader_threads)("b", block_count)("t", transfers_per_block)("ms", block_us / 1000) );
+         for( const auto& histogram : api.get_api_latency_metrics().methods )
+            ilog( "   ${m}: ${n} calls, mean ${a} us, p50 <= ${p50} us, p99 <= ${p99} us, max ${x} us",
+                  ("m", histogram.method)("n", histogram.count)("a", histogram.total_us / std::max<uint64_t>( histogram.count, 1 ))
+                  ("p50", histogram.p50_us)("p99", histogram.p99_us)("x", histogram.max_us) );
+      }
+
+      pool->set_thread_count( 0 );
+      BOOST_CHECK_EQUAL( db.head_block_num(), first_block + 2 * block_count );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
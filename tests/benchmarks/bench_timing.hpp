@@ -0,0 +1,34 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <fc/time.hpp>
+
+namespace graphene { namespace chain { namespace test {
+
+/** @return the wall clock time f takes to run, in microseconds */
+template<typename Func>
+int64_t time_us( Func&& f )
+{
+   fc::time_point start = fc::time_point::now();
+   f();
+   return ( fc::time_point::now() - start ).count();
+}
+
+} } } // graphene::chain::test
@@ -0,0 +1,143 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/block_database.hpp>
+#include <graphene/chain/protocol/fee_schedule.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/crypto/digest.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "bench_timing.hpp"
+
+#include <cstring>
+#include <random>
+
+using namespace graphene::chain;
+using graphene::chain::test::time_us;
+
+namespace {
+
+/** blocks of a few signed transfers between a small set of accounts */
+signed_block make_block( const block_id_type& previous, uint32_t block_num )
+{
+   signed_block block;
+   block.previous = previous;
+   block.timestamp = fc::time_point_sec( 1500000000 + block_num * 3 );
+   block.witness = witness_id_type( block_num % 21 );
+   for( uint32_t t = 0; t < block_num % 5; ++t )
+   {
+      signed_transaction trx;
+      trx.ref_block_num = block_num - 1;
+      trx.ref_block_prefix = previous._hash[1];
+      trx.expiration = block.timestamp + 30;
+      transfer_operation op;
+      op.fee = asset( 2000 );
+      op.from = account_id_type( 100 + ( block_num * 7 + t ) % 500 );
+      op.to = account_id_type( 100 + ( block_num * 13 + t ) % 500 );
+      op.amount = asset( 1000 + block_num % 10000 );
+      trx.operations.push_back( op );
+      auto h = fc::sha256::hash( std::to_string( block_num ) + "/" + std::to_string( t ) );
+      fc::ecc::compact_signature sig;
+      memcpy( sig.data, h.data(), 32 );
+      memcpy( sig.data + 32, fc::sha256::hash( h ).data(), 32 );
+      sig.data[64] = 31;
+      trx.signatures.push_back( sig );
+      block.transactions.push_back( trx );
+   }
+   block.transaction_merkle_root = block.calculate_merkle_root();
+   auto h = fc::sha256::hash( block.digest() );
+   memcpy( block.witness_signature.data, h.data(), 32 );
+   memcpy( block.witness_signature.data + 32, fc::sha256::hash( h ).data(), 32 );
+   return block;
+}
+
+uint64_t block_files_size( const fc::path& dir )
+{
+   uint64_t size = 0;
+   for( const char* name : { "blocks", "index", "chunks", "chunk_index", "block_ids", "chunk_header" } )
+      if( fc::exists( dir / name ) )
+         size += fc::file_size( dir / name );
+   return size;
+}
+
+}
+
+/**
+ *  Compares the plain block database with the compressed block log: size on disk, reading all blocks in order as
+ *  a replay does, and fetching blocks by random number.
+ */
+BOOST_AUTO_TEST_CASE( block_log_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t block_count = 100000;
+#else
+      const uint32_t block_count = 10000;
+#endif
+      const uint32_t random_reads = 10000;
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path dir = data_dir.path() / "block_num_to_block";
+
+      block_database blocks;
+      blocks.open( dir );
+      vector<block_id_type> ids( block_count + 1 );
+      for( uint32_t n = 1; n <= block_count; ++n )
+      {
+         signed_block block = make_block( ids[n - 1], n );
+         ids[n] = block.id();
+         blocks.store( ids[n], block );
+      }
+      blocks.flush();
+
+      std::mt19937 rng( 42 );
+      std::uniform_int_distribution<uint32_t> random_block( 1, block_count );
+      vector<uint32_t> random_nums( random_reads );
+      for( auto& n : random_nums )
+         n = random_block( rng );
+
+      auto measure = [&]( const char* format ) {
+         const uint64_t size = block_files_size( dir );
+         const int64_t sequential = time_us( [&]() {
+            for( uint32_t n = 1; n <= block_count; ++n )
+               BOOST_REQUIRE( blocks.fetch_by_number( n )->id() == ids[n] );
+         } );
+         const int64_t random = time_us( [&]() {
+            for( uint32_t n : random_nums )
+               BOOST_REQUIRE( blocks.fetch_by_number( n )->id() == ids[n] );
+         } );
+         ilog( "${f}: ${n} blocks in ${s} bytes, sequential read ${sq} ms, random fetch_by_number ${r} us per block",
+               ("f", format)("n", block_count)("s", size)("sq", sequential / 1000)("r", random / random_reads) );
+         return size;
+      };
+
+      const uint64_t plain_size = measure( "plain" );
+      const uint32_t archived = blocks.archive_blocks( block_count );
+      BOOST_CHECK_EQUAL( archived, block_count - block_count % compressed_block_log::default_blocks_per_chunk );
+      BOOST_CHECK( blocks.contains( ids[1] ) );
+      BOOST_CHECK( blocks.last_id() == ids[block_count] );
+      const uint64_t compressed_size = measure( "compressed" );
+      BOOST_CHECK_LT( compressed_size, plain_size );
+      blocks.close();
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
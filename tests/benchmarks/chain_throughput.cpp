@@ -0,0 +1,352 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/asset_object.hpp>
+#include <graphene/chain/free_data_product_object.hpp>
+#include <graphene/chain/wast_to_wasm.hpp>
+#include <graphene/chain/abi_def.hpp>
+#include <graphene/chain/execution_profiler.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "../common/database_fixture.hpp"
+#include "../tests/test_wasts.hpp"
+#include "bench_timing.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <random>
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+/** throughput and latency of one measured step, as written to the results file */
+struct chain_bench_result
+{
+   string   name;
+   uint64_t count = 0;
+   uint64_t total_us = 0;
+   uint64_t per_second = 0;
+   uint64_t p50_us = 0;
+   uint64_t p90_us = 0;
+   uint64_t p99_us = 0;
+   uint64_t max_us = 0;
+};
+
+FC_REFLECT( chain_bench_result, (name)(count)(total_us)(per_second)(p50_us)(p90_us)(p99_us)(max_us) )
+
+namespace {
+
+const uint32_t replay_skip = database::skip_witness_signature |
+                             database::skip_transaction_signatures |
+                             database::skip_transaction_dupe_check |
+                             database::skip_tapos_check |
+                             database::skip_witness_schedule_check |
+                             database::skip_authority_check;
+
+/** @param latencies of the measured steps in microseconds, @param items processed by all steps together */
+chain_bench_result summarize( const string& name, const vector<int64_t>& latencies, uint64_t items )
+{
+   latency_histogram histogram;
+   for( int64_t us : latencies )
+      histogram.record( us );
+   chain_bench_result result;
+   result.name = name;
+   result.count = items;
+   result.total_us = histogram.total_us;
+   result.per_second = items * 1000000 / std::max<uint64_t>( result.total_us, 1 );
+   result.p50_us = histogram.percentile( 0.5 );
+   result.p90_us = histogram.percentile( 0.9 );
+   result.p99_us = histogram.percentile( 0.99 );
+   result.max_us = histogram.max_us;
+   return result;
+}
+
+/**
+ *  State the data market and balance lock workloads need: the lock programs, merchant and data transaction
+ *  memberships and a free data product.  Set directly instead of through committee proposals, which take
+ *  maintenance intervals to pass.  Applied at the same block to every database that replays the workload, so that
+ *  object ids match.
+ */
+void prepare_market_state( database& db, const vector<account_id_type>& accounts, account_id_type datasource )
+{
+   db.modify( db.get_global_properties(), []( global_property_object& gpo ) {
+      lock_balance_params_t lock_params;
+      interest_rate_t rate;
+      rate.is_valid = true;
+      lock_params.params.emplace_back( "bench", rate );
+      future_extensions ext = lock_params;
+      gpo.parameters.extensions.insert( ext );
+   });
+   for( account_id_type id : accounts )
+      db.modify( id( db ), []( account_object& a ) {
+         a.merchant_expiration_date = time_point_sec::maximum();
+         a.data_transaction_member_expiration_date = time_point_sec::maximum();
+      });
+   db.create<free_data_product_object>( [&]( free_data_product_object& p ) {
+      p.product_name = "bench-product";
+      p.datasource = datasource;
+      p.issuer = datasource;
+      p.price = 10;
+      p.status = 1;
+      schema_context_object schema;
+      schema.version = "1.0.0";
+      schema.schema_context = "{\"privacy\":\"false\"}";
+      p.schema_contexts.push_back( schema );
+      p.create_date_time = db.head_block_time();
+   });
+}
+
+}
+
+/**
+ *  Drives a chain with a deterministic mix of core transfers, balance locks and unlocks, data market
+ *  request -> upload -> pay flows, contract calls and proposals, and measures pushing the transactions, generating
+ *  the blocks, applying the blocks received from the network and replaying them.
+ *
+ *  The results are logged and, when CHAIN_BENCH_RESULTS names a file, written to it as JSON so that releases can
+ *  be compared.
+ */
+BOOST_FIXTURE_TEST_CASE( chain_throughput_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t account_count = 1000;
+      const uint32_t round_count = 20;
+#else
+      const uint32_t account_count = 100;
+      const uint32_t round_count = 5;
+#endif
+      std::mt19937 rng( 20180701 );
+
+      // accounts, a contract and the GXS asset locks are made of
+      const asset_object& gxs = create_user_issued_asset( "GXS" );
+      BOOST_REQUIRE( gxs.id == GRAPHENE_GXS_ASSET );
+      vector<fc::ecc::private_key> keys;
+      vector<account_id_type> accounts;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         const string name = "bench-" + fc::to_string( uint64_t(i) );
+         keys.push_back( generate_private_key( name ) );
+         accounts.push_back( create_account( name, keys.back().get_public_key() ).id );
+      }
+      const account_id_type datasource = create_account( "bench-datasource" ).id;
+      generate_block();
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         transfer( account_id_type(), accounts[i], asset( 1000000 ) );
+         issue_uia( accounts[i], asset( 100 * GRAPHENE_BLOCKCHAIN_PRECISION, GRAPHENE_GXS_ASSET ) );
+      }
+      {
+         contract_deploy_operation deploy_op;
+         deploy_op.account = accounts[0];
+         deploy_op.name = "bench-contract";
+         deploy_op.vm_type = "0";
+         deploy_op.vm_version = "0";
+         auto wasm = graphene::chain::wast_to_wasm( contract_test_wast_code );
+         deploy_op.code = bytes( wasm.begin(), wasm.end() );
+         deploy_op.abi = fc::json::from_string( contract_abi ).as<abi_def>( GRAPHENE_MAX_NESTED_OBJECTS );
+         signed_transaction tx;
+         tx.operations.push_back( deploy_op );
+         set_expiration( db, tx );
+         sign( tx, keys[0] );
+         PUSH_TX( db, tx );
+      }
+      generate_block();
+      const account_id_type contract = get_account( "bench-contract" ).id;
+      const uint32_t setup_head = db.head_block_num();
+      prepare_market_state( db, accounts, datasource );
+      const object_id_type product = db.get_index_type<free_data_product_index>().indices().rbegin()->id;
+
+      // the workload
+      std::map< string, vector<int64_t> > push_latencies;
+      vector<int64_t> generate_latencies;
+      vector< vector<lock_balance_id_type> > locks( account_count );
+      uint64_t request_seq = 0;
+      uint64_t trx_count = 0;
+      auto push = [&]( const string& kind, uint32_t signer, const operation& op ) -> processed_transaction {
+         signed_transaction tx;
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, keys[signer] );
+         processed_transaction result;
+         push_latencies[kind].push_back( time_us( [&]() { result = PUSH_TX( db, tx ); } ) );
+         ++trx_count;
+         return result;
+      };
+      // weights of transfers, locks, data market flows, contract calls and proposals
+      std::discrete_distribution<int> kinds( { 40, 15, 15, 15, 15 } );
+      std::uniform_int_distribution<uint32_t> other_account( 1, account_count - 1 );
+
+      for( uint32_t round = 0; round < round_count; ++round )
+      {
+         for( uint32_t i = 0; i < account_count; ++i )
+         {
+            const account_id_type to = accounts[ ( i + other_account( rng ) ) % account_count ];
+            switch( kinds( rng ) )
+            {
+            case 0:
+            {
+               transfer_operation op;
+               op.from = accounts[i];
+               op.to = to;
+               op.amount = asset( 1 + rng() % 100 );
+               push( "transfer", i, op );
+               break;
+            }
+            case 1:
+               if( locks[i].empty() )
+               {
+                  balance_lock_operation op;
+                  op.account = accounts[i];
+                  op.create_date_time = db.head_block_time();
+                  op.program_id = "bench";
+                  op.amount = asset( GRAPHENE_BLOCKCHAIN_PRECISION, GRAPHENE_GXS_ASSET );
+                  auto ptx = push( "balance_lock", i, op );
+                  locks[i].push_back( lock_balance_id_type( ptx.operation_results[0].get<object_id_type>() ) );
+               }
+               else
+               {
+                  balance_unlock_operation op;
+                  op.account = accounts[i];
+                  op.lock_id = locks[i].back();
+                  push( "balance_unlock", i, op );
+                  locks[i].pop_back();
+               }
+               break;
+            case 2:
+            {
+               const string request_id = "bench-request-" + fc::to_string( request_seq++ );
+               data_transaction_create_operation create_op;
+               create_op.request_id = request_id;
+               create_op.product_id = product;
+               create_op.version = "1.0.0";
+               create_op.params = "{}";
+               create_op.requester = accounts[i];
+               create_op.create_date_time = db.head_block_time();
+               push( "data_transaction_create", i, create_op );
+               data_transaction_datasource_upload_operation upload_op;
+               upload_op.request_id = request_id;
+               upload_op.requester = accounts[i];
+               upload_op.datasource = datasource;
+               push( "data_transaction_datasource_upload", i, upload_op );
+               pay_data_transaction_operation pay_op;
+               pay_op.from = accounts[i];
+               pay_op.to = datasource;
+               pay_op.amount = asset( 10 );
+               pay_op.request_id = request_id;
+               push( "pay_data_transaction", i, pay_op );
+               break;
+            }
+            case 3:
+            {
+               const string data = "123";
+               contract_call_operation op;
+               op.account = accounts[i];
+               op.contract_id = contract;
+               op.method_name = N(hi);
+               op.data = bytes( data.begin(), data.end() );
+               op.fee = db.get_global_properties().parameters.current_fees->calculate_fee( op );
+               push( "contract_call", i, op );
+               break;
+            }
+            default:
+            {
+               transfer_operation proposed;
+               proposed.from = accounts[i];
+               proposed.to = to;
+               proposed.amount = asset( 1 + rng() % 100 );
+               proposal_create_operation create_op;
+               create_op.fee_paying_account = accounts[i];
+               create_op.expiration_time = db.head_block_time() + fc::hours( 1 );
+               create_op.proposed_ops.emplace_back( proposed );
+               auto ptx = push( "proposal_create", i, create_op );
+               proposal_update_operation update_op;
+               update_op.fee_paying_account = accounts[i];
+               update_op.proposal = proposal_id_type( ptx.operation_results[0].get<object_id_type>() );
+               update_op.active_approvals_to_add.insert( accounts[i] );
+               push( "proposal_update", i, update_op );
+               break;
+            }
+            }
+         }
+         generate_latencies.push_back( time_us( [&]() {
+            db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                               database::skip_undo_history_check );
+         } ) );
+      }
+
+      vector<chain_bench_result> results;
+      vector<int64_t> all_pushes;
+      for( const auto& kind : push_latencies )
+      {
+         results.push_back( summarize( "push_transaction/" + kind.first, kind.second, kind.second.size() ) );
+         all_pushes.insert( all_pushes.end(), kind.second.begin(), kind.second.end() );
+      }
+      results.push_back( summarize( "push_transaction", all_pushes, all_pushes.size() ) );
+      results.push_back( summarize( "generate_block", generate_latencies, trx_count ) );
+
+      // the workload blocks as received from the network, then as replayed from the block log
+      vector<signed_block> blocks;
+      for( uint32_t n = 1; n <= db.head_block_num(); ++n )
+         blocks.push_back( *db.fetch_block_by_number( n ) );
+      for( bool replay : { false, true } )
+      {
+         fc::temp_directory dir( graphene::utilities::temp_directory_path() );
+         database other;
+         other.open( dir.path(), [this]{ return genesis_state; }, "test" );
+         for( uint32_t n = 1; n <= setup_head; ++n )
+            PUSH_BLOCK( other, blocks[n - 1], replay_skip );
+         prepare_market_state( other, accounts, datasource );
+         if( replay )
+            other._undo_db.disable();
+
+         vector<int64_t> latencies;
+         for( uint32_t n = setup_head + 1; n <= blocks.size(); ++n )
+         {
+            const auto& block = blocks[n - 1];
+            if( replay )
+               latencies.push_back( time_us( [&]() { other.apply_block( block, replay_skip ); } ) );
+            else
+               latencies.push_back( time_us( [&]() { PUSH_BLOCK( other, block, database::skip_nothing ); } ) );
+         }
+         BOOST_CHECK( other.head_block_id() == db.head_block_id() );
+         results.push_back( summarize( replay ? "replay" : "apply_block", latencies, trx_count ) );
+         other._undo_db.enable();
+         other.close( false );
+      }
+
+      for( const auto& r : results )
+         ilog( "${n}: ${c} in ${t} ms, ${s}/s, p50 ${p50} us, p90 ${p90} us, p99 ${p99} us, max ${m} us",
+               ("n", r.name)("c", r.count)("t", r.total_us / 1000)("s", r.per_second)
+               ("p50", r.p50_us)("p90", r.p90_us)("p99", r.p99_us)("m", r.max_us) );
+      if( const char* path = std::getenv( "CHAIN_BENCH_RESULTS" ) )
+         fc::json::save_to_file( results, fc::path( path ) );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
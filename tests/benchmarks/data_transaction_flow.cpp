@@ -0,0 +1,99 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/data_transaction_object.hpp>
+#include <graphene/chain/protocol/data_transaction_ops.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+
+/**
+ *  Replays the request -> datasource upload -> pay state transitions of data transactions on a bare database,
+ *  one undo session per request like block application does, and reports the throughput.
+ */
+BOOST_AUTO_TEST_CASE( data_transaction_flow_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t request_count = 200000;
+#else
+      const uint32_t request_count = 20000;
+#endif
+      const uint32_t datasource_count = 8;
+      const string params( 2048, 'p' );
+
+      database db;
+      db._undo_db.enable();
+
+      fc::time_point start_time = fc::time_point::now();
+      for( uint32_t i = 0; i < request_count; ++i )
+      {
+         auto session = db._undo_db.start_undo_session();
+         const auto& dto = db.create<data_transaction_object>( [&]( data_transaction_object& obj ) {
+            obj.request_id = "request-" + fc::to_string( uint64_t(i) );
+            obj.params = params;
+            obj.status = data_transaction_status_confirmed;
+         });
+         for( uint32_t d = 0; d < datasource_count; ++d )
+            db.create<data_transaction_datasource_state_object>( [&]( data_transaction_datasource_state_object& obj ) {
+               obj.data_transaction = dto.get_id();
+               obj.datasource = account_id_type( 100 + d );
+            });
+         session.commit();
+      }
+      auto create_us = ( fc::time_point::now() - start_time ).count();
+
+      const auto& by_request = db.get_index_type<data_transaction_index>().indices().get<by_request_id>();
+      auto acknowledge = [&]( uint8_t status ) {
+         for( uint32_t i = 0; i < request_count; ++i )
+         {
+            auto session = db._undo_db.start_undo_session();
+            const auto& dto = *by_request.find( "request-" + fc::to_string( uint64_t(i) ) );
+            for( uint32_t d = 0; d < datasource_count; ++d )
+               db.modify( *dto.find_datasource_state( db, account_id_type( 100 + d ) ),
+                          [&]( data_transaction_datasource_state_object& obj ) { obj.status = status; } );
+            session.commit();
+         }
+      };
+
+      start_time = fc::time_point::now();
+      acknowledge( data_transaction_datasource_status_uploaded );
+      auto upload_us = ( fc::time_point::now() - start_time ).count();
+
+      start_time = fc::time_point::now();
+      acknowledge( data_transaction_datasource_status_payed );
+      auto pay_us = ( fc::time_point::now() - start_time ).count();
+
+      const uint64_t acks = uint64_t( request_count ) * datasource_count;
+      ilog( "Created ${n} data transactions with ${d} datasources each in ${t} ms",
+            ("n", request_count)("d", datasource_count)("t", create_us / 1000) );
+      ilog( "Uploaded ${a} datasource statuses in ${t} ms (${r} acks/s)",
+            ("a", acks)("t", upload_us / 1000)("r", acks * 1000000 / std::max<int64_t>( upload_us, 1 )) );
+      ilog( "Payed ${a} datasource statuses in ${t} ms (${r} acks/s)",
+            ("a", acks)("t", pay_us / 1000)("r", acks * 1000000 / std::max<int64_t>( pay_us, 1 )) );
+
+      BOOST_CHECK( by_request.find( "request-0" )->get_datasources_status( db ).front().status == data_transaction_datasource_status_payed );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/full_account.hpp>
+#include <graphene/chain/protocol/block.hpp>
+#include <graphene/db/json_writer.hpp>
+
+#include <fc/crypto/elliptic.hpp>
+#include <fc/io/json.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+signed_block make_large_block( uint32_t trx_count, uint32_t ops_per_trx )
+{
+   const auto key = fc::ecc::private_key::regenerate( fc::sha256::hash( std::string( "json_writer_bench" ) ) );
+
+   signed_block block;
+   block.timestamp = fc::time_point_sec( 1500000000 );
+   block.witness = witness_id_type( 3 );
+   for( uint32_t t = 0; t < trx_count; ++t )
+   {
+      signed_transaction trx;
+      trx.set_expiration( block.timestamp + 60 );
+      for( uint32_t o = 0; o < ops_per_trx; ++o )
+      {
+         transfer_operation op;
+         op.fee = asset( 20 );
+         op.from = account_id_type( 100 + t );
+         op.to = account_id_type( 200 + o );
+         op.amount = asset( int64_t(t) * 1000 + o, asset_id_type( o % 4 ) );
+         if( o % 3 == 0 )
+            op.memo = memo_data();
+         trx.operations.push_back( op );
+      }
+      trx.sign( key, chain_id_type() );
+      block.transactions.push_back( processed_transaction( trx ) );
+   }
+   block.transaction_merkle_root = block.calculate_merkle_root();
+   block.sign( key );
+   return block;
+}
+
+graphene::app::full_account make_full_account( uint32_t balance_count )
+{
+   graphene::app::full_account acnt;
+   acnt.account.id = account_id_type( 17 );
+   acnt.account.name = "json-writer-bench";
+   acnt.statistics.owner = acnt.account.id;
+   acnt.registrar_name = acnt.referrer_name = acnt.lifetime_referrer_name = "committee-account";
+   for( uint32_t i = 0; i < balance_count; ++i )
+   {
+      account_balance_object bal;
+      bal.id = account_balance_id_type( i );
+      bal.owner = acnt.account.id;
+      bal.asset_type = asset_id_type( i );
+      bal.balance = int64_t(i) * 100000;
+      acnt.balances.push_back( bal );
+
+      vesting_balance_object vb;
+      vb.id = vesting_balance_id_type( i );
+      vb.owner = acnt.account.id;
+      vb.balance = asset( i, asset_id_type( i ) );
+      acnt.vesting_balances.push_back( vb );
+      acnt.assets.push_back( asset_id_type( i ) );
+   }
+   return acnt;
+}
+
+template<typename T>
+void compare_writers( const char* what, const T& value, uint32_t rounds )
+{
+   std::string expected;
+   fc::time_point start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      expected = fc::json::to_string( fc::variant( value, GRAPHENE_MAX_NESTED_OBJECTS ) );
+   const int64_t variant_us = ( fc::time_point::now() - start ).count();
+
+   std::string written;
+   start = fc::time_point::now();
+   for( uint32_t r = 0; r < rounds; ++r )
+      written = graphene::db::to_json( value, GRAPHENE_MAX_NESTED_OBJECTS );
+   const int64_t writer_us = ( fc::time_point::now() - start ).count();
+
+   ilog( "${w}: ${n} bytes, variant path ${v} us, json_writer ${j} us per serialization",
+         ("w", what)("n", written.size())("v", variant_us / rounds)("j", writer_us / rounds) );
+   BOOST_CHECK( written == expected );
+}
+
+}
+
+/** Serializes a large block and a full-account response through fc::variant and through json_writer. */
+BOOST_AUTO_TEST_CASE( json_writer_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t rounds = 50;
+#else
+      const uint32_t rounds = 5;
+#endif
+      compare_writers( "block of 1000 transactions", make_large_block( 1000, 4 ), rounds );
+      compare_writers( "full account with 500 balances", make_full_account( 500 ), rounds * 10 );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
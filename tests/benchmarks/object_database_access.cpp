@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+
+namespace {
+
+/** exposes the virtual index interface that object_database used for every get and modify */
+struct access_bench_database : public database
+{
+   using database::get_mutable_index;
+};
+
+}
+
+/**
+ *  Compares get and modify of account balances through the typed index registry with the virtual index
+ *  interface, inside one undo session like block application, and id lookups through the dense id table
+ *  with the ordered by_id index.
+ */
+BOOST_AUTO_TEST_CASE( object_database_access_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t object_count = 100000;
+      const uint32_t rounds = 50;
+#else
+      const uint32_t object_count = 10000;
+      const uint32_t rounds = 10;
+#endif
+      access_bench_database db;
+      db._undo_db.enable();
+
+      vector<account_balance_id_type> ids;
+      ids.reserve( object_count );
+      for( uint32_t i = 0; i < object_count; ++i )
+         ids.push_back( db.create<account_balance_object>( [&]( account_balance_object& b ) {
+            b.owner = account_id_type( i );
+            b.asset_type = asset_id_type( i % 8 );
+         }).id );
+
+      const uint64_t ops = uint64_t( object_count ) * rounds;
+      auto report = [&]( const char* what, int64_t us ) {
+         ilog( "${w}: ${n} calls in ${t} ms (${r} calls/s)",
+               ("w", what)("n", ops)("t", us / 1000)("r", ops * 1000000 / std::max<int64_t>( us, 1 )) );
+      };
+
+      share_type sum = 0;
+      fc::time_point start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         for( const auto& id : ids )
+            sum += db.get( id ).balance;
+      report( "typed get", ( fc::time_point::now() - start ).count() );
+
+      start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         for( const auto& id : ids )
+            sum += static_cast<const account_balance_object&>( db.get_index( id ).get( id ) ).balance;
+      report( "virtual get", ( fc::time_point::now() - start ).count() );
+
+      // account balances use dense_id_lookup, compare it with the by_id tree of the same container
+      const auto& bal_idx = db.get_index_type<account_balance_index>();
+      size_t found = 0;
+      start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         for( const auto& id : ids )
+            found += bal_idx.find_typed( id ) != nullptr;
+      report( "dense id lookup", ( fc::time_point::now() - start ).count() );
+
+      start = fc::time_point::now();
+      for( uint32_t r = 0; r < rounds; ++r )
+         for( const auto& id : ids )
+            found += bal_idx.indices().find( id ) != bal_idx.indices().end();
+      report( "ordered id lookup", ( fc::time_point::now() - start ).count() );
+      ilog( "Dense id table of ${n} balances holds ${b} bytes", ("n", object_count)("b", bal_idx.dense_table_bytes()) );
+      BOOST_CHECK_EQUAL( found, 2 * ops );
+
+      {
+         auto session = db._undo_db.start_undo_session();
+         start = fc::time_point::now();
+         for( uint32_t r = 0; r < rounds; ++r )
+            for( const auto& id : ids )
+               db.modify( db.get( id ), []( account_balance_object& b ) { b.balance += 1; } );
+         report( "typed modify", ( fc::time_point::now() - start ).count() );
+         session.commit();
+      }
+
+      {
+         auto session = db._undo_db.start_undo_session();
+         start = fc::time_point::now();
+         for( uint32_t r = 0; r < rounds; ++r )
+            for( const auto& id : ids )
+               db.get_mutable_index( id ).modify( db.get( id ), []( account_balance_object& b ) { b.balance += 1; } );
+         report( "virtual modify", ( fc::time_point::now() - start ).count() );
+         session.commit();
+      }
+
+      BOOST_CHECK( sum == 0 );
+      BOOST_CHECK( db.get( ids.front() ).balance == 2 * rounds );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
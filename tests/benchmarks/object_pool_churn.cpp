@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/account_object.hpp>
+#include <graphene/chain/contract_table_objects.hpp>
+
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include <deque>
+
+#include <sys/resource.h>
+
+using namespace graphene::chain;
+
+/**
+ *  Churns account balances and contract rows through undo sessions the way block application does: every
+ *  session creates rows, modifies balances (cloning them into the undo state) and removes the rows created two
+ *  sessions earlier.  Build with and without GRAPHENE_DB_POOL_ALLOCATOR to compare time and peak RSS.
+ */
+BOOST_AUTO_TEST_CASE( object_pool_churn_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t sessions = 20000;
+#else
+      const uint32_t sessions = 2000;
+#endif
+      const uint32_t balance_count = 50000;
+      const uint32_t rows_per_session = 100;
+
+#ifdef GRAPHENE_DB_POOL_ALLOCATOR
+      ilog( "Object pools enabled" );
+#else
+      ilog( "Object pools disabled" );
+#endif
+
+      database db;
+      db._undo_db.enable();
+      db._undo_db.set_max_size( 2 );
+
+      vector<account_balance_id_type> balances;
+      balances.reserve( balance_count );
+      for( uint32_t i = 0; i < balance_count; ++i )
+         balances.push_back( db.create<account_balance_object>( [&]( account_balance_object& b ) {
+            b.owner = account_id_type( i );
+         }).id );
+
+      std::deque< vector<key_value_object_id_type> > live_rows;
+      uint64_t primary_key = 0;
+
+      fc::time_point start = fc::time_point::now();
+      for( uint32_t s = 0; s < sessions; ++s )
+      {
+         auto session = db._undo_db.start_undo_session();
+
+         vector<key_value_object_id_type> rows;
+         rows.reserve( rows_per_session );
+         for( uint32_t r = 0; r < rows_per_session; ++r )
+            rows.push_back( db.create<key_value_object>( [&]( key_value_object& kv ) {
+               kv.primary_key = primary_key++;
+               kv.value.resize( 64 );
+            }).id );
+         live_rows.push_back( std::move( rows ) );
+
+         for( uint32_t r = 0; r < rows_per_session; ++r )
+            db.modify( db.get( balances[( s * rows_per_session + r ) % balance_count] ),
+                       []( account_balance_object& b ) { b.balance += 1; } );
+
+         if( live_rows.size() > 2 )
+         {
+            for( const auto& id : live_rows.front() )
+               db.remove( db.get( id ) );
+            live_rows.pop_front();
+         }
+
+         session.commit();
+      }
+      auto elapsed_us = ( fc::time_point::now() - start ).count();
+
+      struct rusage usage;
+      getrusage( RUSAGE_SELF, &usage );
+      ilog( "${s} sessions of ${r} row creations, balance updates and row removals in ${t} ms, peak RSS ${m} KiB",
+            ("s", sessions)("r", rows_per_session)("t", elapsed_us / 1000)("m", int64_t( usage.ru_maxrss )) );
+
+      BOOST_CHECK_EQUAL( db.get_index_type<key_value_index>().indices().size(), 2u * rows_per_session );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/app/application.hpp>
+
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/thread/thread.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+using namespace graphene::chain;
+using namespace graphene::app;
+
+/** A fresh node syncs a chain of empty blocks from three seed nodes on loopback. */
+BOOST_AUTO_TEST_CASE( p2p_sync_bench )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t block_count = 20000;
+#else
+      const uint32_t block_count = 1000;
+#endif
+      const uint32_t seed_count = 3;
+      const uint16_t first_port = 5200;
+
+      std::vector< std::unique_ptr<fc::temp_directory> > data_dirs;
+      std::vector< std::unique_ptr<application> > seeds;
+      std::vector<string> seed_endpoints;
+      for( uint32_t i = 0; i < seed_count; ++i )
+      {
+         data_dirs.emplace_back( new fc::temp_directory( graphene::utilities::temp_directory_path() ) );
+         seeds.emplace_back( new application() );
+         const string endpoint = "127.0.0.1:" + fc::to_string( uint64_t( first_port + i ) );
+         boost::program_options::variables_map cfg;
+         cfg.emplace( "p2p-endpoint", boost::program_options::variable_value( endpoint, false ) );
+         seeds.back()->initialize( data_dirs.back()->path(), cfg );
+         seeds.back()->startup();
+         seed_endpoints.push_back( endpoint );
+      }
+
+      const fc::ecc::private_key committee_key = fc::ecc::private_key::regenerate( fc::sha256::hash( string( "nathan" ) ) );
+      std::shared_ptr<database> producer = seeds.front()->chain_database();
+      for( uint32_t i = 0; i < block_count; ++i )
+      {
+         const signed_block block = producer->generate_block( producer->get_slot_time( 1 ), producer->get_scheduled_witness( 1 ),
+                                                              committee_key, database::skip_nothing );
+         for( uint32_t s = 1; s < seed_count; ++s )
+            seeds[s]->chain_database()->push_block( block );
+      }
+      ilog( "seeds hold ${n} blocks", ("n", producer->head_block_num()) );
+
+      fc::temp_directory syncing_dir( graphene::utilities::temp_directory_path() );
+      application syncing;
+      boost::program_options::variables_map cfg;
+      cfg.emplace( "p2p-endpoint", boost::program_options::variable_value(
+                      "127.0.0.1:" + fc::to_string( uint64_t( first_port + seed_count ) ), false ) );
+      cfg.emplace( "seed-node", boost::program_options::variable_value( seed_endpoints, false ) );
+      syncing.initialize( syncing_dir.path(), cfg );
+
+      const fc::time_point start = fc::time_point::now();
+      syncing.startup();
+      std::shared_ptr<database> synced = syncing.chain_database();
+      while( synced->head_block_num() < block_count && fc::time_point::now() - start < fc::minutes( 10 ) )
+         fc::usleep( fc::milliseconds( 10 ) );
+      const int64_t elapsed_us = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+
+      BOOST_CHECK_EQUAL( synced->head_block_num(), block_count );
+      ilog( "synced ${n} blocks from ${p} peers in ${t} ms, ${r} blocks/s",
+            ("n", synced->head_block_num())("p", syncing.p2p_node()->get_connection_count())
+            ("t", elapsed_us / 1000)("r", uint64_t( synced->head_block_num() ) * 1000000 / elapsed_us) );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
@@ -0,0 +1,86 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/net/stcp_socket.hpp>
+
+#include <fc/network/tcp_socket.hpp>
+#include <fc/network/ip.hpp>
+#include <fc/thread/thread.hpp>
+#include <fc/log/logger.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+using graphene::net::stcp_socket;
+
+/**
+ * Streams messages between two stcp_sockets over loopback, flushing after every message as a single queued
+ * message is sent, and after batches of messages as a busy peer's send queue is drained.
+ */
+BOOST_AUTO_TEST_CASE( stcp_socket_bench )
+{
+   try {
+#ifdef NDEBUG
+      const size_t total_bytes = 256 * 1024 * 1024;
+#else
+      const size_t total_bytes = 16 * 1024 * 1024;
+#endif
+      fc::tcp_server server;
+      server.listen( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), 0 ) );
+      stcp_socket receiver;
+      stcp_socket sender;
+      fc::future<void> accepted = fc::async( [&]() {
+         server.accept( receiver.get_socket() );
+         receiver.accept();
+      }, "accept" );
+      sender.connect_to( fc::ip::endpoint( fc::ip::address( "127.0.0.1" ), server.get_port() ) );
+      accepted.wait();
+
+      for( size_t message_size : { size_t(256), size_t(4096), size_t(64 * 1024) } )
+      {
+         const size_t message_count = total_bytes / message_size;
+         std::vector<char> message( message_size, 'm' );
+         for( size_t batch_size : { size_t(1), size_t(32) } )
+         {
+            fc::time_point start = fc::time_point::now();
+            fc::future<void> received = fc::async( [&]() {
+               std::vector<char> buffer( message_size );
+               for( size_t i = 0; i < message_count; ++i )
+                  receiver.read( buffer.data(), buffer.size() );
+            }, "receive" );
+            for( size_t i = 0; i < message_count; ++i )
+            {
+               sender.write( message.data(), message.size() );
+               if( ( i + 1 ) % batch_size == 0 )
+                  sender.flush();
+            }
+            sender.flush();
+            received.wait();
+
+            const int64_t elapsed_us = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+            ilog( "${n} messages of ${s} bytes, flushed every ${b}: ${mb} MiB/s",
+                  ("n", message_count)("s", message_size)("b", batch_size)
+                  ("mb", double( total_bytes ) / ( 1024 * 1024 ) * 1000000 / elapsed_us) );
+         }
+      }
+      sender.close();
+      receiver.close();
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
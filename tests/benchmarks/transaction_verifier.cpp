@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <graphene/chain/database.hpp>
+
+#include <fc/io/raw.hpp>
+
+#include <boost/test/auto_unit_test.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+/**
+ *  Pushes one block of signed transfers between distinct accounts, received as it would be from the network,
+ *  with the signatures verified while applying and on verifier threads, and reports the transactions per second.
+ */
+BOOST_FIXTURE_TEST_CASE( transaction_verifier_bench, database_fixture )
+{
+   try {
+#ifdef NDEBUG
+      const uint32_t account_count = 2000;
+#else
+      const uint32_t account_count = 200;
+#endif
+
+      vector<fc::ecc::private_key> keys;
+      vector<account_id_type> accounts;
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         const string name = "verify-bench-" + fc::to_string( uint64_t(i) );
+         keys.push_back( generate_private_key( name ) );
+         accounts.push_back( create_account( name, keys.back().get_public_key() ).id );
+         transfer( account_id_type(), accounts.back(), asset( 1000 ) );
+      }
+      generate_block();
+
+      for( uint32_t i = 0; i < account_count; ++i )
+      {
+         signed_transaction tx;
+         transfer_operation op;
+         op.from = accounts[i];
+         op.to = accounts[( i + 1 ) % account_count];
+         op.amount = asset( 1 );
+         tx.operations.push_back( op );
+         set_expiration( db, tx );
+         sign( tx, keys[i] );
+         PUSH_TX( db, tx );
+      }
+      const signed_block generated = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                                        init_account_priv_key, database::skip_nothing );
+      const auto packed = fc::raw::pack( generated );
+      const uint32_t head = db.head_block_num();
+
+      for( uint32_t threads : { 0u, 1u, 2u, 4u, 8u } )
+      {
+         db.pop_block();
+         db.clear_pending();
+         db.set_transaction_verify_threads( threads );
+
+         // unpacked again so that no signature keys are cached from producing the block
+         const auto block = fc::raw::unpack<signed_block>( packed );
+         fc::time_point start = fc::time_point::now();
+         PUSH_BLOCK( db, block, database::skip_nothing );
+         const int64_t us = std::max<int64_t>( ( fc::time_point::now() - start ).count(), 1 );
+
+         BOOST_REQUIRE_EQUAL( db.head_block_num(), head );
+         ilog( "${v} verify threads: ${n} transactions in ${ms} ms, ${tps} tps",
+               ("v", threads)("n", block.transactions.size())("ms", us / 1000)
+               ("tps", uint64_t( block.transactions.size() ) * 1000000 / us) );
+      }
+
+      db.set_transaction_verify_threads( 0 );
+   } catch(fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
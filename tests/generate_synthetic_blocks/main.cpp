@@ -0,0 +1,669 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <iostream>
+#include <numeric>
+#include <random>
+
+#include <fc/io/fstream.hpp>
+#include <fc/io/json.hpp>
+#include <fc/smart_ref_impl.hpp>
+
+#include <graphene/app/api.hpp>
+#include <graphene/chain/abi_def.hpp>
+#include <graphene/chain/balance_object.hpp>
+#include <graphene/chain/committee_member_object.hpp>
+#include <graphene/chain/free_data_product_object.hpp>
+#include <graphene/chain/wast_to_wasm.hpp>
+#include <graphene/egenesis/egenesis.hpp>
+
+#include <boost/program_options.hpp>
+#include <boost/filesystem.hpp>
+
+#include "../tests/test_wasts.hpp"
+
+using namespace graphene::app;
+using namespace graphene::chain;
+using namespace std;
+namespace bpo = boost::program_options;
+
+// hack:  import create_example_genesis() even though it's a way, way
+// specific internal detail
+namespace graphene { namespace app { namespace detail {
+genesis_state_type create_example_genesis();
+} } } // graphene::app::detail
+
+namespace {
+
+/** the lock program the generated genesis offers to balance_lock_operation */
+const char* const lock_program = "synthetic";
+
+/** relative weights of the kinds of transactions in the generated blocks */
+struct workload_mix
+{
+   uint32_t transfer = 0;
+   uint32_t balance_lock = 0;
+   uint32_t data_market = 0;
+   uint32_t contract_call = 0;
+   uint32_t contract_deploy = 0;
+   uint32_t account_create = 0;
+   uint32_t asset_create = 0;
+};
+
+/**
+ *  Drives a local chain through deterministic transactions.  Every key, name, amount and choice is derived from the
+ *  seed and the chain state, so that the same options always produce the same transactions in the same blocks.
+ *  Contract receipts carry the measured cpu time, blocks are only identical byte for byte without contract calls.
+ *
+ *  Memberships, data products, contracts and a data transaction middleware account are set up by operations in
+ *  the first blocks, so that the block log replays from the genesis alone.
+ */
+class synthetic_chain
+{
+   public:
+      synthetic_chain( database& db, uint64_t seed, uint32_t trx_per_block, bool verbose )
+         : _db( db ), _seed( seed ), _rng( seed ), _trx_per_block( trx_per_block ), _verbose( verbose ),
+           _nathan_key( fc::ecc::private_key::regenerate( fc::sha256::hash( string( "nathan" ) ) ) ),
+           _nathan( get_account( "nathan" ) ), _init0( get_account( "init0" ) )
+      {}
+
+      void setup( uint32_t account_count, uint32_t datasource_count, uint32_t contract_count );
+      /** generates blocks until the head block is num_blocks */
+      void run( uint32_t num_blocks, const workload_mix& mix );
+
+      uint64_t transaction_count()const { return _trx_count; }
+      uint64_t failed_count()const { return _failed; }
+
+   private:
+      account_id_type get_account( const string& name )const
+      {
+         const auto& accounts_by_name = _db.get_index_type<account_index>().indices().get<by_name>();
+         auto itr = accounts_by_name.find( name );
+         FC_ASSERT( itr != accounts_by_name.end(), "Genesis has no account ${n}", ("n", name) );
+         return itr->id;
+      }
+      fc::ecc::private_key key_of( const string& name )const
+      {
+         return fc::ecc::private_key::regenerate( fc::sha256::hash( fc::to_string( _seed ) + "/" + name ) );
+      }
+      uint64_t random( uint64_t bound ) { return _rng() % bound; }
+
+      /** pushes the operations as one transaction, failures are counted and skipped */
+      optional<processed_transaction> push( vector<operation> ops, const fc::ecc::private_key& key );
+      optional<processed_transaction> push( operation op, const fc::ecc::private_key& key )
+      { return push( vector<operation>{ std::move( op ) }, key ); }
+      signed_block produce();
+      /** produces a block when enough transactions are pending */
+      void maybe_produce() { if( _pending >= _trx_per_block ) produce(); }
+
+      optional<account_id_type> create_account( const string& name );
+      optional<account_id_type> deploy_contract( uint32_t owner, const string& name );
+      void grant_middleware_membership();
+
+      void transfer();
+      void lock_or_unlock();
+      void data_market_flow();
+      void call_contract();
+      void create_asset();
+
+      database&                           _db;
+      uint64_t                            _seed;
+      std::mt19937_64                     _rng;
+      uint32_t                            _trx_per_block;
+      bool                                _verbose;
+      fc::ecc::private_key                _nathan_key;
+      account_id_type                     _nathan;
+      account_id_type                     _init0;
+
+      vector<account_id_type>             _accounts;
+      vector<fc::ecc::private_key>        _keys;
+      /** the first accounts are merchants and may request data */
+      uint32_t                            _merchant_count = 0;
+      vector<account_id_type>             _datasources;
+      vector<free_data_product_id_type>   _products;
+      vector<account_id_type>             _contracts;
+      account_id_type                     _middleware;
+      fc::ecc::private_key                _middleware_key;
+      vector< vector<lock_balance_id_type> > _locks;
+      /** lock_days and interest_rate of the lock program, if the chain offers it */
+      optional<interest_rate_t>           _lock_rate;
+
+      uint32_t                            _pending = 0;
+      uint64_t                            _trx_count = 0;
+      uint64_t                            _failed = 0;
+      uint64_t                            _sequence = 0;
+};
+
+optional<processed_transaction> synthetic_chain::push( vector<operation> ops, const fc::ecc::private_key& key )
+{
+   signed_transaction tx;
+   tx.operations = std::move( ops );
+   for( auto& op : tx.operations )
+      _db.current_fee_schedule().set_fee( op );
+   tx.set_reference_block( _db.head_block_id() );
+   tx.set_expiration( _db.head_block_time() + fc::minutes( 10 ) );
+   tx.sign( key, _db.get_chain_id() );
+   try {
+      auto result = _db.push_transaction( tx );
+      ++_pending;
+      ++_trx_count;
+      return result;
+   } catch( const fc::exception& e ) {
+      ++_failed;
+      if( _verbose )
+         wlog( "Skipping transaction: ${e}", ("e", e.to_string()) );
+   }
+   return optional<processed_transaction>();
+}
+
+signed_block synthetic_chain::produce()
+{
+   signed_block b = _db.generate_block( _db.get_slot_time( 1 ), _db.get_scheduled_witness( 1 ), _nathan_key,
+                                        database::skip_nothing );
+   FC_ASSERT( _db.head_block_id() == b.id() );
+   _pending = 0;
+   return b;
+}
+
+optional<account_id_type> synthetic_chain::create_account( const string& name )
+{
+   const public_key_type key = key_of( name ).get_public_key();
+   account_create_operation op;
+   op.registrar = _init0;
+   op.referrer = _init0;
+   op.name = name;
+   op.owner = authority( 1, key, 1 );
+   op.active = authority( 1, key, 1 );
+   op.options.memo_key = key;
+   op.options.voting_account = GRAPHENE_PROXY_TO_SELF_ACCOUNT;
+   // init0 is registered with nathan's key
+   auto result = push( op, _nathan_key );
+   if( !result )
+      return optional<account_id_type>();
+   return account_id_type( result->operation_results[0].get<object_id_type>() );
+}
+
+optional<account_id_type> synthetic_chain::deploy_contract( uint32_t owner, const string& name )
+{
+   static const auto wasm = graphene::chain::wast_to_wasm( contract_test_wast_code );
+   contract_deploy_operation op;
+   op.account = _accounts[owner];
+   op.name = name;
+   op.vm_type = "0";
+   op.vm_version = "0";
+   op.code = bytes( wasm.begin(), wasm.end() );
+   op.abi = fc::json::from_string( contract_abi ).as<abi_def>( GRAPHENE_MAX_NESTED_OBJECTS );
+   auto result = push( op, _keys[owner] );
+   if( !result )
+      return optional<account_id_type>();
+   return account_id_type( result->operation_results[0].get<object_id_type>() );
+}
+
+/**
+ *  Data transaction members can only be made by the committee.  nathan holds all stake and votes init0 into the
+ *  committee, which then approves the upgrade of the middleware account.
+ */
+void synthetic_chain::grant_middleware_membership()
+{
+   const auto& members_by_account = _db.get_index_type<committee_member_index>().indices().get<by_account>();
+   auto committee_member = members_by_account.find( _init0 );
+   FC_ASSERT( committee_member != members_by_account.end(), "init0 is not a committee candidate in the genesis" );
+
+   account_update_operation vote;
+   vote.account = _nathan;
+   vote.new_options = _nathan( _db ).options;
+   vote.new_options->voting_account = GRAPHENE_PROXY_TO_SELF_ACCOUNT;
+   vote.new_options->votes.insert( committee_member->vote_id );
+   vote.new_options->num_committee = 1;
+   FC_ASSERT( push( vote, _nathan_key ), "Unable to vote for the committee" );
+   produce();
+   const auto next_maintenance = _db.get_dynamic_global_properties().next_maintenance_time;
+   while( _db.head_block_time() <= next_maintenance )
+      produce();
+   const auto& committee_auths = GRAPHENE_COMMITTEE_ACCOUNT( _db ).active.account_auths;
+   FC_ASSERT( committee_auths.find( _init0 ) != committee_auths.end(), "init0 was not voted into the committee" );
+
+   const auto& params = _db.get_global_properties().parameters;
+   account_upgrade_data_transaction_member_operation upgrade;
+   upgrade.account_to_upgrade = _middleware;
+   upgrade.upgrade_to_data_transaction_member = true;
+   proposal_create_operation propose;
+   propose.fee_paying_account = _nathan;
+   propose.review_period_seconds = params.committee_proposal_review_period;
+   propose.expiration_time = _db.head_block_time() + params.committee_proposal_review_period + params.block_interval * 2;
+   propose.proposed_ops.emplace_back( upgrade );
+   auto proposed = push( propose, _nathan_key );
+   FC_ASSERT( proposed, "Unable to propose the middleware membership" );
+
+   proposal_update_operation approve;
+   approve.fee_paying_account = _nathan;
+   approve.proposal = proposal_id_type( proposed->operation_results[0].get<object_id_type>() );
+   approve.active_approvals_to_add.insert( _init0 );
+   FC_ASSERT( push( approve, _nathan_key ), "Unable to approve the middleware membership" );
+   while( _db.head_block_time() <= propose.expiration_time )
+      produce();
+   FC_ASSERT( _middleware( _db ).is_data_transaction_member(), "The committee did not upgrade the middleware account" );
+}
+
+void synthetic_chain::setup( uint32_t account_count, uint32_t datasource_count, uint32_t contract_count )
+{
+   FC_ASSERT( account_count >= 2 && datasource_count > 0 && datasource_count <= account_count );
+
+   // all stake of the genesis goes to nathan
+   vector<balance_claim_operation> claims;
+   for( const balance_object& b : _db.get_index_type<balance_index>().indices().get<by_owner>() )
+   {
+      if( b.owner != address( _nathan_key.get_public_key() ) || b.is_vesting_balance() )
+         continue;
+      balance_claim_operation claim;
+      claim.deposit_to_account = _nathan;
+      claim.balance_to_claim = b.id;
+      claim.balance_owner_key = _nathan_key.get_public_key();
+      claim.total_claimed = b.balance;
+      claims.push_back( claim );
+   }
+   for( const auto& claim : claims )
+      push( claim, _nathan_key );
+
+   // GXS must be 1.3.1, it is the asset locks are made of
+   if( !_db.find( GRAPHENE_GXS_ASSET ) )
+   {
+      asset_create_operation gxs;
+      gxs.issuer = _nathan;
+      gxs.symbol = "GXS";
+      gxs.precision = 5;
+      gxs.common_options.max_supply = GRAPHENE_MAX_SHARE_SUPPLY;
+      gxs.common_options.core_exchange_rate = price( { asset( 1, asset_id_type(1) ), asset( 1 ) } );
+      push( gxs, _nathan_key );
+   }
+   produce();
+   FC_ASSERT( _db.find( GRAPHENE_GXS_ASSET ), "Unable to create GXS as 1.3.1" );
+
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      const string name = "synth-" + fc::to_string( uint64_t(i) );
+      auto id = create_account( name );
+      FC_ASSERT( id, "Unable to create account ${n}", ("n", name) );
+      _accounts.push_back( *id );
+      _keys.push_back( key_of( name ) );
+      maybe_produce();
+   }
+   _middleware_key = key_of( "synth-middleware" );
+   auto middleware = create_account( "synth-middleware" );
+   FC_ASSERT( middleware, "Unable to create the middleware account" );
+   _middleware = *middleware;
+   transfer_operation fund_middleware;
+   fund_middleware.from = _nathan;
+   fund_middleware.to = _middleware;
+   fund_middleware.amount = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+   push( fund_middleware, _nathan_key );
+   produce();
+
+   for( uint32_t i = 0; i < account_count; ++i )
+   {
+      transfer_operation fund;
+      fund.from = _nathan;
+      fund.to = _accounts[i];
+      fund.amount = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+      asset_issue_operation issue;
+      issue.issuer = _nathan;
+      issue.asset_to_issue = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION, GRAPHENE_GXS_ASSET );
+      issue.issue_to_account = _accounts[i];
+      account_upgrade_merchant_operation merchant;
+      merchant.account_to_upgrade = _accounts[i];
+      merchant.auth_referrer = _init0;
+      merchant.upgrade_to_merchant_member = true;
+      push( { fund, issue }, _nathan_key );
+      push( merchant, _nathan_key );
+      maybe_produce();
+   }
+   _merchant_count = account_count;
+   produce();
+
+   // the last accounts provide data
+   for( uint32_t i = account_count - datasource_count; i < account_count; ++i )
+   {
+      account_upgrade_datasource_operation upgrade;
+      upgrade.account_to_upgrade = _accounts[i];
+      upgrade.auth_referrer = _init0;
+      upgrade.upgrade_to_datasource_member = true;
+      push( upgrade, _nathan_key );
+      _datasources.push_back( _accounts[i] );
+   }
+   produce();
+   for( account_id_type datasource : _datasources )
+   {
+      free_data_product_create_operation product;
+      product.product_name = "synthetic product " + fc::to_string( uint64_t( _products.size() ) );
+      product.datasource = datasource;
+      product.price = 1 + random( 100 );
+      product.issuer = _init0;
+      product.create_date_time = _db.head_block_time();
+      schema_context_object schema;
+      schema.version = "1.0.0";
+      schema.schema_context = "{\"privacy\":\"false\"}";
+      product.schema_contexts.push_back( schema );
+      auto result = push( product, _nathan_key );
+      if( result )
+         _products.push_back( free_data_product_id_type( result->operation_results[0].get<object_id_type>() ) );
+   }
+   produce();
+   FC_ASSERT( !_products.empty(), "Unable to create data products" );
+
+   for( uint32_t i = 0; i < contract_count; ++i )
+   {
+      auto contract = deploy_contract( random( _accounts.size() ), "synth-contract-" + fc::to_string( uint64_t(i) ) );
+      if( contract )
+         _contracts.push_back( *contract );
+      maybe_produce();
+   }
+   produce();
+
+   grant_middleware_membership();
+
+   for( const auto& ext : _db.get_global_properties().parameters.extensions )
+      if( ext.which() == future_extensions::tag<lock_balance_params_t>::value )
+         for( const auto& program : ext.get<lock_balance_params_t>().params )
+            if( program.first == lock_program && program.second.is_valid )
+               _lock_rate = program.second;
+   if( !_lock_rate )
+      wlog( "The genesis has no ${p} lock program, no balances will be locked", ("p", lock_program) );
+   _locks.resize( _accounts.size() );
+}
+
+void synthetic_chain::transfer()
+{
+   const uint32_t from = random( _accounts.size() );
+   transfer_operation op;
+   op.from = _accounts[from];
+   op.to = _accounts[ ( from + 1 + random( _accounts.size() - 1 ) ) % _accounts.size() ];
+   op.amount = asset( 1 + random( 10000 ) );
+   push( op, _keys[from] );
+}
+
+void synthetic_chain::lock_or_unlock()
+{
+   const uint32_t account = random( _accounts.size() );
+   auto& locks = _locks[account];
+   if( locks.empty() || random( 2 ) == 0 )
+   {
+      balance_lock_operation op;
+      op.account = _accounts[account];
+      op.create_date_time = _db.head_block_time();
+      op.program_id = lock_program;
+      op.amount = asset( GRAPHENE_BLOCKCHAIN_PRECISION * ( 1 + random( 10 ) ), GRAPHENE_GXS_ASSET );
+      op.lock_days = _lock_rate->lock_days;
+      op.interest_rate = _lock_rate->interest_rate;
+      if( auto result = push( op, _keys[account] ) )
+         locks.push_back( lock_balance_id_type( result->operation_results[0].get<object_id_type>() ) );
+   }
+   else
+   {
+      balance_unlock_operation op;
+      op.account = _accounts[account];
+      op.lock_id = locks.back();
+      push( op, _keys[account] );
+      locks.pop_back();
+   }
+}
+
+/** a merchant requests data, the middleware reports the datasource uploaded it and the merchant pays */
+void synthetic_chain::data_market_flow()
+{
+   const uint32_t requester = random( _merchant_count );
+   const uint32_t product = random( _products.size() );
+   const free_data_product_object& product_obj = _products[product]( _db );
+   const string request_id = "synth-" + fc::to_string( _seed ) + "-" + fc::to_string( _sequence++ );
+
+   data_transaction_create_operation create;
+   create.request_id = request_id;
+   create.product_id = product_obj.id;
+   create.version = "1.0.0";
+   create.params = "{\"query\":\"" + fc::to_string( _rng() ) + "\"}";
+   create.requester = _accounts[requester];
+   create.create_date_time = _db.head_block_time();
+   if( !push( create, _keys[requester] ) )
+      return;
+
+   data_transaction_datasource_upload_operation upload;
+   upload.request_id = request_id;
+   upload.requester = _middleware;
+   upload.datasource = product_obj.datasource;
+   if( !push( upload, _middleware_key ) )
+      return;
+
+   pay_data_transaction_operation pay;
+   pay.from = _accounts[requester];
+   pay.to = product_obj.datasource;
+   pay.amount = asset( product_obj.price );
+   pay.request_id = request_id;
+   if( pay.from != pay.to )
+      push( pay, _keys[requester] );
+}
+
+void synthetic_chain::call_contract()
+{
+   if( _contracts.empty() )
+      return;
+   const uint32_t caller = random( _accounts.size() );
+   const string data = fc::to_string( _rng() );
+   contract_call_operation op;
+   op.account = _accounts[caller];
+   op.contract_id = _contracts[ random( _contracts.size() ) ];
+   op.method_name = N(hi);
+   op.data = bytes( data.begin(), data.end() );
+   push( op, _keys[caller] );
+}
+
+void synthetic_chain::create_asset()
+{
+   const uint32_t issuer = random( _accounts.size() );
+   asset_create_operation create;
+   create.issuer = _accounts[issuer];
+   create.symbol = "SYN" + fc::to_string( _sequence++ );
+   create.precision = 4;
+   create.common_options.max_supply = GRAPHENE_MAX_SHARE_SUPPLY;
+   create.common_options.core_exchange_rate = price( { asset( 1, asset_id_type(1) ), asset( 1 ) } );
+   auto created = push( create, _keys[issuer] );
+   if( !created )
+      return;
+   asset_issue_operation issue;
+   issue.issuer = _accounts[issuer];
+   issue.asset_to_issue = asset( 1 + random( 1000000 ), asset_id_type( created->operation_results[0].get<object_id_type>() ) );
+   issue.issue_to_account = _accounts[ random( _accounts.size() ) ];
+   push( issue, _keys[issuer] );
+}
+
+void synthetic_chain::run( uint32_t num_blocks, const workload_mix& mix )
+{
+   const vector<double> weights = {
+      double( mix.transfer ),
+      double( _lock_rate ? mix.balance_lock : 0 ),
+      double( mix.data_market ),
+      double( mix.contract_call ),
+      double( mix.contract_deploy ),
+      double( mix.account_create ),
+      double( mix.asset_create ) };
+   FC_ASSERT( std::accumulate( weights.begin(), weights.end(), 0.0 ) > 0, "The workload mix is empty" );
+   std::discrete_distribution<int> kinds( weights.begin(), weights.end() );
+
+   while( _db.head_block_num() < num_blocks )
+   {
+      // a bounded number of attempts keeps blocks flowing when transactions fail
+      for( uint32_t attempt = 0; _pending < _trx_per_block && attempt < 4 * _trx_per_block; ++attempt )
+      {
+         switch( kinds( _rng ) )
+         {
+         case 0: transfer(); break;
+         case 1: lock_or_unlock(); break;
+         case 2: data_market_flow(); break;
+         case 3: call_contract(); break;
+         case 4:
+         {
+            auto contract = deploy_contract( random( _accounts.size() ), "synth-contract-" + fc::to_string( _sequence++ ) );
+            if( contract )
+               _contracts.push_back( *contract );
+            break;
+         }
+         case 5:
+         {
+            const string name = "synth-" + fc::to_string( uint64_t( _accounts.size() ) );
+            auto id = create_account( name );
+            if( !id )
+               break;
+            _accounts.push_back( *id );
+            _keys.push_back( key_of( name ) );
+            _locks.emplace_back();
+            transfer_operation fund;
+            fund.from = _nathan;
+            fund.to = *id;
+            fund.amount = asset( 1000 * GRAPHENE_BLOCKCHAIN_PRECISION );
+            push( fund, _nathan_key );
+            break;
+         }
+         default: create_asset(); break;
+         }
+      }
+      produce();
+      if( _verbose )
+         ilog( "block #${n}: ${t} transactions, ${f} failed", ("n", _db.head_block_num())("t", _trx_count)("f", _failed) );
+      else if( _db.head_block_num() % 10000 == 0 )
+         std::cerr << "\rblock #" << _db.head_block_num() << "   transactions " << _trx_count << "   failed " << _failed;
+   }
+   std::cerr << "\n";
+}
+
+}
+
+int main( int argc, char** argv )
+{
+   try
+   {
+      bpo::options_description cli_options("Graphene synthetic blocks");
+      cli_options.add_options()
+            ("help,h", "Print this help message and exit.")
+            ("data-dir", bpo::value<boost::filesystem::path>()->default_value("synthetic_blocks_data_dir"), "Directory containing generator database")
+            ("genesis-json,g", bpo::value<boost::filesystem::path>(), "File to read genesis state from, the example genesis is adapted to the generator if not given")
+            ("genesis-time,t", bpo::value<uint32_t>()->default_value(1530403200), "Timestamp for genesis state (0=use value from file/example)")
+            ("seed,s", bpo::value<uint64_t>()->default_value(1), "Seed of all keys, names and choices")
+            ("num-blocks,n", bpo::value<uint32_t>()->default_value(1000000), "Number of blocks to generate")
+            ("trx-per-block", bpo::value<uint32_t>()->default_value(100), "Number of transactions in each block")
+            ("accounts", bpo::value<uint32_t>()->default_value(1000), "Number of accounts created before the workload starts")
+            ("datasources", bpo::value<uint32_t>()->default_value(10), "Number of those accounts that sell data, one free data product each")
+            ("contracts", bpo::value<uint32_t>()->default_value(10), "Number of contracts deployed before the workload starts")
+            ("transfer-weight", bpo::value<uint32_t>()->default_value(50), "Relative weight of core transfers")
+            ("balance-lock-weight", bpo::value<uint32_t>()->default_value(10), "Relative weight of balance locks and unlocks")
+            ("data-market-weight", bpo::value<uint32_t>()->default_value(15), "Relative weight of data transaction request, upload and pay flows")
+            ("contract-call-weight", bpo::value<uint32_t>()->default_value(15), "Relative weight of contract calls, 0 makes the block log identical byte for byte between runs")
+            ("contract-deploy-weight", bpo::value<uint32_t>()->default_value(1), "Relative weight of contract deployments")
+            ("account-create-weight", bpo::value<uint32_t>()->default_value(5), "Relative weight of account registrations")
+            ("asset-create-weight", bpo::value<uint32_t>()->default_value(4), "Relative weight of asset creations and issues")
+            ("verbose,v", "Enter verbose mode")
+            ;
+
+      bpo::variables_map options;
+      try
+      {
+         boost::program_options::store( boost::program_options::parse_command_line(argc, argv, cli_options), options );
+      }
+      catch (const boost::program_options::error& e)
+      {
+         std::cerr << "synthetic_blocks:  error parsing command line: " << e.what() << "\n";
+         return 1;
+      }
+
+      if( options.count("help") )
+      {
+         std::cout << cli_options << "\n";
+         return 0;
+      }
+
+      fc::path data_dir;
+      if( options.count("data-dir") )
+      {
+         data_dir = options["data-dir"].as<boost::filesystem::path>();
+         if( data_dir.is_relative() )
+            data_dir = fc::current_path() / data_dir;
+      }
+
+      genesis_state_type genesis;
+      if( options.count("genesis-json") )
+      {
+         fc::path genesis_json_filename = options["genesis-json"].as<boost::filesystem::path>();
+         std::cerr << "synthetic_blocks:  Reading genesis from file " << genesis_json_filename.preferred_string() << "\n";
+         std::string genesis_json;
+         read_file_contents( genesis_json_filename, genesis_json );
+         genesis = fc::json::from_string( genesis_json ).as< genesis_state_type >(20);
+      }
+      else
+      {
+         genesis = graphene::app::detail::create_example_genesis();
+         // no fees to fund, and committee votes and proposals that take minutes instead of days
+         genesis.initial_parameters.current_fees->zero_all_fees();
+         genesis.initial_parameters.maintenance_interval = 10 * 60;
+         genesis.initial_parameters.committee_proposal_review_period = 10 * 60;
+         lock_balance_params_t lock_params;
+         interest_rate_t rate;
+         rate.is_valid = true;
+         lock_params.params.emplace_back( lock_program, rate );
+         future_extensions ext = lock_params;
+         genesis.initial_parameters.extensions.insert( ext );
+      }
+      uint32_t timestamp = options["genesis-time"].as<uint32_t>();
+      if( timestamp != 0 )
+      {
+         genesis.initial_timestamp = fc::time_point_sec( timestamp );
+         std::cerr << "synthetic_blocks:  Genesis timestamp is " << genesis.initial_timestamp.sec_since_epoch() << " (from CLI)\n";
+      }
+      else
+         std::cerr << "synthetic_blocks:  Genesis timestamp is " << genesis.initial_timestamp.sec_since_epoch() << " (from state)\n";
+      bool verbose = (options.count("verbose") != 0);
+
+      workload_mix mix;
+      mix.transfer = options["transfer-weight"].as<uint32_t>();
+      mix.balance_lock = options["balance-lock-weight"].as<uint32_t>();
+      mix.data_market = options["data-market-weight"].as<uint32_t>();
+      mix.contract_call = options["contract-call-weight"].as<uint32_t>();
+      mix.contract_deploy = options["contract-deploy-weight"].as<uint32_t>();
+      mix.account_create = options["account-create-weight"].as<uint32_t>();
+      mix.asset_create = options["asset-create-weight"].as<uint32_t>();
+
+      // the genesis is needed to replay the generated blocks
+      fc::create_directories( data_dir );
+      fc::json::save_to_file( genesis, data_dir / "genesis.json" );
+
+      database db;
+      fc::path db_path = data_dir / "db";
+      db.open(db_path, [&]() { return genesis; }, "TEST" );
+      FC_ASSERT( db.head_block_num() == 0, "The generator database at ${d} is not empty", ("d", db_path) );
+
+      synthetic_chain chain( db, options["seed"].as<uint64_t>(), std::max( options["trx-per-block"].as<uint32_t>(), 1u ), verbose );
+      chain.setup( options["accounts"].as<uint32_t>(), options["datasources"].as<uint32_t>(), options["contracts"].as<uint32_t>() );
+      std::cerr << "synthetic_blocks:  Set up " << db.head_block_num() << " blocks\n";
+      chain.run( options["num-blocks"].as<uint32_t>(), mix );
+      std::cerr << "synthetic_blocks:  " << db.head_block_num() << " blocks with " << chain.transaction_count()
+                << " transactions, " << chain.failed_count() << " transactions failed\n";
+      db.close();
+   }
+   catch ( const fc::exception& e )
+   {
+      std::cout << e.to_detail_string() << "\n";
+      return 1;
+   }
+   return 0;
+}
@@ -125,6 +125,229 @@ BOOST_AUTO_TEST_CASE( block_database_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( block_database_compressed_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path dir = data_dir.path();
+
+      block_database bdb;
+      bdb.open( dir );
+
+      vector<block_id_type> ids( 1 );
+      signed_block b;
+      for( uint32_t i = 0; i < 22; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+      BOOST_CHECK_EQUAL( bdb.archive_blocks( 20, 4 ), 20u );
+
+      auto check_blocks = [&]( uint32_t first_missing, uint32_t last_missing ) {
+         for( uint32_t n = 1; n <= 22; ++n )
+         {
+            const bool present = n < first_missing || n > last_missing;
+            BOOST_REQUIRE_EQUAL( bdb.fetch_by_number( n ).valid(), present );
+            BOOST_CHECK_EQUAL( bdb.fetch_optional( ids[n] ).valid(), present );
+            if( present )
+            {
+               BOOST_CHECK( bdb.fetch_by_number( n )->id() == ids[n] );
+               BOOST_CHECK( bdb.fetch_optional( ids[n] )->witness == witness_id_type(n) );
+            }
+         }
+      };
+      // blocks 1 to 20 are read from the compressed log, 21 and 22 from the blocks file
+      check_blocks( 23, 23 );
+      BOOST_CHECK( bdb.contains( ids[1] ) );
+      BOOST_CHECK( bdb.fetch_block_id( 7 ) == ids[7] );
+
+      bdb.close();
+      bdb.open( dir );
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 1u );
+      check_blocks( 23, 23 );
+      BOOST_REQUIRE( bdb.last_id().valid() );
+      BOOST_CHECK( *bdb.last_id() == ids[22] );
+      bdb.close();
+
+      // a chunk cut short by a crash while appending is dropped when the log is opened
+      fc::resize_file( dir / "chunks", fc::file_size( dir / "chunks" ) - 1 );
+      bdb.open( dir );
+      check_blocks( 17, 20 );
+      BOOST_CHECK( !bdb.contains( ids[17] ) );
+      BOOST_CHECK( bdb.contains( ids[16] ) );
+      bdb.close();
+
+      // a chunk whose dictionary id does not match chunk_header fails to decompress instead of returning garbage
+      {
+         std::fstream chunks( (dir / "chunks").generic_string().c_str(), std::ios::in | std::ios::out | std::ios::binary );
+         char c;
+         chunks.seekg( 2 );
+         chunks.read( &c, 1 );
+         c = ~c;
+         chunks.seekp( 2 );
+         chunks.write( &c, 1 );
+      }
+      bdb.open( dir );
+      check_blocks( 1, 4 );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_prune_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+      bdb.set_prune_window( 10 );
+
+      vector<block_id_type> ids( 1 );
+      signed_block b;
+      for( uint32_t i = 0; i < 25; ++i )
+      {
+         if( i > 0 ) b.previous = b.id();
+         b.witness = witness_id_type(i+1);
+         bdb.store( b.id(), b );
+         ids.push_back( b.id() );
+      }
+
+      // the files were rolled when block 20 was stored, keeping blocks 11 to 20
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 11u );
+      for( uint32_t n = 1; n <= 25; ++n )
+      {
+         BOOST_CHECK_EQUAL( bdb.fetch_by_number( n ).valid(), n >= 11 );
+         BOOST_CHECK_EQUAL( bdb.contains( ids[n] ), n >= 11 );
+      }
+      BOOST_CHECK_THROW( bdb.fetch_block_id( 5 ), fc::key_not_found_exception );
+      BOOST_CHECK( bdb.fetch_block_id( 11 ) == ids[11] );
+      BOOST_CHECK_THROW( bdb.store( ids[5], signed_block() ), fc::exception );
+
+      bdb.close();
+      bdb.open( data_dir.path() );
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 11u );
+      BOOST_REQUIRE( bdb.last_id().valid() );
+      BOOST_CHECK( *bdb.last_id() == ids[25] );
+      BOOST_CHECK( !bdb.fetch_by_number( 10 ).valid() );
+      BOOST_REQUIRE( bdb.fetch_by_number( 11 ).valid() );
+      BOOST_CHECK( bdb.fetch_by_number( 11 )->witness == witness_id_type(11) );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_archive_again_test )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+
+      block_database bdb;
+      bdb.open( data_dir.path() );
+
+      vector<block_id_type> ids( 1 );
+      signed_block b;
+      auto store_blocks = [&]( uint32_t count ) {
+         for( uint32_t i = 0; i < count; ++i )
+         {
+            if( ids.size() > 1 ) b.previous = b.id();
+            b.witness = witness_id_type( ids.size() );
+            bdb.store( b.id(), b );
+            ids.push_back( b.id() );
+         }
+      };
+
+      store_blocks( 10 );
+      BOOST_CHECK_EQUAL( bdb.archive_blocks( 10, 4 ), 8u );
+      // the index now starts after the archived blocks, archiving again continues from there
+      store_blocks( 10 );
+      BOOST_CHECK_EQUAL( bdb.archive_blocks( 20, 4 ), 20u );
+      BOOST_CHECK_EQUAL( bdb.archive_blocks( 20, 4 ), 20u );
+
+      bdb.close();
+      bdb.open( data_dir.path() );
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 1u );
+      for( uint32_t n = 1; n <= 20; ++n )
+      {
+         BOOST_REQUIRE( bdb.fetch_by_number( n ).valid() );
+         BOOST_CHECK( bdb.fetch_by_number( n )->id() == ids[n] );
+         BOOST_CHECK( bdb.contains( ids[n] ) );
+      }
+      BOOST_REQUIRE( bdb.last_id().valid() );
+      BOOST_CHECK( *bdb.last_id() == ids[20] );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( block_database_interrupted_rewrite_test )
+{
+   try {
+      fc::temp_directory pruned_dir( graphene::utilities::temp_directory_path() );
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path dir = data_dir.path();
+
+      vector<signed_block> blocks( 1 );
+      for( uint32_t i = 0; i < 25; ++i )
+      {
+         signed_block b;
+         if( i > 0 ) b.previous = blocks.back().id();
+         b.witness = witness_id_type(i+1);
+         blocks.push_back( b );
+      }
+      auto store_all = []( const fc::path& path, const vector<signed_block>& blocks, uint32_t prune_window ) {
+         block_database bdb;
+         bdb.open( path );
+         bdb.set_prune_window( prune_window );
+         for( size_t n = 1; n < blocks.size(); ++n )
+            bdb.store( blocks[n].id(), blocks[n] );
+         bdb.close();
+      };
+      // the files a rewrite keeping blocks 11 to 25 produces
+      store_all( pruned_dir.path(), blocks, 10 );
+      store_all( dir, blocks, 0 );
+
+      // a rewrite that crashed before it was committed is dropped
+      fc::copy( pruned_dir.path() / "index", dir / "index.tmp" );
+      fc::copy( pruned_dir.path() / "index_base", dir / "index_base.tmp" );
+      block_database bdb;
+      bdb.open( dir );
+      BOOST_CHECK( !fc::exists( dir / "index.tmp" ) );
+      BOOST_CHECK( !fc::exists( dir / "index_base.tmp" ) );
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 1u );
+      BOOST_REQUIRE( bdb.fetch_by_number( 1 ).valid() );
+      BOOST_CHECK( bdb.fetch_by_number( 1 )->id() == blocks[1].id() );
+      bdb.close();
+
+      // a committed rewrite that crashed after replacing blocks and index, but not index_base, is completed
+      fc::remove( dir / "blocks" );
+      fc::remove( dir / "index" );
+      fc::copy( pruned_dir.path() / "blocks", dir / "blocks" );
+      fc::copy( pruned_dir.path() / "index", dir / "index" );
+      fc::copy( pruned_dir.path() / "index_base", dir / "index_base.tmp" );
+      std::ofstream( (dir / "rewrite_committed").generic_string().c_str() );
+      bdb.open( dir );
+      BOOST_CHECK( !fc::exists( dir / "rewrite_committed" ) );
+      BOOST_CHECK_EQUAL( bdb.first_block_num(), 11u );
+      for( uint32_t n = 1; n <= 25; ++n )
+      {
+         BOOST_REQUIRE_EQUAL( bdb.fetch_by_number( n ).valid(), n >= 11 );
+         if( n >= 11 )
+            BOOST_CHECK( bdb.fetch_by_number( n )->id() == blocks[n].id() );
+      }
+      BOOST_REQUIRE( bdb.last_id().valid() );
+      BOOST_CHECK( *bdb.last_id() == blocks[25].id() );
+   } catch (fc::exception& e) {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_CASE( generate_empty_blocks )
 {
    try {
@@ -1219,4 +1442,256 @@ BOOST_FIXTURE_TEST_CASE( miss_many_blocks, database_fixture )
    }
 }
 
+BOOST_FIXTURE_TEST_CASE( parallel_transaction_verification, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      generate_block( database::skip_authority_check );
+      transfer( account_id_type(), alice_id, asset( 100000 ) );
+      transfer( account_id_type(),   bob_id, asset( 100000 ) );
+      generate_block();
+
+      auto make_transfer = [&]( account_id_type from, account_id_type to, share_type amount,
+                                const fc::ecc::private_key& key ) -> signed_transaction
+      {
+         signed_transaction tx;
+         transfer_operation xfer_op;
+         xfer_op.from = from;
+         xfer_op.to = to;
+         xfer_op.amount = asset( amount, asset_id_type() );
+         xfer_op.fee = asset( 0, asset_id_type() );
+         tx.operations.push_back( xfer_op );
+         set_expiration( db, tx );
+         sign( tx, key );
+         return tx;
+      };
+
+      // bob hands his active authority to alice's key ahead of a transfer signed with his old key
+      {
+         signed_transaction update_tx;
+         account_update_operation op;
+         op.account = bob_id;
+         op.active = authority( 1, public_key_type( alice_private_key.get_public_key() ), 1 );
+         update_tx.operations.push_back( op );
+         set_expiration( db, update_tx );
+         sign( update_tx, bob_private_key );
+
+         signed_block block;
+         block.transactions.push_back( update_tx );
+         block.transactions.push_back( make_transfer( bob_id, alice_id, 10, bob_private_key ) );
+         block.transactions.push_back( make_transfer( alice_id, bob_id, 10, alice_private_key ) );
+         block.transactions.push_back( make_transfer( alice_id, bob_id, 20, bob_private_key ) );
+
+         transaction_verifier verifier( 2 );
+         const vector<bool> expected = { true, false, true, false };
+         BOOST_CHECK( verifier.verify_block( db, block ) == expected );
+
+         BOOST_CHECK( get_authority_write_footprint( block.transactions[0] ).authority_writes.count( bob_id ) );
+         BOOST_CHECK( get_authority_write_footprint( block.transactions[1] ).authority_writes.empty() );
+      }
+
+      // applying a block with verified transactions ends in the same state as verifying them one by one
+      for( uint32_t i = 0; i < 50; ++i )
+      {
+         PUSH_TX( db, make_transfer( alice_id, bob_id, 1 + i, alice_private_key ) );
+         PUSH_TX( db, make_transfer( bob_id, alice_id, 2 + i, bob_private_key ) );
+      }
+      const signed_block b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                                                database::skip_nothing );
+      const int64_t alice_balance = get_balance( alice_id, asset_id_type() );
+      const int64_t bob_balance = get_balance( bob_id, asset_id_type() );
+
+      db.pop_block();
+      db.clear_pending();
+      BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), 100000 );
+
+      db.set_transaction_verify_threads( 4 );
+      BOOST_CHECK_EQUAL( db.get_transaction_verify_threads(), 4u );
+      PUSH_BLOCK( db, b );
+      BOOST_CHECK( db.head_block_id() == b.id() );
+      BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), alice_balance );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), bob_balance );
+
+      // a transaction the verifier rejects still fails when applied
+      signed_block bad = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                                            database::skip_nothing );
+      db.pop_block();
+      db.clear_pending();
+      bad.transactions.push_back( make_transfer( alice_id, bob_id, 5, bob_private_key ) );
+      bad.transaction_merkle_root = bad.calculate_merkle_root();
+      bad.sign( init_account_priv_key );
+      GRAPHENE_REQUIRE_THROW( PUSH_BLOCK( db, bad ), fc::exception );
+      BOOST_CHECK( db.head_block_id() == b.id() );
+
+      db.set_transaction_verify_threads( 0 );
+      BOOST_CHECK_EQUAL( db.get_transaction_verify_threads(), 0u );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( generate_block_from_pending_state, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      generate_block( database::skip_authority_check );
+      transfer( account_id_type(), alice_id, asset( 100000 ) );
+      generate_block();
+
+      auto push_transfer = [&]( share_type amount )
+      {
+         signed_transaction tx;
+         transfer_operation xfer_op;
+         xfer_op.from = alice_id;
+         xfer_op.to = bob_id;
+         xfer_op.amount = asset( amount, asset_id_type() );
+         xfer_op.fee = asset( 0, asset_id_type() );
+         tx.operations.push_back( xfer_op );
+         set_expiration( db, tx );
+         sign( tx, alice_private_key );
+         PUSH_TX( db, tx );
+      };
+      auto produce = [&]() -> signed_block
+      {
+         return db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1), init_account_priv_key,
+                                   database::skip_nothing );
+      };
+
+      // the block is made of the transactions as they were applied when pushed
+      for( uint32_t i = 1; i <= 20; ++i )
+         push_transfer( i );
+      const signed_block b1 = produce();
+      BOOST_CHECK_EQUAL( b1.transactions.size(), 20u );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 210 );
+
+      // after popping the block, its transactions come back when the next block is pushed
+      db.pop_block();
+      push_transfer( 1000 );
+      const signed_block b2 = produce();
+      BOOST_CHECK_EQUAL( b2.transactions.size(), 1u );
+      // the popped transfers are pending again
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 1210 );
+
+      push_transfer( 2000 );
+      const signed_block b3 = produce();
+      BOOST_CHECK_EQUAL( b3.transactions.size(), 21u );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 3210 );
+      BOOST_CHECK_EQUAL( get_balance( alice_id, asset_id_type() ), 100000 - 3210 );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( generate_block_rechecks_skipped_pending_state, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      generate_block( database::skip_authority_check );
+      transfer( account_id_type(), alice_id, asset( 100000 ) );
+      generate_block();
+
+      auto make_transfer = [&]( share_type amount )
+      {
+         signed_transaction tx;
+         transfer_operation xfer_op;
+         xfer_op.from = alice_id;
+         xfer_op.to = bob_id;
+         xfer_op.amount = asset( amount, asset_id_type() );
+         xfer_op.fee = asset( 0, asset_id_type() );
+         tx.operations.push_back( xfer_op );
+         set_expiration( db, tx );
+         return tx;
+      };
+
+      // pushed without checking its missing signature
+      PUSH_TX( db, make_transfer( 1 ), database::skip_transaction_signatures );
+      signed_transaction signed_tx = make_transfer( 2 );
+      sign( signed_tx, alice_private_key );
+      PUSH_TX( db, signed_tx );
+      BOOST_CHECK_EQUAL( get_balance( bob_id, asset_id_type() ), 3 );
+
+      // a producer that checks signatures must not reuse the pending state, the block is rebuilt without the
+      // unsigned transfer
+      const signed_block b = db.generate_block( db.get_slot_time(1), db.get_scheduled_witness(1),
+                                                init_account_priv_key, database::skip_nothing );
+      BOOST_REQUIRE_EQUAL( b.transactions.size(), 1u );
+      BOOST_CHECK( b.transactions[0].id() == signed_tx.id() );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_FIXTURE_TEST_CASE( execution_profiler_test, database_fixture )
+{
+   try
+   {
+      ACTORS( (alice) );
+      auto& profiler = db.get_execution_profiler();
+      // disabled by default, nothing is recorded
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      generate_block();
+      BOOST_CHECK( profiler.get_profile().empty() );
+
+      profiler.set_enabled( true );
+      transfer( account_id_type(), alice_id, asset( 1000 ) );
+      // its authority is checked when it is pushed, outside of applying a block
+      signed_transaction tx;
+      transfer_operation xfer_op;
+      xfer_op.from = alice_id;
+      xfer_op.to = account_id_type();
+      xfer_op.amount = asset( 1 );
+      xfer_op.fee = asset( 0 );
+      tx.operations.push_back( xfer_op );
+      set_expiration( db, tx );
+      sign( tx, alice_private_key );
+      PUSH_TX( db, tx );
+      generate_block();
+      generate_block();
+      const auto profile = profiler.get_profile();
+      auto find = [&]( const string& category, const string& name ) {
+         return std::find_if( profile.begin(), profile.end(), [&]( const execution_profile_entry& e ) {
+            return e.category == category && e.name == name;
+         } );
+      };
+      auto total = find( "block", "block_total" );
+      BOOST_REQUIRE( total != profile.end() );
+      BOOST_CHECK_EQUAL( total->count, 2u );
+      BOOST_CHECK_LE( total->p50_us, total->p99_us );
+      BOOST_CHECK( find( "block", "block_transactions" ) != profile.end() );
+      auto authority = find( "transaction", "transaction_authority_check" );
+      BOOST_REQUIRE( authority != profile.end() );
+      BOOST_CHECK_GE( authority->count, 1u );
+      BOOST_CHECK( find( "block", "transaction_authority_check" ) == profile.end() );
+      auto transfers = find( "operation", "transfer_operation" );
+      BOOST_REQUIRE( transfers != profile.end() );
+      // applied when pushed and again with the block
+      BOOST_CHECK_GE( transfers->count, 2u );
+      uint64_t bucketed = 0;
+      for( uint64_t n : transfers->buckets )
+         bucketed += n;
+      BOOST_CHECK_EQUAL( bucketed, transfers->count );
+
+      profiler.reset();
+      BOOST_CHECK( profiler.get_profile().empty() );
+      profiler.set_enabled( false );
+   }
+   catch (fc::exception& e)
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/chain/database.hpp>
+#include <graphene/chain/data_transaction_object.hpp>
+#include <graphene/chain/free_data_product_object.hpp>
+#include <graphene/chain/protocol/data_transaction_ops.hpp>
+#include <graphene/chain/protocol/pay_data_transaction_ops.hpp>
+#include <graphene/app/database_api.hpp>
+
+#include "../common/database_fixture.hpp"
+
+using namespace graphene::chain;
+using namespace graphene::chain::test;
+
+namespace {
+
+/**
+ *  A merchant buying from a datasource through a free data product.  The memberships are set directly, they
+ *  take committee proposals and maintenance intervals to obtain through operations.
+ */
+struct data_market_fixture : database_fixture
+{
+   const uint64_t price = 1000;
+   account_id_type merchant_id;
+   account_id_type datasource_id;
+   object_id_type product_id;
+
+   data_market_fixture()
+   {
+      merchant_id = create_account( "merchant" ).id;
+      datasource_id = create_account( "datasource" ).id;
+      transfer( account_id_type(), merchant_id, asset( 100000 ) );
+      transfer( account_id_type(), datasource_id, asset( 100000 ) );
+      // outside of the pending state, so that producing a block does not drop the changes below
+      generate_block();
+
+      db.modify( merchant_id( db ), []( account_object& a ) {
+         a.merchant_expiration_date = time_point_sec::maximum();
+         a.data_transaction_member_expiration_date = time_point_sec::maximum();
+      });
+      db.modify( datasource_id( db ), []( account_object& a ) {
+         a.datasource_expiration_date = time_point_sec::maximum();
+      });
+      product_id = db.create<free_data_product_object>( [&]( free_data_product_object& p ) {
+         p.product_name = "product";
+         p.datasource = datasource_id;
+         p.issuer = datasource_id;
+         p.price = price;
+         p.status = 1;
+         schema_context_object schema;
+         schema.version = "1.0.0";
+         schema.schema_context = "{\"privacy\":\"false\"}";
+         p.schema_contexts.push_back( schema );
+         p.create_date_time = db.head_block_time();
+      }).id;
+   }
+
+   void push_op( const operation& op )
+   {
+      trx.clear();
+      trx.operations.push_back( op );
+      for( auto& o : trx.operations ) db.current_fee_schedule().set_fee( o );
+      set_expiration( db, trx );
+      PUSH_TX( db, trx, ~0 );
+      trx.clear();
+   }
+
+   void create_request( const string& request_id )
+   {
+      data_transaction_create_operation op;
+      op.request_id = request_id;
+      op.product_id = product_id;
+      op.version = "1.0.0";
+      op.params = "{}";
+      op.requester = merchant_id;
+      op.create_date_time = db.head_block_time();
+      push_op( op );
+   }
+
+   void upload( const string& request_id )
+   {
+      data_transaction_datasource_upload_operation op;
+      op.request_id = request_id;
+      op.requester = merchant_id;
+      op.datasource = datasource_id;
+      push_op( op );
+   }
+
+   void validate_error( const string& request_id )
+   {
+      data_transaction_datasource_validate_error_operation op;
+      op.request_id = request_id;
+      op.datasource = datasource_id;
+      push_op( op );
+   }
+
+   void pay( const string& request_id )
+   {
+      pay_data_transaction_operation op;
+      op.from = merchant_id;
+      op.to = datasource_id;
+      op.amount = asset( price );
+      op.request_id = request_id;
+      push_op( op );
+   }
+
+   void complain( const string& request_id )
+   {
+      data_transaction_complain_operation op;
+      op.request_id = request_id;
+      op.requester = merchant_id;
+      op.datasource = datasource_id;
+      op.merchant_copyright_hash = "merchant-hash";
+      op.datasource_copyright_hash = "datasource-hash";
+      op.create_date_time = db.head_block_time();
+      push_op( op );
+   }
+
+   /** @return the status of the datasource as reported by the API */
+   int datasource_status( const string& request_id )
+   {
+      graphene::app::database_api db_api( db );
+      auto dto = db_api.get_data_transaction_by_request_id( request_id );
+      FC_ASSERT( dto.valid() && dto->datasources_status.size() == 1 );
+      FC_ASSERT( dto->datasources_status.front().datasource == datasource_id );
+      return dto->datasources_status.front().status;
+   }
+};
+
+}
+
+BOOST_FIXTURE_TEST_SUITE( data_transaction_tests, data_market_fixture )
+
+BOOST_AUTO_TEST_CASE( upload_pay_and_complain )
+{ try {
+   create_request( "request-1" );
+   const auto& by_request = db.get_index_type<data_transaction_index>().indices().get<by_request_id>();
+   BOOST_REQUIRE( by_request.find( "request-1" ) != by_request.end() );
+   BOOST_CHECK_EQUAL( int(by_request.find( "request-1" )->status), data_transaction_status_confirmed );
+   BOOST_CHECK_EQUAL( datasource_status( "request-1" ), data_transaction_datasource_status_init );
+   // request ids are unique
+   GRAPHENE_REQUIRE_THROW( create_request( "request-1" ), fc::exception );
+
+   // nothing to pay or complain about before the datasource uploaded
+   GRAPHENE_REQUIRE_THROW( pay( "request-1" ), fc::exception );
+   GRAPHENE_REQUIRE_THROW( complain( "request-1" ), fc::exception );
+
+   upload( "request-1" );
+   BOOST_CHECK_EQUAL( datasource_status( "request-1" ), data_transaction_datasource_status_uploaded );
+   // the datasource delivered, it cannot report a validation error any more
+   GRAPHENE_REQUIRE_THROW( validate_error( "request-1" ), fc::exception );
+
+   const auto& core = asset_id_type()( db );
+   const int64_t merchant_balance = get_balance( merchant_id( db ), core );
+   const int64_t datasource_balance = get_balance( datasource_id( db ), core );
+   pay( "request-1" );
+   BOOST_CHECK_EQUAL( datasource_status( "request-1" ), data_transaction_datasource_status_payed );
+   const auto pay_fee = db.current_fee_schedule().calculate_fee( pay_data_transaction_operation() ).amount.value;
+   BOOST_CHECK_EQUAL( get_balance( merchant_id( db ), core ), merchant_balance - int64_t(price) - pay_fee );
+   // the datasource gets the price less the commission
+   BOOST_CHECK_GT( get_balance( datasource_id( db ), core ), datasource_balance );
+   BOOST_CHECK_LE( get_balance( datasource_id( db ), core ), datasource_balance + int64_t(price) );
+   // paying twice is rejected
+   GRAPHENE_REQUIRE_THROW( pay( "request-1" ), fc::exception );
+
+   complain( "request-1" );
+   const auto& complaints = db.get_index_type<data_transaction_complain_index>().indices().get<by_request_id>();
+   auto complaint = complaints.find( "request-1" );
+   BOOST_REQUIRE( complaint != complaints.end() );
+   BOOST_CHECK( complaint->requester == merchant_id );
+   BOOST_CHECK( complaint->datasource == datasource_id );
+   // one complaint per request
+   GRAPHENE_REQUIRE_THROW( complain( "request-1" ), fc::exception );
+
+   // the statuses survive a block and are undone with it
+   generate_block();
+   BOOST_CHECK_EQUAL( datasource_status( "request-1" ), data_transaction_datasource_status_payed );
+   db.pop_block();
+   BOOST_CHECK( by_request.find( "request-1" ) == by_request.end() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( validate_error )
+{ try {
+   create_request( "request-2" );
+   validate_error( "request-2" );
+   BOOST_CHECK_EQUAL( datasource_status( "request-2" ), data_transaction_datasource_status_error );
+
+   // reported once, and a request that failed validation is neither payed nor complained about
+   GRAPHENE_REQUIRE_THROW( validate_error( "request-2" ), fc::exception );
+   GRAPHENE_REQUIRE_THROW( pay( "request-2" ), fc::exception );
+   GRAPHENE_REQUIRE_THROW( complain( "request-2" ), fc::exception );
+   BOOST_CHECK_EQUAL( datasource_status( "request-2" ), data_transaction_datasource_status_error );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_CASE( unknown_datasource_and_request )
+{ try {
+   create_request( "request-3" );
+
+   // only the datasource of the product takes part in the request
+   data_transaction_datasource_upload_operation op;
+   op.request_id = "request-3";
+   op.requester = merchant_id;
+   op.datasource = account_id_type();
+   GRAPHENE_REQUIRE_THROW( push_op( op ), fc::exception );
+   BOOST_CHECK_EQUAL( datasource_status( "request-3" ), data_transaction_datasource_status_init );
+
+   GRAPHENE_REQUIRE_THROW( upload( "no-such-request" ), fc::exception );
+   GRAPHENE_REQUIRE_THROW( validate_error( "no-such-request" ), fc::exception );
+   GRAPHENE_REQUIRE_THROW( complain( "no-such-request" ), fc::exception );
+
+   graphene::app::database_api db_api( db );
+   BOOST_CHECK( !db_api.get_data_transaction_by_request_id( "no-such-request" ).valid() );
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
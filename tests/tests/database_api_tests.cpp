@@ -24,7 +24,15 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <graphene/app/api.hpp>
+#include <graphene/app/api_reader_pool.hpp>
 #include <graphene/app/database_api.hpp>
+#include <graphene/chain/contract_table_objects.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/thread/thread.hpp>
+
+#include <mutex>
 
 #include "../common/database_fixture.hpp"
 
@@ -72,4 +80,360 @@ BOOST_FIXTURE_TEST_SUITE(database_api_tests, database_fixture)
       } FC_LOG_AND_RETHROW()
   }
 
+  BOOST_AUTO_TEST_CASE(data_transaction_complain_rankings) {
+      try {
+          ACTORS((alice)(bob)(carol));
+          graphene::app::database_api db_api(db);
+
+          const fc::time_point_sec base(1536001200); // aligned to an account_bucket_counter bucket
+          auto complain = [&](account_id_type requester, account_id_type datasource, uint32_t offset_seconds) {
+              db.create<data_transaction_complain_object>([&](data_transaction_complain_object& obj) {
+                  obj.requester = requester;
+                  obj.datasource = datasource;
+                  obj.data_transaction_request_id = fc::to_string(uint64_t(obj.id.instance()));
+                  obj.create_date_time = base + offset_seconds;
+              });
+          };
+
+          // requests spread over a partial head bucket, two whole buckets and a partial tail bucket
+          complain(alice_id, carol_id, 10);
+          complain(alice_id, carol_id, 3600);
+          complain(alice_id, bob_id, 3700);
+          complain(bob_id, carol_id, 7300);
+          complain(bob_id, carol_id, 10900);
+          complain(bob_id, carol_id, 10950);
+          complain(bob_id, alice_id, 11000);
+          complain(carol_id, alice_id, 20000);
+
+          auto requesters = db_api.list_data_transaction_complain_requesters(base + 5, base + 10920, 10);
+          BOOST_REQUIRE_EQUAL(requesters.size(), 2u);
+          BOOST_CHECK_EQUAL(requesters[alice_id], 3u);
+          BOOST_CHECK_EQUAL(requesters[bob_id], 2u);
+
+          auto top_requester = db_api.list_data_transaction_complain_requesters(base, base + 20000, 1);
+          BOOST_REQUIRE_EQUAL(top_requester.size(), 1u);
+          BOOST_CHECK_EQUAL(top_requester[bob_id], 4u);
+
+          auto datasources = db_api.list_data_transaction_complain_datasources(base + 3600, base + 7199, 10);
+          BOOST_REQUIRE_EQUAL(datasources.size(), 2u);
+          BOOST_CHECK_EQUAL(datasources[carol_id], 1u);
+          BOOST_CHECK_EQUAL(datasources[bob_id], 1u);
+
+          // counters follow undo
+          {
+              auto session = db._undo_db.start_undo_session();
+              complain(alice_id, carol_id, 7200);
+              complain(alice_id, carol_id, 7201);
+              BOOST_CHECK_EQUAL(db_api.list_data_transaction_complain_requesters(base, base + 20000, 1)[alice_id], 5u);
+              session.undo();
+          }
+          BOOST_CHECK_EQUAL(db_api.list_data_transaction_complain_datasources(base, base + 20000, 1)[carol_id], 5u);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(subscription_exact_matching) {
+      try {
+          using namespace graphene::app;
+          auto dispatcher = subscription_dispatcher::get(db);
+          auto ignore = [](const fc::variant&) {};
+          auto first = dispatcher->create_subscriber(ignore, subscription_overflow_coalesce);
+          auto second = dispatcher->create_subscriber(ignore, subscription_overflow_coalesce);
+
+          object_id_type a = account_id_type(1);
+          object_id_type b = account_id_type(2);
+          object_id_type c = asset_id_type(0);
+
+          BOOST_CHECK(dispatcher->subscribe_to_item(first, a));
+          BOOST_CHECK(!dispatcher->subscribe_to_item(first, a));
+          dispatcher->subscribe_to_item(second, b);
+          dispatcher->subscribe_to_item(second, a);
+          BOOST_CHECK(!dispatcher->is_subscribed_to_item(first, b));
+
+          db.changed_objects(vector<object_id_type>{c, b, a}, flat_set<account_id_type>());
+          BOOST_CHECK(dispatcher->matched_items(first) == vector<object_id_type>{a});
+          BOOST_CHECK(dispatcher->matched_items(second) == (vector<object_id_type>{b, a}));
+
+          // removed objects stay subscribed, an undo or a fork switch may bring them back
+          db.removed_objects(vector<object_id_type>{a}, vector<const object*>(), flat_set<account_id_type>());
+          BOOST_CHECK(dispatcher->matched_items(first) == vector<object_id_type>{a});
+          db.new_objects(vector<object_id_type>{a, b}, flat_set<account_id_type>());
+          BOOST_CHECK(dispatcher->matched_items(first) == vector<object_id_type>{a});
+          BOOST_CHECK(dispatcher->matched_items(second) == (vector<object_id_type>{b, a}));
+          BOOST_CHECK(dispatcher->is_subscribed_to_item(second, a));
+
+          dispatcher->remove_subscriber(second);
+          db.changed_objects(vector<object_id_type>{b}, flat_set<account_id_type>());
+          BOOST_CHECK(dispatcher->matched_items(second).empty());
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(subscription_failed_deliveries) {
+      try {
+          using namespace graphene::app;
+          auto dispatcher = subscription_dispatcher::get(db);
+          const auto before = dispatcher->get_metrics();
+          auto ignore = dispatcher->create_subscriber([](const fc::variant&) {}, subscription_overflow_coalesce);
+          auto failing = dispatcher->create_subscriber([](const fc::variant&) { FC_THROW("callback failed"); },
+                                                       subscription_overflow_coalesce);
+          for (int i = 0; i < 2; ++i) {
+              dispatcher->push(ignore, fc::variant(i));
+              dispatcher->push(failing, fc::variant(i));
+          }
+
+          // the callbacks run on the dispatcher thread
+          auto metrics = dispatcher->get_metrics();
+          for (int i = 0; i < 500 && metrics.delivered + metrics.failed < before.delivered + before.failed + 4; ++i) {
+              fc::usleep(fc::milliseconds(10));
+              metrics = dispatcher->get_metrics();
+          }
+          BOOST_CHECK_EQUAL(metrics.delivered, before.delivered + 2);
+          BOOST_CHECK_EQUAL(metrics.failed, before.failed + 2);
+
+          dispatcher->remove_subscriber(ignore);
+          dispatcher->remove_subscriber(failing);
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(api_latency_buckets) {
+      try {
+          using namespace graphene::app;
+          api_reader_pool pool(db);
+          // the same buckets as the execution profiler, bucket i holds latencies below 2^(i+1) us
+          for (uint64_t us : {0, 1, 3, 3, 100})
+              pool.record_latency("get_objects", us);
+
+          const auto metrics = pool.get_latency_metrics();
+          BOOST_REQUIRE_EQUAL(metrics.methods.size(), 1u);
+          const auto& histogram = metrics.methods.front();
+          BOOST_CHECK_EQUAL(histogram.count, 5u);
+          BOOST_CHECK_EQUAL(histogram.total_us, 107u);
+          BOOST_CHECK_EQUAL(histogram.max_us, 100u);
+          BOOST_CHECK(histogram.buckets == (vector<uint64_t>{2, 2, 0, 0, 0, 0, 1}));
+          BOOST_CHECK_EQUAL(histogram.p50_us, 4u);
+          BOOST_CHECK_EQUAL(histogram.p99_us, 100u);
+
+          pool.clear_latency_metrics();
+          BOOST_CHECK(pool.get_latency_metrics().methods.empty());
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(asset_holder_counts) {
+      try {
+          ACTORS((alice)(bob));
+          const auto& uia = create_user_issued_asset("HOLDS");
+          const asset_id_type uia_id = uia.id;
+          graphene::app::asset_api asset_api(db);
+
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(uia_id), 0);
+
+          db.adjust_balance(alice_id, asset(300, uia_id));
+          db.adjust_balance(bob_id, asset(500, uia_id));
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(uia_id), 2);
+
+          auto holders = asset_api.get_asset_holders(uia_id, 0, 10);
+          BOOST_REQUIRE_EQUAL(holders.size(), 2u);
+          BOOST_CHECK(holders[0].account_id == bob_id);
+          BOOST_CHECK_EQUAL(holders[0].amount.value, 500);
+          BOOST_CHECK_EQUAL(holders[1].name, "alice");
+
+          holders = asset_api.get_asset_holders(uia_id, 1, 10);
+          BOOST_REQUIRE_EQUAL(holders.size(), 1u);
+          BOOST_CHECK(holders[0].account_id == alice_id);
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders(uia_id, 0, 1).size(), 1u);
+
+          // emptied balances stop counting, and the counts follow undo
+          {
+              auto session = db._undo_db.start_undo_session();
+              db.adjust_balance(alice_id, asset(-300, uia_id));
+              BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(uia_id), 1);
+              BOOST_CHECK_EQUAL(asset_api.get_asset_holders(uia_id, 0, 10).size(), 1u);
+              session.undo();
+          }
+          BOOST_CHECK_EQUAL(asset_api.get_asset_holders_count(uia_id), 2);
+
+          auto all = asset_api.get_all_asset_holders();
+          auto itr = std::find_if(all.begin(), all.end(), [&](const graphene::app::asset_holders& h) { return h.asset_id == uia_id; });
+          BOOST_REQUIRE(itr != all.end());
+          BOOST_CHECK_EQUAL(itr->count, 2);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(table_rows_paging) {
+      try {
+          ACTOR(tabler);
+          const uint64_t code = tabler_id.instance.value;
+          db.modify(tabler_id(db), [](account_object& a) {
+              a.code_version = "1";
+              a.abi.structs.emplace_back("record", "", vector<field_def>{ field_def("id", "uint64"), field_def("balance", "uint64") });
+              a.abi.tables.emplace_back(name("records"), "i64", vector<field_name>{ "id" }, vector<type_name>{ "uint64" }, "record");
+          });
+
+          // rows 0..9 with balance 100 - id, and an idx64 index on the balance
+          const name records("records");
+          const table_id primary = db.create<table_id_object>([&](table_id_object& t) {
+              t.code = code; t.scope = name(code); t.table = records; t.count = 10;
+          }).id;
+          const table_id secondary = db.create<table_id_object>([&](table_id_object& t) {
+              t.code = code; t.scope = name(code); t.table = name(records.value & 0xFFFFFFFFFFFFFFF0ULL); t.count = 10;
+          }).id;
+          for (uint64_t i = 0; i < 10; ++i) {
+              db.create<key_value_object>([&](key_value_object& o) {
+                  o.t_id = primary; o.primary_key = i; o.value = fc::raw::pack(std::make_pair(i, 100 - i));
+              });
+              db.create<index64_object>([&](index64_object& o) {
+                  o.t_id = secondary; o.primary_key = i; o.secondary_key = 100 - i;
+              });
+          }
+
+          graphene::app::database_api api(db);
+          auto page = api.get_table_rows("tabler", "records", code, 2, 7, 3, 0, false);
+          BOOST_REQUIRE_EQUAL(page.rows.size(), 3u);
+          BOOST_CHECK(page.more);
+          BOOST_CHECK_EQUAL(page.next_key, 5u);
+          BOOST_CHECK_EQUAL(page.rows[0]["id"].as_uint64(), 2u);
+          BOOST_CHECK_EQUAL(page.rows[2]["balance"].as_uint64(), 96u);
+
+          page = api.get_table_rows("tabler", "records", code, page.next_key, 7, 3, 0, false);
+          BOOST_REQUIRE_EQUAL(page.rows.size(), 3u);
+          BOOST_CHECK(!page.more);
+          BOOST_CHECK_EQUAL(page.rows[2]["id"].as_uint64(), 7u);
+
+          page = api.get_table_rows("tabler", "records", code, 0, UINT64_MAX, 2, 0, true);
+          BOOST_REQUIRE_EQUAL(page.rows.size(), 2u);
+          BOOST_CHECK(page.rows[1].as<bytes>(1) == fc::raw::pack(std::make_pair(uint64_t(1), uint64_t(99))));
+
+          // by balance, the row with the highest id comes first
+          page = api.get_table_rows("tabler", "records", code, 0, UINT64_MAX, 4, 1, false);
+          BOOST_REQUIRE_EQUAL(page.rows.size(), 4u);
+          BOOST_CHECK_EQUAL(page.rows[0]["id"].as_uint64(), 9u);
+          BOOST_CHECK(page.more);
+          BOOST_CHECK_EQUAL(page.next_key, 95u);
+
+          BOOST_CHECK(api.get_table_rows("tabler", "records", code, 0, UINT64_MAX, 10, 2, false).rows.empty());
+
+          // a third index where all rows share one key, pages continue by primary key within the run
+          const table_id same_key = db.create<table_id_object>([&](table_id_object& t) {
+              t.code = code; t.scope = name(code); t.table = name((records.value & 0xFFFFFFFFFFFFFFF0ULL) | 2); t.count = 10;
+          }).id;
+          for (uint64_t i = 0; i < 10; ++i) {
+              db.create<index64_object>([&](index64_object& o) {
+                  o.t_id = same_key; o.primary_key = i; o.secondary_key = 7;
+              });
+          }
+          vector<uint64_t> ids;
+          page = api.get_table_rows("tabler", "records", code, 0, UINT64_MAX, 3, 3, false);
+          for (;;) {
+              BOOST_REQUIRE_LE(page.rows.size(), 3u);
+              for (const auto& row : page.rows)
+                  ids.push_back(row["id"].as_uint64());
+              if (!page.more)
+                  break;
+              BOOST_CHECK_EQUAL(page.next_key, 7u);
+              BOOST_REQUIRE_LT(ids.size(), 10u);
+              page = api.get_table_rows("tabler", "records", code, page.next_key, UINT64_MAX, 3, 3, false,
+                                        page.next_primary_key);
+          }
+          BOOST_REQUIRE_EQUAL(ids.size(), 10u);
+          for (uint64_t i = 0; i < 10; ++i)
+              BOOST_CHECK_EQUAL(ids[i], i);
+          GRAPHENE_REQUIRE_THROW(api.get_table_rows("tabler", "records", code, 0, UINT64_MAX, 1001, 0, false), fc::exception);
+
+          // the cached serializer is rebuilt once the code version changes
+          auto cache = graphene::app::abi_serializer_cache::get(db);
+          BOOST_CHECK_EQUAL(cache->size(), 1u);
+          db.modify(tabler_id(db), [](account_object& a) {
+              a.code_version = "2";
+              a.abi.structs[0].fields[1].name = "amount";
+          });
+          page = api.get_table_rows("tabler", "records", code, 0, 0, 1, 0, false);
+          BOOST_REQUIRE_EQUAL(page.rows.size(), 1u);
+          BOOST_CHECK_EQUAL(page.rows[0]["amount"].as_uint64(), 100u);
+
+      } FC_LOG_AND_RETHROW()
+  }
+
+  BOOST_AUTO_TEST_CASE(irreversible_block_consumers) {
+      try {
+          generate_blocks(30);
+          fc::temp_directory cursors(graphene::utilities::temp_directory_path());
+          auto stream = graphene::app::irreversible_block_stream::get(db);
+          stream->set_cursor_directory(cursors.path());
+
+          std::mutex mutex;
+          vector<signed_block> seen;
+          auto collect = [&](const signed_block& b) {
+              std::lock_guard<std::mutex> lock(mutex);
+              seen.push_back(b);
+          };
+          auto caught_up = [&](const string& name) {
+              // the chain thread hands out the blocks while it sleeps here
+              for (int i = 0; i < 2000; ++i) {
+                  auto metrics = stream->get_metrics();
+                  auto itr = std::find_if(metrics.begin(), metrics.end(),
+                                          [&](const graphene::app::irreversible_consumer_metrics& m) { return m.name == name; });
+                  if (itr != metrics.end() && (itr->lag == 0 || itr->failed))
+                      return *itr;
+                  fc::usleep(fc::milliseconds(5));
+              }
+              BOOST_FAIL("consumer " + name + " did not catch up");
+              return graphene::app::irreversible_consumer_metrics();
+          };
+
+          // catches up from genesis in batches, in order and with the stored blocks
+          stream->subscribe("collector", collect, 0, 7);
+          const uint32_t lib = db.get_dynamic_global_properties().last_irreversible_block_num;
+          BOOST_REQUIRE_GT(lib, 10u);
+          auto m = caught_up("collector");
+          BOOST_CHECK_EQUAL(m.cursor, lib);
+          BOOST_CHECK_EQUAL(m.blocks_handled, lib);
+          {
+              std::lock_guard<std::mutex> lock(mutex);
+              BOOST_REQUIRE_EQUAL(seen.size(), lib);
+              for (uint32_t i = 0; i < lib; ++i)
+                  BOOST_CHECK_EQUAL(seen[i].block_num(), i + 1);
+              BOOST_CHECK(seen.back().id() == db.fetch_block_by_number(lib)->id());
+          }
+
+          // follows new irreversible blocks
+          generate_blocks(10);
+          const uint32_t lib2 = db.get_dynamic_global_properties().last_irreversible_block_num;
+          BOOST_REQUIRE_GT(lib2, lib);
+          BOOST_CHECK_EQUAL(caught_up("collector").cursor, lib2);
+
+          // resumes after the block in its cursor file
+          stream->unsubscribe("collector");
+          generate_blocks(10);
+          {
+              std::lock_guard<std::mutex> lock(mutex);
+              seen.clear();
+          }
+          stream->subscribe("collector", collect);
+          const uint32_t lib3 = db.get_dynamic_global_properties().last_irreversible_block_num;
+          BOOST_CHECK_EQUAL(caught_up("collector").cursor, lib3);
+          {
+              std::lock_guard<std::mutex> lock(mutex);
+              BOOST_REQUIRE(!seen.empty());
+              BOOST_CHECK_EQUAL(seen.front().block_num(), lib2 + 1);
+              BOOST_CHECK_EQUAL(seen.size(), lib3 - lib2);
+          }
+          GRAPHENE_REQUIRE_THROW(stream->subscribe("collector", collect), fc::exception);
+
+          // a failing consumer stops before the block and does not hold up the others
+          stream->subscribe("failing", [](const signed_block& b) { FC_ASSERT(b.block_num() < 5); });
+          m = caught_up("failing");
+          BOOST_CHECK(m.failed);
+          BOOST_CHECK_EQUAL(m.cursor, 4u);
+          BOOST_CHECK(!m.last_error.empty());
+
+          graphene::app::database_api api(db);
+          BOOST_CHECK_EQUAL(api.get_irreversible_consumer_metrics().size(), 2u);
+          stream->unsubscribe("failing");
+          stream->unsubscribe("collector");
+
+      } FC_LOG_AND_RETHROW()
+  }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -111,6 +111,48 @@ BOOST_AUTO_TEST_CASE(failed_modify_test)
     BOOST_CHECK_NE(db.find_object(obj_id), nullptr);
 } FC_LOG_AND_RETHROW() }
 
+/**
+ * Check that the dense id table of account balances follows create, remove, undo and failed modifies
+ */
+BOOST_AUTO_TEST_CASE( dense_id_lookup_test )
+{ try {
+    database db;
+    const auto& idx = db.get_index_type<account_balance_index>();
+    auto create_balance = [&]( uint32_t owner ) {
+       return db.create<account_balance_object>( [&]( account_balance_object& obj ) {
+          obj.owner = account_id_type( owner );
+       }).id;
+    };
+
+    account_balance_id_type id1 = create_balance( 1 );
+    account_balance_id_type id2 = create_balance( 2 );
+    BOOST_CHECK( db.find( id1 ) == &*idx.indices().find( id1 ) );
+    BOOST_CHECK_EQUAL( db.get( id2 ).owner.instance.value, 2u );
+
+    {
+       auto session = db._undo_db.start_undo_session();
+       db.remove( db.get( id2 ) );
+       BOOST_CHECK( db.find( id2 ) == nullptr );
+       account_balance_id_type id3 = create_balance( 3 );
+       BOOST_CHECK( db.find( id3 ) != nullptr );
+       session.undo();
+       BOOST_CHECK( db.find( id3 ) == nullptr );
+    }
+
+    BOOST_REQUIRE( db.find( id2 ) != nullptr );
+    BOOST_CHECK( db.find( id2 ) == &*idx.indices().find( id2 ) );
+    BOOST_CHECK_EQUAL( db.get( id2 ).owner.instance.value, 2u );
+    BOOST_CHECK( db.find( account_balance_id_type( 1000 ) ) == nullptr );
+
+    // a modify that breaks a unique index erases the object, the table must not keep pointing at it
+    BOOST_CHECK_THROW( db.modify( db.get( id1 ), []( account_balance_object& obj ) {
+                          obj.owner = account_id_type( 2 );
+                       }), fc::assert_exception );
+    BOOST_CHECK( db.find( id1 ) == nullptr );
+    BOOST_CHECK( idx.find( id1 ) == nullptr );
+    BOOST_CHECK( db.find( id2 ) == &*idx.indices().find( id2 ) );
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE( db_store_i64_undo )
 {
    try {
@@ -0,0 +1,223 @@
+/*
+    Copyright (C) 2018 gjc
+
+    This file is part of gjc-core.
+
+    gjc-core is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gjc-core is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gjc-core.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <graphene/net/peer_database.hpp>
+#include <graphene/utilities/tempdir.hpp>
+
+#include <fc/io/json.hpp>
+
+#include <fstream>
+
+using namespace graphene::net;
+
+namespace {
+
+fc::ip::endpoint test_endpoint( uint16_t n )
+{
+   return fc::ip::endpoint( fc::ip::address( "10.0.0.1" ), 1000 + n );
+}
+
+potential_peer_record test_record( uint16_t n )
+{
+   potential_peer_record record( test_endpoint( n ), fc::time_point_sec( 1500000000 + n ), last_connection_succeeded );
+   record.number_of_successful_connection_attempts = n;
+   record.round_trip_delay_ms = 10 * n;
+   return record;
+}
+
+void append_raw( const fc::path& filename, uint32_t entry_size, const std::vector<char>& data )
+{
+   std::ofstream out( filename.generic_string(), std::ios::out | std::ios::binary | std::ios::app );
+   out.write( (const char*)&entry_size, sizeof(entry_size) );
+   out.write( data.data(), data.size() );
+}
+
+}
+
+BOOST_AUTO_TEST_SUITE(peer_database_tests)
+
+BOOST_AUTO_TEST_CASE( replay_binary_log )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path filename = data_dir.path() / "peers.dat";
+      const fc::path copy_filename = data_dir.path() / "peers_copy.dat";
+      {
+         peer_database db;
+         db.open( filename );
+         for( uint16_t i = 1; i <= 3; ++i )
+            db.update_entry( test_record( i ) );
+         potential_peer_record updated = test_record( 2 );
+         updated.number_of_failed_connection_attempts = 7;
+         db.update_entry( updated );
+         db.erase( test_endpoint( 3 ) );
+         // close() compacts, copy the log as it is while the node runs to replay the appended entries
+         fc::copy( filename, copy_filename );
+         db.close();
+      }
+      for( const fc::path& f : { copy_filename, filename } )
+      {
+         peer_database db;
+         db.open( f );
+         BOOST_CHECK_EQUAL( db.size(), 2 );
+         BOOST_REQUIRE( db.lookup_entry_for_endpoint( test_endpoint( 1 ) ) );
+         BOOST_CHECK_EQUAL( db.lookup_entry_for_endpoint( test_endpoint( 1 ) )->round_trip_delay_ms, 10 );
+         BOOST_REQUIRE( db.lookup_entry_for_endpoint( test_endpoint( 2 ) ) );
+         BOOST_CHECK_EQUAL( db.lookup_entry_for_endpoint( test_endpoint( 2 ) )->number_of_failed_connection_attempts, 7 );
+         BOOST_CHECK( !db.lookup_entry_for_endpoint( test_endpoint( 3 ) ) );
+      }
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( replay_truncated_tail )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path filename = data_dir.path() / "peers.dat";
+      {
+         peer_database db;
+         db.open( filename );
+         for( uint16_t i = 1; i <= 3; ++i )
+            db.update_entry( test_record( i ) );
+         db.close();
+      }
+      const uint64_t intact_size = fc::file_size( filename );
+
+      // an entry cut short by a crash while appending
+      append_raw( filename, 100, std::vector<char>( 10, 'x' ) );
+      {
+         peer_database db;
+         db.open( filename );
+         BOOST_CHECK_EQUAL( db.size(), 3 );
+         db.close();
+      }
+      // reopening rewrote the log without the damaged tail
+      BOOST_CHECK_EQUAL( fc::file_size( filename ), intact_size );
+
+      // a garbage size must be treated the same way instead of being allocated
+      append_raw( filename, 0xfffffff0, std::vector<char>( 10, 'x' ) );
+      {
+         peer_database db;
+         db.open( filename );
+         BOOST_CHECK_EQUAL( db.size(), 3 );
+         BOOST_CHECK( db.lookup_entry_for_endpoint( test_endpoint( 3 ) ) );
+         db.close();
+      }
+      BOOST_CHECK_EQUAL( fc::file_size( filename ), intact_size );
+
+      // only a size field left at the end
+      append_raw( filename, 40, std::vector<char>() );
+      {
+         peer_database db;
+         db.open( filename );
+         BOOST_CHECK_EQUAL( db.size(), 3 );
+      }
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( compaction )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path filename = data_dir.path() / "peers.dat";
+      potential_peer_record record = test_record( 1 );
+      // the packed log entry is the erased flag and the record, preceded by its size
+      const uint64_t entry_size = sizeof(uint32_t) + 1 + fc::raw::pack_size( record );
+
+      peer_database db;
+      db.open( filename );
+      for( uint32_t i = 0; i < 1100; ++i )
+      {
+         record.connected_seconds = i;
+         db.update_entry( record );
+      }
+      // the superseded entries were dropped while running, not only on close
+      BOOST_CHECK_LT( fc::file_size( filename ), 200 * entry_size );
+      db.close();
+      BOOST_CHECK_EQUAL( fc::file_size( filename ), sizeof(uint32_t) + entry_size );
+
+      db.open( filename );
+      BOOST_CHECK_EQUAL( db.size(), 1 );
+      BOOST_REQUIRE( db.lookup_entry_for_endpoint( record.endpoint ) );
+      BOOST_CHECK_EQUAL( db.lookup_entry_for_endpoint( record.endpoint )->connected_seconds, 1099 );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( import_legacy_json )
+{
+   try {
+      fc::temp_directory data_dir( graphene::utilities::temp_directory_path() );
+      const fc::path filename = data_dir.path() / "peers.dat";
+      const fc::path json_filename = data_dir.path() / "peers.json";
+      std::vector<potential_peer_record> records;
+      for( uint16_t i = 1; i <= 3; ++i )
+         records.push_back( test_record( i ) );
+      fc::json::save_to_file( records, json_filename );
+      {
+         peer_database db;
+         db.open( filename, json_filename );
+         BOOST_CHECK_EQUAL( db.size(), 3 );
+         BOOST_REQUIRE( db.lookup_entry_for_endpoint( test_endpoint( 2 ) ) );
+         BOOST_CHECK_EQUAL( db.lookup_entry_for_endpoint( test_endpoint( 2 ) )->round_trip_delay_ms, 20 );
+         db.close();
+      }
+      BOOST_CHECK( fc::exists( filename ) );
+
+      // once the binary database exists the JSON file is no longer read
+      fc::json::save_to_file( std::vector<potential_peer_record>{ test_record( 4 ) }, json_filename );
+      peer_database db;
+      db.open( filename, json_filename );
+      BOOST_CHECK_EQUAL( db.size(), 3 );
+      BOOST_CHECK( !db.lookup_entry_for_endpoint( test_endpoint( 4 ) ) );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_CASE( selection_score )
+{
+   try {
+      potential_peer_record unmeasured( test_endpoint( 1 ) );
+      // an unmeasured peer counts as 500ms
+      BOOST_CHECK_EQUAL( unmeasured.selection_score(), 500 );
+
+      potential_peer_record fast = unmeasured;
+      fast.round_trip_delay_ms = 10;
+      fast.download_rate = 4 * 1024 * 1024;
+      fast.connected_seconds = 3600;
+      fast.last_connection_disposition = last_connection_succeeded;
+      // latency 990, throughput capped at 1000, uptime 60 minutes and the successful connection
+      BOOST_CHECK_EQUAL( fast.selection_score(), 990 + 1000 + 60 + 250 );
+
+      potential_peer_record slow = unmeasured;
+      slow.round_trip_delay_ms = 5000;
+      BOOST_CHECK_EQUAL( slow.selection_score(), 0 );
+
+      potential_peer_record failing = fast;
+      failing.number_of_failed_connection_attempts = 4;
+      failing.last_connection_disposition = last_connection_failed;
+      BOOST_CHECK_EQUAL( failing.selection_score(), 990 + 1000 + 60 - 1000 );
+
+      BOOST_CHECK_GT( fast.selection_score(), failing.selection_score() );
+      BOOST_CHECK_GT( failing.selection_score(), unmeasured.selection_score() );
+      BOOST_CHECK_GT( unmeasured.selection_score(), slow.selection_score() );
+   } FC_LOG_AND_RETHROW()
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -25,7 +25,10 @@
 #include <boost/test/unit_test.hpp>
 
 #include <graphene/chain/database.hpp>
-
+#include <graphene/chain/abi_serializer.hpp>
+#include <graphene/chain/symbol.hpp>
+#include <graphene/app/database_api.hpp>
+#include <graphene/db/json_writer.hpp>
 
 #include <fc/crypto/digest.hpp>
 #include <fc/crypto/elliptic.hpp>
@@ -148,4 +151,113 @@ BOOST_AUTO_TEST_CASE( extension_serialization_test )
    }
 }
 
+BOOST_AUTO_TEST_CASE( json_writer_matches_variant_test )
+{
+   try
+   {
+      ACTORS( (alice)(bob) );
+      transfer( account_id_type(), alice_id, asset( 100000 ) );
+      transfer( alice_id, bob_id, asset( 1000 ) );
+      upgrade_to_lifetime_member( alice_id );
+      const signed_block block = generate_block();
+      BOOST_REQUIRE( !block.transactions.empty() );
+
+      auto variant_json = []( const fc::variant& v ) { return fc::json::to_string( v ); };
+
+      BOOST_CHECK_EQUAL( graphene::db::to_json( block ), variant_json( fc::variant( block, GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+      for( const account_object& acct : db.get_index_type<account_index>().indices() )
+         BOOST_CHECK_EQUAL( acct.to_json(), variant_json( acct.to_variant() ) );
+      for( const account_balance_object& bal : db.get_index_type<account_balance_index>().indices() )
+         BOOST_CHECK_EQUAL( bal.to_json(), variant_json( bal.to_variant() ) );
+      for( const asset_object& a : db.get_index_type<asset_index>().indices() )
+         BOOST_CHECK_EQUAL( a.to_json(), variant_json( a.to_variant() ) );
+      BOOST_CHECK_EQUAL( db.get_global_properties().to_json(), variant_json( db.get_global_properties().to_variant() ) );
+      BOOST_CHECK_EQUAL( db.get_dynamic_global_properties().to_json(),
+                         variant_json( db.get_dynamic_global_properties().to_variant() ) );
+
+      graphene::app::database_api api( db );
+      const auto accounts = api.get_full_accounts( { "alice", "bob" }, false );
+      BOOST_REQUIRE_EQUAL( accounts.size(), 2u );
+      for( const auto& entry : accounts )
+         BOOST_CHECK_EQUAL( graphene::db::to_json( entry.second ),
+                            variant_json( fc::variant( entry.second, GRAPHENE_MAX_NESTED_OBJECTS ) ) );
+
+      // integers beyond 32 bits are quoted, strings needing escapes go through fc::json
+      const std::vector<int64_t> numbers{ 0, -1, 0xffffffffll, 0x100000000ll, -0xffffffffll, -0x100000000ll };
+      BOOST_CHECK_EQUAL( graphene::db::to_json( numbers ), variant_json( fc::variant( numbers, 2 ) ) );
+      const std::vector<std::string> strings{ "", "plain", "quote\"", "tab\t", "back\\slash", "\x01", "utf8 \xc3\xa9" };
+      BOOST_CHECK_EQUAL( graphene::db::to_json( strings ), variant_json( fc::variant( strings, 2 ) ) );
+
+      // symbols are written as their names, not as the reflected integers
+      const extended_symbol sym{ symbol( 4, "GJC" ), 42 };
+      BOOST_CHECK_EQUAL( graphene::db::to_json( sym ), variant_json( fc::variant( sym, 2 ) ) );
+      BOOST_CHECK_EQUAL( graphene::db::to_json( sym.sym.to_symbol_code() ),
+                         variant_json( fc::variant( sym.sym.to_symbol_code(), 1 ) ) );
+   }
+   catch ( const fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
+BOOST_AUTO_TEST_CASE( abi_type_plans_test )
+{
+   try
+   {
+      const abi_def abi = fc::json::from_string( R"({
+         "version": "gjc::abi/1.0",
+         "types": [{ "new_type_name": "account_name", "type": "uint64" }],
+         "structs": [
+            { "name": "account", "base": "", "fields": [{ "name": "account_id", "type": "account_name" },
+                                                        { "name": "amount", "type": "int64" }] },
+            { "name": "record", "base": "", "fields": [{ "name": "packet_issuer", "type": "uint64" },
+                                                       { "name": "accounts", "type": "account[]" }] },
+            { "name": "signed_record", "base": "record", "fields": [{ "name": "memo", "type": "string?" },
+                                                                     { "name": "total", "type": "contract_asset" },
+                                                                     { "name": "shares", "type": "int64[]" }] }
+         ],
+         "actions": [{ "name": "claim", "type": "signed_record", "payable": false }],
+         "tables": [{ "name": "record", "index_type": "i64", "key_names": ["packet_issuer"],
+                      "key_types": ["uint64"], "type": "record" }],
+         "error_messages": [],
+         "abi_extensions": []
+      })" ).as<abi_def>( GRAPHENE_MAX_NESTED_OBJECTS );
+
+      const abi_serializer planned( abi, fc::milliseconds( 1000 ) );
+      abi_serializer by_name( planned );
+      by_name.clear_type_plans();
+
+      const fc::variant value = fc::json::from_string( R"({
+         "packet_issuer": 7,
+         "accounts": [{ "account_id": 1, "amount": -5 }, { "account_id": 2, "amount": 6 }],
+         "memo": "hi",
+         "total": { "amount": 100, "asset_id": 1 },
+         "shares": [40, 60]
+      })" );
+      const bytes packed = planned.variant_to_binary( "signed_record", value, fc::milliseconds( 1000 ) );
+      BOOST_CHECK( packed == by_name.variant_to_binary( "signed_record", value, fc::milliseconds( 1000 ) ) );
+
+      const fc::variant unpacked = planned.binary_to_variant( "signed_record", packed, fc::milliseconds( 1000 ) );
+      BOOST_CHECK_EQUAL( fc::json::to_string( unpacked ),
+                         fc::json::to_string( by_name.binary_to_variant( "signed_record", packed, fc::milliseconds( 1000 ) ) ) );
+      BOOST_CHECK_EQUAL( unpacked["accounts"].get_array()[1]["amount"].as_int64(), 6 );
+      BOOST_CHECK( planned.variant_to_binary( "signed_record", unpacked, fc::milliseconds( 1000 ) ) == packed );
+
+      // a missing field fails with either implementation
+      fc::mutable_variant_object incomplete( value.get_object() );
+      incomplete.erase( "shares" );
+      GRAPHENE_REQUIRE_THROW( planned.variant_to_binary( "signed_record", fc::variant( incomplete, 3 ), fc::milliseconds( 1000 ) ),
+                              fc::exception );
+      GRAPHENE_REQUIRE_THROW( by_name.variant_to_binary( "signed_record", fc::variant( incomplete, 3 ), fc::milliseconds( 1000 ) ),
+                              fc::exception );
+   }
+   catch ( const fc::exception& e )
+   {
+      edump((e.to_detail_string()));
+      throw;
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()